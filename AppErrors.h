@@ -8,6 +8,9 @@
 //     -4 incorect file type
 //     -5 file size mismatch (filesize does not match expected filesize)
 //     -6 not yet implemented
+//     -7 cancelled
+//     -8 file write failure
+//     -9 render device lost, the render target and its bitmaps have to be created again
 
 #define APP_SUCCESS	1
 #define APPERR_PARAMETER 0
@@ -17,3 +20,6 @@
 #define APPERR_FILETYPE -4
 #define APPERR_FILESIZE -5
 #define APPERR_NYI -6
+#define APPERR_CANCEL -7
+#define APPERR_FILEWRITE -8
+#define APPERR_DEVICELOST -9
@@ -42,10 +42,15 @@
 //     -4 incorect file type
 //     -5 file sizes mismatch
 //     -6 not yet implemented
+//     -7 cancelled
+//     -8 file write failure
 //
 // Some function return TRUE/FALSE results
 // 
 // V1.0.1	2023-12-20	Initial release
+// V1.2.10	2026-10-17	Added cancelled error message
+// V1.2.19	2026-10-17	Added file write error message
+// V1.2.24	2026-10-17	Removed GetEncoderClsid, GDI+ is no longer used
 //
 #include "framework.h"
 #include "resource.h"
@@ -53,7 +58,6 @@
 #include <winver.h>
 #include <vector>
 #include <atlstr.h>
-#include <gdiplus.h>
 #include "globals.h"
 #include <strsafe.h>
 #include "Appfunctions.h"
@@ -359,46 +363,6 @@ BOOL GetProductAndVersion(CString* strProductName, CString* strProductVersion,
     return true;
 }
 
-//****************************************************************
-//
-//  GetEncoderClsid
-// 
-// This is based on a solution provided at:
-// https://learn.microsoft.com/en-us/windows/win32/gdiplus/-gdiplus-retrieving-the-class-identifier-for-an-encoder-use
-// 
-//****************************************************************
-// using namespace Gdiplus;
-
-INT GetEncoderClsid(const WCHAR* format, CLSID* pClsid) {
-    UINT  num = 0;          // number of image encoders
-    UINT  size = 0;         // size of the image encoder array in bytes
-
-    Gdiplus::ImageCodecInfo* pImageCodecInfo = NULL;
-
-    Gdiplus::GetImageEncodersSize(&num, &size);
-    if (size == 0)
-        return -1;  // Failure
-
-    pImageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc(size));
-    if (pImageCodecInfo == NULL)
-        return -1;  // Failure
-
-    GetImageEncoders(num, size, pImageCodecInfo);
-
-    for (UINT j = 0; j < num; ++j)
-    {
-        if (wcscmp(pImageCodecInfo[j].MimeType, format) == 0)
-        {
-            *pClsid = pImageCodecInfo[j].Clsid;
-            free(pImageCodecInfo);
-            return j;  // Success
-        }
-    }
-
-    free(pImageCodecInfo);
-    return -1;  // Failure
-}
-
 //******************************************************************************
 //
 // MessageMySETIviewerError
@@ -438,6 +402,14 @@ void MessageMySETIviewerError(HWND hWnd, int ErrNo, const wchar_t* Title) {
         MessageBox(hWnd, L"Not yet implemented", Title, MB_OK);
         break;
 
+    case -7:
+        MessageBox(hWnd, L"Cancelled", Title, MB_OK);
+        break;
+
+    case -8:
+        MessageBox(hWnd, L"File write error", Title, MB_OK);
+        break;
+
     default:
         break;
     }
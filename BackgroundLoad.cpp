@@ -0,0 +1,234 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// BackgroundLoad.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the functions for loading a layer configuration in the background
+//
+// The configuration is loaded into a new Layers object on a worker thread and
+// its overlay is composited there, so the user interface is not blocked.
+// The window is sent progress messages while the layer files are loaded and a
+// done message at the end.  The window then takes the new Layers object using
+// FinishBackgroundLoad().
+//
+// Only one background load can run at a time.
+//
+// V1.2.10	2026-10-17	Initial release
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include "AppErrors.h"
+#include "Layers.h"
+#include "BackgroundLoad.h"
+
+typedef struct {
+	HWND hWnd;					// window for the progress and done messages
+	WCHAR Filename[MAX_PATH];	// configuration file
+	Layers* LoadedLayers;
+	int Result;
+	double LoadTime;			// milliseconds to load and composite
+	volatile LONG Cancel;
+} BACKGROUNDLOAD;
+
+static BACKGROUNDLOAD Load = { 0 };
+static HANDLE hLoadThread = NULL;
+
+//*******************************************************************************
+//
+//  static BOOL LoadProgress(void* Context, int Done, int Total)
+//
+// Layers load progress function, see LOADPROGRESS in Layers.h
+//
+//*******************************************************************************
+static BOOL LoadProgress(void* Context, int Done, int Total) {
+	BACKGROUNDLOAD* Job = (BACKGROUNDLOAD*)Context;
+
+	PostMessage(Job->hWnd, WM_BACKGROUND_PROGRESS, (WPARAM)Done, (LPARAM)Total);
+	return !Job->Cancel;
+}
+
+//*******************************************************************************
+//
+//  static DWORD WINAPI LoadThread(LPVOID Param)
+//
+// Load the configuration and composite the overlay
+//
+//*******************************************************************************
+static DWORD WINAPI LoadThread(LPVOID Param) {
+	BACKGROUNDLOAD* Job = (BACKGROUNDLOAD*)Param;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	LARGE_INTEGER Frequency;
+	int iRes;
+
+	QueryPerformanceCounter(&Start);
+
+	Job->LoadedLayers->SetLoadProgress(LoadProgress, Job);
+	iRes = Job->LoadedLayers->LoadConfiguration(Job->Filename);
+	Job->LoadedLayers->SetLoadProgress(NULL, NULL);
+
+	// layers that did load are still used when some failed
+	if (!Job->Cancel && Job->LoadedLayers->GetNumLayers() > 0) {
+		int xsize, ysize;
+		int iRes2;
+
+		iRes2 = Job->LoadedLayers->GetNewOverlaySize(&xsize, &ysize);
+		if (iRes2 == APP_SUCCESS) {
+			iRes2 = Job->LoadedLayers->CreateOverlay(xsize, ysize);
+		}
+		if (iRes2 == APP_SUCCESS) {
+			Job->LoadedLayers->UpdateOverlay();
+		}
+	}
+	if (Job->Cancel) {
+		iRes = APPERR_CANCEL;
+	}
+
+	QueryPerformanceCounter(&End);
+	QueryPerformanceFrequency(&Frequency);
+	Job->LoadTime = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+	Job->Result = iRes;
+
+	PostMessage(Job->hWnd, WM_BACKGROUND_DONE, 0, 0);
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  int StartBackgroundLoad(HWND hWnd, WCHAR* Filename, Layers* Settings)
+//
+// Start loading a layer configuration in the background
+//
+// HWND hWnd			window for the WM_BACKGROUND_PROGRESS and WM_BACKGROUND_DONE messages
+// WCHAR* Filename		configuration file
+// Layers* Settings		the colors, y direction and min. overlay size are
+//						copied from these layers
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int StartBackgroundLoad(HWND hWnd, WCHAR* Filename, Layers* Settings) {
+	int x, y;
+
+	if (hLoadThread != NULL) {
+		return APPERR_PARAMETER;
+	}
+
+	Load.LoadedLayers = new Layers;
+	if (Load.LoadedLayers == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	Load.LoadedLayers->SetBackgroundColor(Settings->GetBackgroundColor());
+	Load.LoadedLayers->SetOverlayColor(Settings->GetOverlayColor());
+	Load.LoadedLayers->SetDefaultLayerColor(Settings->GetDefaultLayerColor());
+	Load.LoadedLayers->SetYdir(Settings->GetYdir());
+	Settings->GetMinOverlaySize(&x, &y);
+	Load.LoadedLayers->SetMinOverlaySize(x, y);
+
+	Load.hWnd = hWnd;
+	wcscpy_s(Load.Filename, MAX_PATH, Filename);
+	Load.Result = APP_SUCCESS;
+	Load.LoadTime = 0.0;
+	Load.Cancel = FALSE;
+
+	hLoadThread = CreateThread(NULL, 0, LoadThread, &Load, 0, NULL);
+	if (hLoadThread == NULL) {
+		delete Load.LoadedLayers;
+		Load.LoadedLayers = NULL;
+		return APPERR_MEMALLOC;
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  BOOL IsBackgroundLoadRunning(void)
+//
+// return
+// BOOL					TRUE, a background load has not been finished
+//
+//*******************************************************************************
+BOOL IsBackgroundLoadRunning(void) {
+	return hLoadThread != NULL;
+}
+
+//*******************************************************************************
+//
+//  void CancelBackgroundLoad(void)
+//
+// Ask the background load to stop, this does not wait.
+// The window still gets WM_BACKGROUND_DONE.
+//
+//*******************************************************************************
+void CancelBackgroundLoad(void) {
+	if (hLoadThread != NULL) {
+		InterlockedExchange(&Load.Cancel, TRUE);
+	}
+}
+
+//*******************************************************************************
+//
+//  Layers* FinishBackgroundLoad(int* Result, double* LoadTime)
+//
+// Get the loaded layers after WM_BACKGROUND_DONE.  The caller owns the
+// returned Layers object.
+//
+// int* Result			returns the LoadConfiguration() result, APPERR_CANCEL if cancelled
+// double* LoadTime		returns the milliseconds to load and composite
+//
+// return
+// Layers*				loaded layers, NULL if there is no background load
+//
+//*******************************************************************************
+Layers* FinishBackgroundLoad(int* Result, double* LoadTime) {
+	Layers* LoadedLayers;
+
+	if (hLoadThread == NULL) {
+		return NULL;
+	}
+	WaitForSingleObject(hLoadThread, INFINITE);
+	CloseHandle(hLoadThread);
+	hLoadThread = NULL;
+
+	*Result = Load.Result;
+	*LoadTime = Load.LoadTime;
+	LoadedLayers = Load.LoadedLayers;
+	Load.LoadedLayers = NULL;
+	return LoadedLayers;
+}
+
+//*******************************************************************************
+//
+//  void EndBackgroundLoad(void)
+//
+// Cancel the background load, wait for it to stop and release the loaded layers
+//
+//*******************************************************************************
+void EndBackgroundLoad(void) {
+	Layers* LoadedLayers;
+	int Result;
+	double LoadTime;
+
+	CancelBackgroundLoad();
+	LoadedLayers = FinishBackgroundLoad(&Result, &LoadTime);
+	if (LoadedLayers != NULL) {
+		delete LoadedLayers;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// BackgroundLoad.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations for loading a layer configuration
+// in the background
+//
+// V1.2.10	2026-10-17	Initial release
+//
+#include "framework.h"
+#include "Layers.h"
+
+// messages posted to the window given to StartBackgroundLoad()
+//	WM_BACKGROUND_PROGRESS	wParam # of layer files loaded, lParam # of layers
+//							when wParam == lParam the overlay is being composited
+//	WM_BACKGROUND_DONE		loading is done, call FinishBackgroundLoad()
+#define WM_BACKGROUND_PROGRESS (WM_APP + 1)
+#define WM_BACKGROUND_DONE (WM_APP + 2)
+
+// function prototypes
+int StartBackgroundLoad(HWND hWnd, WCHAR* Filename, Layers* Settings);
+BOOL IsBackgroundLoadRunning(void);
+void CancelBackgroundLoad(void);
+Layers* FinishBackgroundLoad(int* Result, double* LoadTime);
+void EndBackgroundLoad(void);
@@ -0,0 +1,728 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// Benchmark.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the benchmarks of the image functions against the
+// implementations they replaced.  The replaced implementations are kept here
+// only for comparison, the results of both are checked to be the same.
+//
+// The benchmarks are only built when MYSETI_BENCHMARK is defined
+// (C/C++, Preprocessor Definitions).  They are run from the command line:
+//		MySETIviewer.exe /benchmark [report file]
+// The report is written to Benchmark.txt when no report file is given.
+// The test files are written to the temp directory and deleted afterwards.
+//
+// V1.2.24	2026-10-17	Initial release, LoadImageFile
+//						Added Display::UpdateDisplay
+//						Added SaveTXT
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <stdio.h>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "Display.h"
+#include "Benchmark.h"
+
+#ifdef MYSETI_BENCHMARK
+
+// LoadImageFile benchmark image size
+#define BENCHMARK_XSIZE 2048
+#define BENCHMARK_YSIZE 1024
+#define BENCHMARK_FRAMES 4
+
+// SaveTXT benchmark image size, bands of rows do not end with the frames
+#define BENCHMARK_TXT_XSIZE 1001
+#define BENCHMARK_TXT_YSIZE 700
+#define BENCHMARK_TXT_FRAMES 3
+
+// bytes of each file compared at a time
+#define BENCHMARK_COMPARE_BLOCK (1024*1024)
+
+// UpdateDisplay benchmark overlay size
+#define BENCHMARK_OVERLAY_SIZE 2048
+
+// display grid and gap settings of the UpdateDisplay benchmark, same in x and y
+typedef struct {
+	BOOL GridEnabled;
+	int GridMajor;
+	int GridMinor;
+	int GapMajor;
+	int GapMinor;
+} DISPLAYBENCHMARK;
+
+static const DISPLAYBENCHMARK DisplayBenchmarks[] = {
+	{ FALSE, 1, 1, 0, 0 },		// no grid
+	{ TRUE, 8, 8, 4, 1 },
+	{ TRUE, 4, 64, 8, 2 },
+	{ TRUE, 1, 32, 0, 2 },		// minor gaps only
+	{ TRUE, 4, 256, 16, 0 },	// major gaps only
+	{ TRUE, 16, 1, 2, 1 },		// gap after every pixel, short runs
+};
+
+//*******************************************************************************
+//
+// BenchmarkTime
+//
+// return milliseconds since Start
+//
+//*******************************************************************************
+static double BenchmarkTime(LARGE_INTEGER* Start)
+{
+	LARGE_INTEGER End;
+	LARGE_INTEGER Frequency;
+
+	QueryPerformanceCounter(&End);
+	QueryPerformanceFrequency(&Frequency);
+	return (double)(End.QuadPart - Start->QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+}
+
+//*******************************************************************************
+//
+// BenchmarkFilename
+//
+// Name a test file in the temp directory
+//
+//*******************************************************************************
+static void BenchmarkFilename(WCHAR* Filename, const WCHAR* Name)
+{
+	if (GetTempPath(MAX_PATH, Filename) == 0) {
+		Filename[0] = L'\0';
+	}
+	wcscat_s(Filename, MAX_PATH, Name);
+}
+
+// repeatable pixel values for the test files
+static unsigned int BenchmarkRandom(unsigned int* Seed)
+{
+	*Seed = *Seed * 1103515245 + 12345;
+	return *Seed >> 8;
+}
+
+//*******************************************************************************
+//
+// WriteBenchmarkImage
+//
+// Write an image file of random pixels
+//
+// Parameters:
+//	WCHAR* Filename			image file to write
+//	int xsize, ysize		image size
+//	int NumFrames			# of frames
+//	int PixelSize			1, 2 or 4 bytes per pixel
+//	int Endian				0 MAC format, -1 PC format
+//
+// return:
+//	APP_SUCCESS or a standard application error number
+//
+//*******************************************************************************
+static int WriteBenchmarkImage(WCHAR* Filename, int xsize, int ysize, int NumFrames, int PixelSize, int Endian)
+{
+	IMAGINGHEADER Header;
+	FILE* Out;
+	BYTE* Pixels;
+	size_t NumBytes;
+	unsigned int Seed;
+
+	memset(&Header, 0, sizeof(IMAGINGHEADER));
+	Header.Endian = (short)Endian;
+	Header.ID = (short)0xaaaa;
+	Header.HeaderSize = sizeof(IMAGINGHEADER);
+	Header.Xsize = xsize;
+	Header.Ysize = ysize;
+	Header.PixelSize = (short)PixelSize;
+	Header.NumFrames = (short)NumFrames;
+	Header.Version = 1;
+
+	NumBytes = (size_t)xsize * (size_t)ysize * (size_t)NumFrames * (size_t)PixelSize;
+	Pixels = (BYTE*)malloc(NumBytes);
+	if (Pixels == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	Seed = (unsigned int)(PixelSize * 2 + Endian);
+	for (size_t i = 0; i < NumBytes; i++) {
+		Pixels[i] = (BYTE)BenchmarkRandom(&Seed);
+	}
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		free(Pixels);
+		return APPERR_FILEOPEN;
+	}
+	if (fwrite(&Header, sizeof(IMAGINGHEADER), 1, Out) != 1 || fwrite(Pixels, 1, NumBytes, Out) != NumBytes) {
+		fclose(Out);
+		free(Pixels);
+		return APPERR_FILEWRITE;
+	}
+	free(Pixels);
+	if (fclose(Out) != 0) {
+		return APPERR_FILEWRITE;
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// OldLoadImageFile
+//
+// LoadImageFile() as it was before V1.2.0, one fread per pixel
+//
+//*******************************************************************************
+static int OldLoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
+{
+	FILE* In;
+	size_t iRead;
+
+	_wfopen_s(&In, ImagingFilename, L"rb");
+	if (In == NULL) {
+		*ImagePtr = NULL;
+		return -2;
+	}
+
+	iRead = fread(Header, sizeof(IMAGINGHEADER), 1, In);
+	if (iRead != 1) {
+		*ImagePtr = NULL;
+		fclose(In);
+		return -3;
+	}
+
+	if (Header->Xsize <= 0 || Header->Ysize <= 0 || Header->NumFrames <= 0) {
+		*ImagePtr = NULL;
+		fclose(In);
+		return 0;
+	}
+
+	if (Header->PixelSize != 1 && Header->PixelSize != 2 && Header->PixelSize != 4) {
+		*ImagePtr = NULL;
+		fclose(In);
+		return 0;
+	}
+
+	int* Image;
+	int xsize;
+	int ysize;
+	int NumFrames;
+	int PixelSize;
+	int Endian;
+	xsize = (int)Header->Xsize;
+	ysize = (int)Header->Ysize;
+	NumFrames = (int)Header->NumFrames;
+	PixelSize = (int)Header->PixelSize;
+	Endian = (int)Header->Endian;
+
+	Image = new int[(size_t)xsize * (size_t)ysize * (size_t)NumFrames];
+	*ImagePtr = Image;
+
+	PIXEL Pixel;
+	for (int i = 0; i < xsize * ysize * NumFrames; i++) {
+		iRead = fread(&Pixel, PixelSize, 1, In);
+		if (iRead != 1) {
+			fclose(In);
+			delete[] Image;
+			*ImagePtr = NULL;
+			return -3;
+		}
+
+		if (PixelSize == 1) {
+			Image[i] = (int)Pixel.Byte[0];
+		}
+		else if (PixelSize == 2) {
+			if (!Endian) {
+				int swap;
+				swap = Pixel.Byte[0];
+				Pixel.Byte[0] = Pixel.Byte[1];
+				Pixel.Byte[1] = swap;
+			}
+			Image[i] = (int)Pixel.uShort;
+		}
+		else {
+			if (!Endian) {
+				int swap;
+				swap = Pixel.Byte[0];
+				Pixel.Byte[0] = Pixel.Byte[3];
+				Pixel.Byte[3] = swap;
+				swap = Pixel.Byte[1];
+				Pixel.Byte[1] = Pixel.Byte[2];
+				Pixel.Byte[2] = swap;
+			}
+			Image[i] = (int)Pixel.Long;
+		}
+	}
+	fclose(In);
+
+	return 1;
+}
+
+//*******************************************************************************
+//
+// BenchmarkLoadImageFile
+//
+// Time LoadImageFile() against OldLoadImageFile() for 8, 16 and 32 bit
+// pixels in both MAC and PC format.
+// The file is read once before timing so both read it from the file cache.
+//
+//*******************************************************************************
+static void BenchmarkLoadImageFile(FILE* Report)
+{
+	static const int PixelSizes[3] = { 1, 2, 4 };
+	WCHAR Filename[MAX_PATH];
+	IMAGINGHEADER Header;
+	LARGE_INTEGER Start;
+	size_t NumPixels;
+	int iRes;
+
+	BenchmarkFilename(Filename, L"MySETIbenchmark.raw");
+	NumPixels = (size_t)BENCHMARK_XSIZE * BENCHMARK_YSIZE * BENCHMARK_FRAMES;
+
+	fprintf(Report, "LoadImageFile, %d x %d pixels, %d frames\n",
+		BENCHMARK_XSIZE, BENCHMARK_YSIZE, BENCHMARK_FRAMES);
+	fprintf(Report, "  bits  endian      old ms      new ms   speedup   new MB/s  same\n");
+
+	for (int i = 0; i < 3; i++) {
+		for (int Endian = 0; Endian >= -1; Endian--) {
+			int PixelSize = PixelSizes[i];
+			double OldTime = 0.0;
+			double NewTime = 0.0;
+			BOOL Same = TRUE;
+
+			iRes = WriteBenchmarkImage(Filename, BENCHMARK_XSIZE, BENCHMARK_YSIZE, BENCHMARK_FRAMES, PixelSize, Endian);
+			if (iRes != APP_SUCCESS) {
+				fprintf(Report, "  could not write the test file, error %d\n", iRes);
+				return;
+			}
+
+			for (int Run = 0; Run <= BENCHMARK_RUNS; Run++) {
+				int* OldImage;
+				int* NewImage;
+				double Time;
+
+				QueryPerformanceCounter(&Start);
+				iRes = OldLoadImageFile(&OldImage, Filename, &Header);
+				Time = BenchmarkTime(&Start);
+				if (iRes != APP_SUCCESS) {
+					fprintf(Report, "  old LoadImageFile error %d\n", iRes);
+					_wremove(Filename);
+					return;
+				}
+				if (Run == 1 || (Run > 1 && Time < OldTime)) {
+					OldTime = Time;
+				}
+
+				QueryPerformanceCounter(&Start);
+				iRes = LoadImageFile(&NewImage, Filename, &Header);
+				Time = BenchmarkTime(&Start);
+				if (iRes != APP_SUCCESS) {
+					delete[] OldImage;
+					fprintf(Report, "  LoadImageFile error %d\n", iRes);
+					_wremove(Filename);
+					return;
+				}
+				if (Run == 1 || (Run > 1 && Time < NewTime)) {
+					NewTime = Time;
+				}
+
+				if (memcmp(OldImage, NewImage, NumPixels * sizeof(int)) != 0) {
+					Same = FALSE;
+				}
+				delete[] OldImage;
+				delete[] NewImage;
+			}
+			_wremove(Filename);
+
+			fprintf(Report, "  %4d  %6s  %10.1f  %10.1f  %7.1fx  %9.1f  %s\n",
+				PixelSize * 8, Endian ? "PC" : "MAC", OldTime, NewTime,
+				OldTime / NewTime, (double)(NumPixels * PixelSize) / (1024.0 * 1024.0) / (NewTime / 1000.0),
+				Same ? "yes" : "NO");
+		}
+	}
+	fprintf(Report, "\n");
+}
+
+//*******************************************************************************
+//
+// OldUpdateDisplay
+//
+// Display::UpdateDisplay() as it was before V1.2.11, each pixel of the
+// reference image is compared to the background color.  A reference pixel
+// that is the background color is the next overlay pixel.
+//
+//*******************************************************************************
+static void OldUpdateDisplay(COLORREF* DisplayImage, const COLORREF* DisplayReference,
+	int DisplayXextent, int DisplayYextent, COLORREF rgbBackground,
+	const COLORREF* OverlayImage, int xsize, int ysize)
+{
+	int ix = 0, iy = 0;
+	int Daddress;
+	int Iaddress;
+	BOOL Found = FALSE;
+
+	for (int dy = 0; dy < DisplayYextent; dy++) {
+		Daddress = dy * DisplayXextent;
+		Iaddress = iy * xsize;
+		Found = FALSE;
+		ix = 0;
+		for (int dx = 0; dx < DisplayXextent; dx++) {
+			if (DisplayReference[Daddress + dx] == rgbBackground &&
+				ix < xsize && iy < ysize) {
+				DisplayImage[Daddress + dx] = OverlayImage[Iaddress + ix];
+				ix++;
+				Found = TRUE;
+			}
+			else {
+				DisplayImage[Daddress + dx] = DisplayReference[Daddress + dx];
+			}
+		}
+		if (Found) {
+			iy++;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+// BenchmarkUpdateDisplay
+//
+// Time Display::UpdateDisplay() against OldUpdateDisplay() for the grid and
+// gap settings in DisplayBenchmarks[], updating the whole display.
+// The reference image for OldUpdateDisplay() is the display of an overlay
+// that is all background color.
+//
+//*******************************************************************************
+static void BenchmarkUpdateDisplay(FILE* Report)
+{
+	const COLORREF Background = RGB(0, 0, 0);
+	const COLORREF GapMajor = RGB(255, 0, 0);
+	const COLORREF GapMinor = RGB(0, 0, 255);
+	size_t OverlaySize = (size_t)BENCHMARK_OVERLAY_SIZE * BENCHMARK_OVERLAY_SIZE;
+	COLORREF* Overlay;
+	COLORREF* BackgroundOverlay;
+	LARGE_INTEGER Start;
+	unsigned int Seed = 1;
+
+	fprintf(Report, "Display::UpdateDisplay, %d x %d overlay\n", BENCHMARK_OVERLAY_SIZE, BENCHMARK_OVERLAY_SIZE);
+	fprintf(Report, "  grid  major/minor  gap major/minor      display      old ms      new ms   speedup  same\n");
+
+	Overlay = new COLORREF[OverlaySize];
+	BackgroundOverlay = new COLORREF[OverlaySize];
+	for (size_t i = 0; i < OverlaySize; i++) {
+		Overlay[i] = (COLORREF)(BenchmarkRandom(&Seed) & 0xffffff);
+		BackgroundOverlay[i] = Background;
+	}
+
+	int NumBenchmarks = (int)(sizeof(DisplayBenchmarks) / sizeof(DISPLAYBENCHMARK));
+	for (int b = 0; b < NumBenchmarks; b++) {
+		const DISPLAYBENCHMARK* Settings = &DisplayBenchmarks[b];
+		Display* Disp = new Display;
+		COLORREF* Image;
+		int xsize, ysize;
+		int iRes;
+
+		Disp->EnableGrid(Settings->GridEnabled);
+		Disp->SetGridMajor(Settings->GridMajor, Settings->GridMajor);
+		Disp->SetGridMinor(Settings->GridMinor, Settings->GridMinor);
+		Disp->SetGapMajor(Settings->GapMajor, Settings->GapMajor);
+		Disp->SetGapMinor(Settings->GapMinor, Settings->GapMinor);
+		Disp->SetColors(Background, GapMajor, GapMinor);
+		Disp->CalculateDisplayExtent(BENCHMARK_OVERLAY_SIZE, BENCHMARK_OVERLAY_SIZE);
+		iRes = Disp->CreateDisplayImages();
+		if (iRes == APP_SUCCESS) {
+			iRes = Disp->UpdateDisplay(BackgroundOverlay, BENCHMARK_OVERLAY_SIZE, BENCHMARK_OVERLAY_SIZE);
+		}
+		Disp->GetDisplay(&Image, &xsize, &ysize);
+		if (iRes != APP_SUCCESS || Image == NULL) {
+			fprintf(Report, "  could not create the display, error %d\n", iRes);
+			delete Disp;
+			continue;
+		}
+
+		size_t DisplaySize = (size_t)xsize * ysize;
+		COLORREF* Reference = new COLORREF[DisplaySize];
+		COLORREF* OldImage = new COLORREF[DisplaySize];
+		memcpy(Reference, Image, DisplaySize * sizeof(COLORREF));
+
+		double OldTime = 0.0;
+		double NewTime = 0.0;
+		for (int Run = 0; Run <= BENCHMARK_RUNS; Run++) {
+			double Time;
+
+			QueryPerformanceCounter(&Start);
+			OldUpdateDisplay(OldImage, Reference, xsize, ysize, Background,
+				Overlay, BENCHMARK_OVERLAY_SIZE, BENCHMARK_OVERLAY_SIZE);
+			Time = BenchmarkTime(&Start);
+			if (Run == 1 || (Run > 1 && Time < OldTime)) {
+				OldTime = Time;
+			}
+
+			QueryPerformanceCounter(&Start);
+			Disp->UpdateDisplay(Overlay, BENCHMARK_OVERLAY_SIZE, BENCHMARK_OVERLAY_SIZE);
+			Time = BenchmarkTime(&Start);
+			if (Run == 1 || (Run > 1 && Time < NewTime)) {
+				NewTime = Time;
+			}
+		}
+		BOOL Same = memcmp(OldImage, Image, DisplaySize * sizeof(COLORREF)) == 0;
+
+		if (Settings->GridEnabled) {
+			fprintf(Report, "   on   %5d/%-5d    %5d/%-5d     %5d x %-5d  %10.1f  %10.1f  %7.1fx  %s\n",
+				Settings->GridMajor, Settings->GridMinor, Settings->GapMajor, Settings->GapMinor,
+				xsize, ysize, OldTime, NewTime, OldTime / NewTime, Same ? "yes" : "NO");
+		}
+		else {
+			fprintf(Report, "   off                                 %5d x %-5d  %10.1f  %10.1f  %7.1fx  %s\n",
+				xsize, ysize, OldTime, NewTime, OldTime / NewTime, Same ? "yes" : "NO");
+		}
+
+		delete[] Reference;
+		delete[] OldImage;
+		delete Disp;
+	}
+
+	delete[] Overlay;
+	delete[] BackgroundOverlay;
+	fprintf(Report, "\n");
+}
+
+//*******************************************************************************
+//
+// OldSaveTXT
+//
+// SaveTXT() as it was before V1.2.21, one fprintf per pixel.  The 16 bit
+// branch tests PixelSize == 2, as the SaveTXT() description says, the
+// original tested PixelSize == 1 again so it was never used.
+//
+//*******************************************************************************
+static int OldSaveTXT(WCHAR* Filename, WCHAR* InputFile)
+{
+	int iRes;
+	int* InputImage;
+	IMAGINGHEADER ImageHeader;
+
+	iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+	if (iRes != 1) {
+		return iRes;
+	}
+
+	FILE* Out;
+	int Address;
+
+	_wfopen_s(&Out, Filename, L"w");
+	if (Out == NULL) {
+		delete[] InputImage;
+		return -2;
+	}
+
+	// save file in text format, blank line between frames
+	Address = 0;
+	int Pixel;
+
+	for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
+		for (int y = 0; y < ImageHeader.Ysize; y++) {
+			for (int x = 0; x < ImageHeader.Xsize; x++) {
+				Pixel = InputImage[Address];
+				// make sure pixel is not less than 0
+				if (Pixel < 0) Pixel = 0;
+				if (ImageHeader.PixelSize == 1) {
+					// clip value to match pixel size
+					if (Pixel > 255) Pixel = 255;
+					fprintf(Out, "%3d ", Pixel);
+				}
+				else if (ImageHeader.PixelSize == 2) {
+					// clip value to match pixel size
+					if (Pixel > 65535) Pixel = 65535;
+					fprintf(Out, "%5d ", Pixel);
+				}
+				else {
+					fprintf(Out, "%7d ", Pixel);
+				}
+				Address++;
+			}
+			fprintf(Out, "\n");
+		}
+		fprintf(Out, "\n");
+	}
+	fclose(Out);
+	delete[] InputImage;
+
+	return 1;
+}
+
+//*******************************************************************************
+//
+// BenchmarkSameFiles
+//
+// return:
+//	TRUE, the two files are the same byte for byte
+//
+//*******************************************************************************
+static BOOL BenchmarkSameFiles(WCHAR* Filename1, WCHAR* Filename2)
+{
+	FILE* In1;
+	FILE* In2;
+	BYTE* Buffer1;
+	BYTE* Buffer2;
+	BOOL Same = FALSE;
+
+	_wfopen_s(&In1, Filename1, L"rb");
+	_wfopen_s(&In2, Filename2, L"rb");
+	Buffer1 = (BYTE*)malloc(BENCHMARK_COMPARE_BLOCK);
+	Buffer2 = (BYTE*)malloc(BENCHMARK_COMPARE_BLOCK);
+	if (In1 != NULL && In2 != NULL && Buffer1 != NULL && Buffer2 != NULL) {
+		size_t Len1, Len2;
+		do {
+			Len1 = fread(Buffer1, 1, BENCHMARK_COMPARE_BLOCK, In1);
+			Len2 = fread(Buffer2, 1, BENCHMARK_COMPARE_BLOCK, In2);
+			Same = Len1 == Len2 && memcmp(Buffer1, Buffer2, Len1) == 0;
+		} while (Same && Len1 == BENCHMARK_COMPARE_BLOCK);
+	}
+	free(Buffer1);
+	free(Buffer2);
+	if (In1) {
+		fclose(In1);
+	}
+	if (In2) {
+		fclose(In2);
+	}
+	return Same;
+}
+
+//*******************************************************************************
+//
+// BenchmarkSaveTXT
+//
+// Time SaveTXT() against OldSaveTXT() for 8, 16 and 32 bit pixels of a
+// multi frame image.  The bands of rows cross the ends of the frames.
+// The text files of both must be the same byte for byte.
+//
+//*******************************************************************************
+static void BenchmarkSaveTXT(FILE* Report)
+{
+	static const int PixelSizes[3] = { 1, 2, 4 };
+	WCHAR Filename[MAX_PATH];
+	WCHAR OldTXTfilename[MAX_PATH];
+	WCHAR NewTXTfilename[MAX_PATH];
+	LARGE_INTEGER Start;
+	size_t NumPixels;
+	int iRes;
+
+	BenchmarkFilename(Filename, L"MySETIbenchmark.raw");
+	BenchmarkFilename(OldTXTfilename, L"MySETIbenchmarkOld.txt");
+	BenchmarkFilename(NewTXTfilename, L"MySETIbenchmarkNew.txt");
+	NumPixels = (size_t)BENCHMARK_TXT_XSIZE * BENCHMARK_TXT_YSIZE * BENCHMARK_TXT_FRAMES;
+
+	fprintf(Report, "SaveTXT, %d x %d pixels, %d frames\n",
+		BENCHMARK_TXT_XSIZE, BENCHMARK_TXT_YSIZE, BENCHMARK_TXT_FRAMES);
+	fprintf(Report, "  bits      old ms      new ms   speedup   new Mpixel/s  same\n");
+
+	for (int i = 0; i < 3; i++) {
+		int PixelSize = PixelSizes[i];
+		double OldTime = 0.0;
+		double NewTime = 0.0;
+		BOOL Same = TRUE;
+
+		iRes = WriteBenchmarkImage(Filename, BENCHMARK_TXT_XSIZE, BENCHMARK_TXT_YSIZE, BENCHMARK_TXT_FRAMES,
+			PixelSize, -1);
+		if (iRes != APP_SUCCESS) {
+			fprintf(Report, "  could not write the test file, error %d\n", iRes);
+			return;
+		}
+
+		for (int Run = 0; Run <= BENCHMARK_RUNS; Run++) {
+			double Time;
+
+			QueryPerformanceCounter(&Start);
+			iRes = OldSaveTXT(OldTXTfilename, Filename);
+			Time = BenchmarkTime(&Start);
+			if (iRes != APP_SUCCESS) {
+				fprintf(Report, "  old SaveTXT error %d\n", iRes);
+				break;
+			}
+			if (Run == 1 || (Run > 1 && Time < OldTime)) {
+				OldTime = Time;
+			}
+
+			QueryPerformanceCounter(&Start);
+			iRes = SaveTXT(NewTXTfilename, Filename);
+			Time = BenchmarkTime(&Start);
+			if (iRes != APP_SUCCESS) {
+				fprintf(Report, "  SaveTXT error %d\n", iRes);
+				break;
+			}
+			if (Run == 1 || (Run > 1 && Time < NewTime)) {
+				NewTime = Time;
+			}
+
+			if (!BenchmarkSameFiles(OldTXTfilename, NewTXTfilename)) {
+				Same = FALSE;
+			}
+		}
+		_wremove(Filename);
+		_wremove(OldTXTfilename);
+		_wremove(NewTXTfilename);
+		if (iRes != APP_SUCCESS) {
+			return;
+		}
+
+		fprintf(Report, "  %4d  %10.1f  %10.1f  %7.1fx  %13.1f  %s\n",
+			PixelSize * 8, OldTime, NewTime, OldTime / NewTime,
+			(double)NumPixels / 1.0e6 / (NewTime / 1000.0), Same ? "yes" : "NO");
+	}
+	fprintf(Report, "\n");
+}
+
+//*******************************************************************************
+//
+// RunBenchmarks
+//
+// Run all of the benchmarks and write the results to the report file
+//
+// Parameters:
+//	WCHAR* ReportFilename	report file, Benchmark.txt if NULL or ""
+//
+// return:
+//	APP_SUCCESS or a standard application error number
+//
+//*******************************************************************************
+int RunBenchmarks(WCHAR* ReportFilename)
+{
+	FILE* Report;
+	WCHAR szString[MAX_PATH];
+
+	if (ReportFilename == NULL || ReportFilename[0] == L'\0') {
+		ReportFilename = (WCHAR*)L"Benchmark.txt";
+	}
+	_wfopen_s(&Report, ReportFilename, L"w");
+	if (Report == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	fprintf(Report, "MySETIviewer benchmarks, fastest of %d runs\n\n", BENCHMARK_RUNS);
+
+	BenchmarkLoadImageFile(Report);
+	BenchmarkUpdateDisplay(Report);
+	BenchmarkSaveTXT(Report);
+
+	fclose(Report);
+
+	swprintf_s(szString, MAX_PATH, L"Benchmark results written to %s", ReportFilename);
+	MessageBox(NULL, szString, L"MySETIviewer benchmark", MB_OK);
+
+	return APP_SUCCESS;
+}
+
+#endif
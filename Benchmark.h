@@ -0,0 +1,31 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// Benchmark.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations of the benchmarks.
+// They are only built when MYSETI_BENCHMARK is defined, see Benchmark.cpp
+//
+// V1.2.24	2026-10-17	Initial release
+//
+#include "framework.h"
+
+// # of times each benchmark is run, the fastest time is reported
+#define BENCHMARK_RUNS 3
+
+// function prototypes
+int RunBenchmarks(WCHAR* ReportFilename);
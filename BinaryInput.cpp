@@ -19,6 +19,10 @@
 // This file contains the dialog callback procedures for settings dialogs; Display and Layers
 // 
 // V1.0.1	2023-12-20	Initial release
+// V1.2.23	2026-10-17	ConvertText2BitStream reads the text file in blocks with a
+//						table and SSE2 scanner and packs 64 bits at a time
+// V1.2.24	2026-10-17	ConvertText2BitStream reports read errors as read errors, not as
+//						invalid values, and shows a message when the buffers can't be allocated
 //
 // Global Settings dialog box handler
 // 
@@ -38,6 +42,12 @@
 #include "FileFunctions.h"
 #include "Appfunctions.h"
 #include "globals.h"
+#include <emmintrin.h>
+#include <intrin.h>
+
+// ConvertText2BitStream() reads the text file and writes the bit stream
+// in blocks of this many bytes
+#define TEXT_BLOCK (4*1024*1024)
 
 int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
@@ -702,12 +712,81 @@ int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     return 1;
 }
 
+// character classes of the bit stream text file, see ConvertText2BitStream()
+#define TEXT_INVALID 0
+#define TEXT_ZERO 1
+#define TEXT_DIGIT 2                // 1 to 9
+#define TEXT_SIGN 3                 // + or -
+#define TEXT_SEPARATOR 4
+
+typedef struct {
+    FILE* Out;
+    BYTE* Buffer;                   // TEXT_BLOCK bytes
+    size_t Len;
+    ULONGLONG Bits;                 // bits not yet in Buffer
+    int NumBits;
+    int BitOrder;                   // 0 first bit is the msb of a byte, 1 the lsb
+    BOOL WriteError;
+} BITPACKER;
+
+static void WritePackedBytes(BITPACKER* Packer)
+{
+    if (Packer->Len > 0 && fwrite(Packer->Buffer, 1, Packer->Len, Packer->Out) != Packer->Len) {
+        Packer->WriteError = TRUE;
+    }
+    Packer->Len = 0;
+}
+
+//*******************************************************************
+//
+// StorePackedBits
+// 
+// Move the first NumBytes bytes of the packed bits to the output buffer
+// 
+//*******************************************************************
+static void StorePackedBits(BITPACKER* Packer, int NumBytes)
+{
+    for (int i = 0; i < NumBytes; i++) {
+        if (Packer->BitOrder) {
+            // first bit is bit 0
+            Packer->Buffer[Packer->Len++] = (BYTE)(Packer->Bits >> (8 * i));
+        }
+        else {
+            // first bit is bit 63
+            Packer->Buffer[Packer->Len++] = (BYTE)(Packer->Bits >> (56 - 8 * i));
+        }
+    }
+    Packer->Bits = 0;
+    Packer->NumBits = 0;
+    if (Packer->Len + 8 > TEXT_BLOCK) {
+        WritePackedBytes(Packer);
+    }
+}
+
+static inline void PutBit(BITPACKER* Packer, int Bit)
+{
+    if (Packer->BitOrder) {
+        Packer->Bits |= (ULONGLONG)Bit << Packer->NumBits;
+    }
+    else {
+        Packer->Bits = (Packer->Bits << 1) | (ULONGLONG)Bit;
+    }
+    if (++Packer->NumBits == 64) {
+        StorePackedBits(Packer, 8);
+    }
+}
+
 //*******************************************************************
 //
 // ConvertText2BitStream
 // 
 // Convert textfile to a packed BitStream binary file
 // 
+// The text file is read in blocks of TEXT_BLOCK bytes.  Runs of 16
+// characters that are only 0, 1 and whitespace with single digit values
+// are scanned with SSE2, others one character at a time.  Bits are
+// packed 64 at a time and written TEXT_BLOCK bytes at a time.
+// 
 // Parameters:
 //  HWND hDlg               handle of calling window/dialog
 //  WCHAR* InputFile        text file with space delmited list of values
@@ -716,29 +795,53 @@ int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
 //                          value > 0 is taken as bit with value 1
 //                          (file is multiple always of 8 bits)
 //  WCHAR* OutputFile       Packed Binary bit stream file
+//  int BitOrder            0 first bit is the msb of each byte, 1 the lsb
 //
 //*******************************************************************
 int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder)
 {
+    static BYTE CharClass[256];
     FILE* In;
     FILE* Out;
-    int BitNumber;
-    int BitValue;
-    int ByteValue;
-    int iRes;
-    int TotalBits;
-    int TotalOneBits;
-    int TotalBytes;
+    BYTE* InBuffer;
+    BITPACKER Packer;
+    LONGLONG TotalBits;
+    LONGLONG TotalOneBits;
+    LONGLONG TotalBytes;
     errno_t ErrNum;
 
-    BitNumber = 0;
-    ByteValue = 0;
+    if (CharClass['0'] != TEXT_ZERO) {
+        memset(CharClass, TEXT_INVALID, sizeof(CharClass));
+        CharClass['0'] = TEXT_ZERO;
+        for (int i = '1'; i <= '9'; i++) {
+            CharClass[i] = TEXT_DIGIT;
+        }
+        CharClass['+'] = TEXT_SIGN;
+        CharClass['-'] = TEXT_SIGN;
+        CharClass[' '] = TEXT_SEPARATOR;
+        CharClass['\t'] = TEXT_SEPARATOR;
+        CharClass['\r'] = TEXT_SEPARATOR;
+        CharClass['\n'] = TEXT_SEPARATOR;
+        CharClass['\f'] = TEXT_SEPARATOR;
+        CharClass['\v'] = TEXT_SEPARATOR;
+    }
+
     TotalBits = 0;
     TotalOneBits = 0;
-    TotalBytes = 0;
 
-    ErrNum = _wfopen_s(&In, InputFile, L"r");
+    InBuffer = (BYTE*)malloc(TEXT_BLOCK);
+    Packer.Buffer = (BYTE*)malloc(TEXT_BLOCK);
+    if (InBuffer == NULL || Packer.Buffer == NULL) {
+        free(InBuffer);
+        free(Packer.Buffer);
+        MessageBox(hDlg, L"Could not allocate the text and bit stream buffers", L"File I/O", MB_OK);
+        return APPERR_MEMALLOC;
+    }
+
+    ErrNum = _wfopen_s(&In, InputFile, L"rb");
     if (In == NULL) {
+        free(InBuffer);
+        free(Packer.Buffer);
         MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
         return -2;
     }
@@ -746,52 +849,180 @@ int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int Bi
     ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
     if (Out == NULL) {
         fclose(In);
+        free(InBuffer);
+        free(Packer.Buffer);
         MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
         return -2;
     }
-
-    while (!feof(In)) {
-        iRes = fscanf_s(In, "%d", &BitValue);
-        if (iRes != 1) {
-            fclose(Out);
-            fclose(In);
-            return -3;
-        }
-        if (BitValue < 0) {
-            fclose(Out);
-            fclose(In);
-            return -3;
+    // InBuffer and Packer.Buffer are TEXT_BLOCK bytes, a FILE buffer would only add a copy
+    setvbuf(In, NULL, _IONBF, 0);
+    setvbuf(Out, NULL, _IONBF, 0);
+
+    Packer.Out = Out;
+    Packer.Len = 0;
+    Packer.Bits = 0;
+    Packer.NumBits = 0;
+    Packer.BitOrder = BitOrder;
+    Packer.WriteError = FALSE;
+
+    // value being scanned, it can continue into the next block
+    BOOL InValue = FALSE;
+    BOOL HasDigit = FALSE;
+    BOOL Negative = FALSE;
+    int NonZero = 0;
+    LONGLONG ValueStart = 0;        // file offset of the value
+    LONGLONG Offset = 0;            // file offset of InBuffer[0]
+    LONGLONG ErrorOffset = -1;
+    BOOL ReadError = FALSE;
+
+    while (ErrorOffset < 0 && !Packer.WriteError) {
+        size_t NumRead = fread(InBuffer, 1, TEXT_BLOCK, In);
+        if (NumRead == 0) {
+            ReadError = ferror(In) != 0;
+            break;
         }
-        if (BitValue > 0) {
-            if (BitOrder) {
-                ByteValue = ByteValue | (0x01 << BitNumber);
+
+        size_t i = 0;
+        while (i < NumRead && ErrorOffset < 0) {
+            if (!InValue && i + 16 <= NumRead) {
+                // 16 characters of single digit 0 and 1 values and whitespace
+                __m128i Chars = _mm_loadu_si128((const __m128i*)(InBuffer + i));
+                __m128i Ones = _mm_cmpeq_epi8(Chars, _mm_set1_epi8('1'));
+                __m128i Digits = _mm_or_si128(Ones, _mm_cmpeq_epi8(Chars, _mm_set1_epi8('0')));
+                __m128i Spaces = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(Chars, _mm_set1_epi8('\n'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(Chars, _mm_set1_epi8('\t'))));
+                int DigitMask = _mm_movemask_epi8(Digits);
+                int SpaceMask = _mm_movemask_epi8(Spaces);
+
+                // no two digits together and the last one is not a digit,
+                // so each digit is a whole value
+                if ((DigitMask | SpaceMask) == 0xffff && (DigitMask & (DigitMask << 1)) == 0 &&
+                    (DigitMask & 0x8000) == 0) {
+                    int OneMask = _mm_movemask_epi8(Ones);
+                    unsigned long Index;
+
+                    while (_BitScanForward(&Index, (unsigned long)DigitMask)) {
+                        int Bit = (OneMask >> Index) & 1;
+                        PutBit(&Packer, Bit);
+                        TotalOneBits += Bit;
+                        TotalBits++;
+                        DigitMask &= DigitMask - 1;
+                    }
+                    i += 16;
+                    continue;
+                }
             }
-            else {
-                ByteValue = ByteValue | (0x80 >> BitNumber);
+
+            // inside of a value, near the end of the block, or not a run of
+            // single 0 and 1 digits: parse by character class up to 16 characters,
+            // then the scanner is tried again
+            size_t End = min(i + 16, NumRead);
+            for (; i < End; i++) {
+                switch (CharClass[InBuffer[i]]) {
+                case TEXT_ZERO:
+                case TEXT_DIGIT:
+                    if (!InValue) {
+                        InValue = TRUE;
+                        ValueStart = Offset + i;
+                        Negative = FALSE;
+                        NonZero = 0;
+                    }
+                    HasDigit = TRUE;
+                    NonZero |= CharClass[InBuffer[i]] == TEXT_DIGIT;
+                    continue;
+
+                case TEXT_SIGN:
+                    if (InValue) {
+                        // a sign after digits starts the next value, as with %d
+                        if (!HasDigit || (Negative && NonZero)) {
+                            ErrorOffset = ValueStart;
+                            break;
+                        }
+                        PutBit(&Packer, NonZero);
+                        TotalOneBits += NonZero;
+                        TotalBits++;
+                    }
+                    InValue = TRUE;
+                    ValueStart = Offset + i;
+                    HasDigit = FALSE;
+                    Negative = InBuffer[i] == '-';
+                    NonZero = 0;
+                    continue;
+
+                case TEXT_SEPARATOR:
+                    if (InValue) {
+                        // value < 0 or a sign without digits is an error
+                        if (!HasDigit || (Negative && NonZero)) {
+                            ErrorOffset = ValueStart;
+                            break;
+                        }
+                        PutBit(&Packer, NonZero);
+                        TotalOneBits += NonZero;
+                        TotalBits++;
+                        InValue = FALSE;
+                        HasDigit = FALSE;
+                    }
+                    continue;
+
+                default:
+                    ErrorOffset = Offset + i;
+                    break;
+                }
+                break;
             }
-            TotalOneBits++;
         }
-        TotalBits++;
-        BitNumber++;
-        if (BitNumber >= 8) {
-            fwrite(&ByteValue, 1, 1, Out);
-            ByteValue = 0;
-            BitNumber = 0;
-            TotalBytes++;
+        Offset += NumRead;
+    }
+
+    if (ErrorOffset < 0 && InValue) {
+        // file ends without a separator after the last value
+        if (!HasDigit || (Negative && NonZero)) {
+            ErrorOffset = ValueStart;
+        }
+        else {
+            PutBit(&Packer, NonZero);
+            TotalOneBits += NonZero;
+            TotalBits++;
         }
     }
 
-    if (BitNumber != 0) {
-        fwrite(&ByteValue, 1, 1, Out);
+    // partial last byte is written but not counted
+    if (Packer.NumBits != 0) {
+        if (!BitOrder) {
+            Packer.Bits <<= 64 - Packer.NumBits;
+        }
+        StorePackedBits(&Packer, (Packer.NumBits + 7) / 8);
+    }
+    WritePackedBytes(&Packer);
+    TotalBytes = TotalBits / 8;
+
+    fclose(In);
+    if (fclose(Out) != 0) {
+        Packer.WriteError = TRUE;
+    }
+    free(InBuffer);
+    free(Packer.Buffer);
+
+    if (ReadError) {
+        MessageBox(hDlg, L"Could not read input file", L"File I/O", MB_OK);
+        return APPERR_FILEREAD;
+    }
+    if (ErrorOffset >= 0) {
+        TCHAR pszMessageBuf[MAX_PATH];
+        StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Invalid value at byte offset %lld"), ErrorOffset);
+        MessageBox(hDlg, pszMessageBuf, L"File I/O", MB_OK);
+        return -3;
+    }
+    if (Packer.WriteError) {
+        return APPERR_FILEWRITE;
     }
 
     TCHAR pszMessageBuf[MAX_PATH];
-    StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Bitsream properties\n# of bits: %d\n# of set bits: %d\nBytes writtten: %d"),
+    StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Bitsream properties\n# of bits: %lld\n# of set bits: %lld\nBytes writtten: %lld"),
         TotalBits, TotalOneBits, TotalBytes);
     MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 
-    fclose(In);
-    fclose(Out);
     return 1;
 }
 
@@ -0,0 +1,227 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// D2DBackend.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the Direct2D render backend of the image window,
+// a window render target and its bitmaps.
+//
+// V1.2.24	2026-10-17	Initial release, from ImageDialog.cpp
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <d2d1.h>
+#pragma comment(lib, "d2d1.lib")
+#include "AppErrors.h"
+#include "D2DBackend.h"
+
+//*******************************************************************************
+//
+//  int Initialize(void)
+//
+//  Create the Direct2D factory
+//
+//*******************************************************************************
+int D2DBackend::Initialize(void)
+{
+    HRESULT hResult;
+    if (pFactory) {
+        return APP_SUCCESS;
+    }
+    hResult = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &pFactory);
+    if (FAILED(hResult)) {
+        return APPERR_MEMALLOC;
+    }
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  void Release(void)
+//
+//  Release the render target and the factory.  The bitmaps of the render
+//  target have to be released first.
+//
+//*******************************************************************************
+void D2DBackend::Release(void)
+{
+    ReleaseTarget();
+    // factory is last
+    if (pFactory) {
+        pFactory->Release();
+        pFactory = nullptr;
+    }
+    return;
+}
+
+//*******************************************************************************
+//
+//  int CreateTarget(HWND hWnd, int xsize, int ysize)
+//
+//  Create the render target for a window.  The bitmaps of the old render
+//  target have to be released first.
+//
+//*******************************************************************************
+int D2DBackend::CreateTarget(HWND hWnd, int xsize, int ysize)
+{
+    if (pFactory == NULL) {
+        return APPERR_PARAMETER;
+    }
+    ReleaseTarget();
+    pFactory->CreateHwndRenderTarget(
+        D2D1::RenderTargetProperties(),
+        D2D1::HwndRenderTargetProperties(hWnd, D2D1::SizeU(xsize, ysize)),
+        &pRenderTarget
+    );
+    if (pRenderTarget == NULL) {
+        return APPERR_MEMALLOC;
+    }
+    TargetWindow = hWnd;
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  HWND GetTargetWindow(void)
+//
+// return
+// HWND             window of the render target, NULL if none
+//
+//*******************************************************************************
+HWND D2DBackend::GetTargetWindow(void)
+{
+    return TargetWindow;
+}
+
+//*******************************************************************************
+//
+//  void ReleaseTarget(void)
+//
+//  The bitmaps of the render target have to be released first
+//
+//*******************************************************************************
+void D2DBackend::ReleaseTarget(void)
+{
+    if (pRenderTarget) {
+        pRenderTarget->Release();
+        pRenderTarget = nullptr;
+    }
+    TargetWindow = NULL;
+    return;
+}
+
+//*******************************************************************************
+//
+//  ID2D1HwndRenderTarget* GetTarget(void)
+//
+// return
+// ID2D1HwndRenderTarget*   render target to draw with, nullptr if none
+//
+//*******************************************************************************
+ID2D1HwndRenderTarget* D2DBackend::GetTarget(void)
+{
+    return pRenderTarget;
+}
+
+//*******************************************************************************
+//
+//  int Resize(int xsize, int ysize)
+//
+//  Resize the render target, it is left alone when the size is the same
+//
+//*******************************************************************************
+int D2DBackend::Resize(int xsize, int ysize)
+{
+    if (pRenderTarget == NULL) {
+        return APPERR_PARAMETER;
+    }
+    D2D1_SIZE_U TargetSize = pRenderTarget->GetPixelSize();
+    if (TargetSize.width == (UINT32)xsize && TargetSize.height == (UINT32)ysize) {
+        return APP_SUCCESS;
+    }
+    HRESULT hRes = pRenderTarget->Resize(D2D1::SizeU(xsize, ysize));
+    if (hRes == D2DERR_RECREATE_TARGET) {
+        return APPERR_DEVICELOST;
+    }
+    return SUCCEEDED(hRes) ? APP_SUCCESS : APPERR_MEMALLOC;
+}
+
+//*******************************************************************************
+//
+//  int CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch,
+//                  RENDERBITMAP* Bitmap)
+//
+//  Bitmaps are RGBA 8 bit ignore alpha, 96 DPI (Windows default DPI)
+//
+//*******************************************************************************
+int D2DBackend::CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch,
+    RENDERBITMAP* Bitmap)
+{
+    ID2D1Bitmap* pBitmap = nullptr;
+
+    *Bitmap = NULL;
+    if (pRenderTarget == NULL) {
+        return APPERR_PARAMETER;
+    }
+    HRESULT hRes = pRenderTarget->CreateBitmap(D2D1::SizeU(xsize, ysize), Pixels,
+                                    (UINT32)(Pitch * sizeof(RENDERPIXEL)),
+                                    bitmapProperties, &pBitmap);
+    if (FAILED(hRes) || pBitmap == nullptr) {
+        if (pBitmap) {
+            pBitmap->Release();
+        }
+        return hRes == D2DERR_RECREATE_TARGET ? APPERR_DEVICELOST : APPERR_MEMALLOC;
+    }
+    *Bitmap = pBitmap;
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels,
+//                  size_t Pitch)
+//
+//*******************************************************************************
+int D2DBackend::CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels,
+    size_t Pitch)
+{
+    ID2D1Bitmap* pBitmap = (ID2D1Bitmap*)Bitmap;
+
+    if (pBitmap == nullptr) {
+        return APPERR_PARAMETER;
+    }
+    D2D1_RECT_U Rect = D2D1::RectU(Dest->left, Dest->top, Dest->right, Dest->bottom);
+    HRESULT hRes = pBitmap->CopyFromMemory(&Rect, Pixels, (UINT32)(Pitch * sizeof(RENDERPIXEL)));
+    if (hRes == D2DERR_RECREATE_TARGET) {
+        return APPERR_DEVICELOST;
+    }
+    return SUCCEEDED(hRes) ? APP_SUCCESS : APPERR_PARAMETER;
+}
+
+//*******************************************************************************
+//
+//  void ReleaseBitmap(RENDERBITMAP Bitmap)
+//
+//*******************************************************************************
+void D2DBackend::ReleaseBitmap(RENDERBITMAP Bitmap)
+{
+    if (Bitmap) {
+        ((ID2D1Bitmap*)Bitmap)->Release();
+    }
+    return;
+}
@@ -0,0 +1,58 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// D2DBackend.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the Direct2D render backend of the image window,
+// a window render target and its bitmaps.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+#include "framework.h"
+#include <d2d1.h>
+#include "RenderBackend.h"
+
+class D2DBackend : public RenderBackend
+{
+private:
+	ID2D1Factory* pFactory = nullptr;
+	ID2D1HwndRenderTarget* pRenderTarget = nullptr;
+	HWND TargetWindow = NULL;			// window of pRenderTarget
+	D2D1_BITMAP_PROPERTIES bitmapProperties = { D2D1::PixelFormat(DXGI_FORMAT_R8G8B8A8_UNORM,
+														 D2D1_ALPHA_MODE_IGNORE),
+												96.0f, 96.0f };
+
+public:
+	D2DBackend() {
+	};
+
+	~D2DBackend() {
+		Release();
+	};
+
+	int Initialize(void);
+	void Release(void);
+	int CreateTarget(HWND hWnd, int xsize, int ysize);
+	void ReleaseTarget(void);
+	HWND GetTargetWindow(void);
+	ID2D1HwndRenderTarget* GetTarget(void);
+
+	int Resize(int xsize, int ysize);
+	int CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch, RENDERBITMAP* Bitmap);
+	int CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels, size_t Pitch);
+	void ReleaseBitmap(RENDERBITMAP Bitmap);
+};
@@ -21,6 +21,36 @@
 // used in creating multiple image overlays for display
 // 
 // V1.0.1	2023-12-20	Initial release
+// V1.2.11	2026-10-17	Display rows and columns are mapped to overlay rows and columns,
+//						or a gap, by tables calculated from the grid and gap settings.
+//						UpdateDisplay copies runs of overlay pixels using the tables instead
+//						of comparing each pixel of the reference image to the background.
+//						The reference image is only created when it is saved.
+// V1.2.12	2026-10-17	Display row and column runs are calculated directly from the grid and
+//						gap settings.  Gap rows and the reference image are copied from row
+//						templates made once per row type.
+// V1.2.13	2026-10-17	CreateDisplayImages keeps the display image, maps and row templates
+//						when the extent, grid, gap and colors are unchanged.  Only the
+//						parts that changed are recreated.
+// V1.2.14	2026-10-17	UpdateDisplay is done in parallel tiles of rows
+//						Short image runs are copied pixel by pixel using the column map,
+//						long runs are block copied
+// V1.2.15	2026-10-17	Large displays are virtual, the display image is not created.
+//						Rectangles of the display are created when they are shown
+//						using GetDisplayTile().
+// V1.2.16	2026-10-17	Added reduced display levels for zoomed out viewing.  Levels are
+//						built in blocks when they are shown, and only the blocks in the
+//						changed region of the overlay are built again.  UpdateDisplay
+//						only updates the display rows and columns of the changed region.
+// V1.2.17	2026-10-17	Added GetOverlayPosition(), display pixel to overlay pixel using the maps
+// V1.2.18	2026-10-17	The display region changed by UpdateDisplay() is kept for the image
+//						window, see GetUpdatedRect()
+// V1.2.19	2026-10-17	SaveBMP of a virtual display creates the rows as they are written
+//						instead of a full size image
+// V1.2.24	2026-10-17	Removed the UpdateDisplay timing debug output, the UpdateDisplay
+//						benchmark is in Benchmark.cpp
+//						SaveBMP of the reference image creates the rows as they are written
+//						instead of a full size image
 //
 // Application standardized error numbers for functions:
 //		See AppErrors.h
@@ -35,6 +65,7 @@
 #include "imageheader.h"
 #include "display.h"
 #include "FileFunctions.h"
+#include "ParallelTasks.h"
 
 //*******************************************************************************
 //
@@ -81,29 +112,158 @@ void Display::EnableGrid(BOOL Enable)
 
 //*******************************************************************************
 //
-//  CreateDisplayImage(void)
+//  static void AddSpan(DISPLAYSPAN* Spans, int* NumSpans, int* d, int Extent, int Count, int Map)
+// 
+//  Helper function for BuildDisplaySpans(), add a run of Count display rows/columns
+//  starting at *d, the run is cut off at Extent
 // 
 //*******************************************************************************
-int Display::CreateDisplayImages(void)
+static void AddSpan(DISPLAYSPAN* Spans, int* NumSpans, int* d, int Extent, int Count, int Map)
 {
-    if (DisplayXextent <= 0 || DisplayYextent <= 0) {
-        return APPERR_PARAMETER;
+    if (Count > Extent - *d) {
+        Count = Extent - *d;
+    }
+    if (Count <= 0) {
+        return;
     }
+    Spans[*NumSpans].Start = *d;
+    Spans[*NumSpans].Length = Count;
+    Spans[*NumSpans].Map = Map;
+    (*NumSpans)++;
+    *d += Count;
+}
 
-    ReleaseDisplayImages();
+//*******************************************************************************
+//
+//  static int BuildDisplaySpans(DISPLAYSPAN* Spans, int Extent, BOOL GridEnabled,
+//      int GridMajor, int GridMinor, int GapMajor, int GapMinor)
+// 
+//  Split the display rows or columns into runs of image rows/columns and gaps
+//  This is the same for rows and columns, using the X or Y grid and gap settings.
+// 
+//  DISPLAYSPAN* Spans  returns the runs, room for Extent runs is needed
+//  int Extent          display extent
+// 
+// return
+// int          # of runs
+//
+//*******************************************************************************
+static int BuildDisplaySpans(DISPLAYSPAN* Spans, int Extent, BOOL GridEnabled,
+    int GridMajor, int GridMinor, int GapMajor, int GapMinor)
+{
+    int NumSpans = 0;
+    int d = 0;
+    int Image = 0;
 
-    int DisplaySize = DisplayXextent * DisplayYextent;
+    // there are four cases for the gaps
+    // 
+    // Gap  Major   Minor
+    //      !=0     !=0
+    //      ==0     !=0
+    //      !=0     ==0
+    //      ==0     ==0     
+    //
+    // The overall display is surrounded by a frame of MajorGap size
 
-    DisplayImage = new COLORREF[DisplaySize];
-    if (DisplayImage == NULL) {
-        return APPERR_MEMALLOC;
+    if (!GridEnabled || (GapMajor == 0 && GapMinor == 0)) {
+        // no gaps, display is the image
+        AddSpan(Spans, &NumSpans, &d, Extent, Extent, 0);
+    }
+    else if (GapMajor != 0 && GapMinor != 0) {
+        // starts with major gap
+        // then groups of GridMajor x (GridMinor of the image followed by a minor gap)
+        // with a major gap instead of the last minor gap
+        AddSpan(Spans, &NumSpans, &d, Extent, GapMajor, DISPLAY_GAP_MAJOR);
+        while (d < Extent) {
+            AddSpan(Spans, &NumSpans, &d, Extent, GridMinor, Image);
+            Image += GridMinor;
+            for (int Grid = 0; Grid < (GridMajor - 1); Grid++) {
+                AddSpan(Spans, &NumSpans, &d, Extent, GapMinor, DISPLAY_GAP_MINOR);
+                AddSpan(Spans, &NumSpans, &d, Extent, GridMinor, Image);
+                Image += GridMinor;
+            }
+            AddSpan(Spans, &NumSpans, &d, Extent, GapMajor, DISPLAY_GAP_MAJOR);
+        }
+    }
+    else if (GapMajor == 0 && GapMinor != 0) {
+        // no major gaps, GridMinor of the image followed by a minor gap
+        while (d < Extent) {
+            AddSpan(Spans, &NumSpans, &d, Extent, GridMinor, Image);
+            Image += GridMinor;
+            AddSpan(Spans, &NumSpans, &d, Extent, GapMinor, DISPLAY_GAP_MINOR);
+        }
+    }
+    else {
+        // no minor gaps, starts with a major gap
+        // then GridMajor*GridMinor of the image followed by a major gap
+        AddSpan(Spans, &NumSpans, &d, Extent, GapMajor, DISPLAY_GAP_MAJOR);
+        while (d < Extent) {
+            AddSpan(Spans, &NumSpans, &d, Extent, GridMinor * GridMajor, Image);
+            Image += GridMinor * GridMajor;
+            AddSpan(Spans, &NumSpans, &d, Extent, GapMajor, DISPLAY_GAP_MAJOR);
+        }
     }
 
-    DisplayReference = new COLORREF[DisplaySize];
-    if (DisplayReference == NULL) {
-        delete[] DisplayImage;
-        DisplayImage = NULL;
-        return APPERR_MEMALLOC;
+    return NumSpans;
+}
+
+//*******************************************************************************
+//
+//  static void SpansToMap(int* Map, DISPLAYSPAN* Spans, int NumSpans)
+// 
+//  Fill the display map from the runs
+// 
+//*******************************************************************************
+static void SpansToMap(int* Map, DISPLAYSPAN* Spans, int NumSpans)
+{
+    for (int s = 0; s < NumSpans; s++) {
+        int* Dest = Map + Spans[s].Start;
+        if (Spans[s].Map < 0) {
+            for (int i = 0; i < Spans[s].Length; i++) {
+                Dest[i] = Spans[s].Map;
+            }
+        }
+        else {
+            for (int i = 0; i < Spans[s].Length; i++) {
+                Dest[i] = Spans[s].Map + i;
+            }
+        }
+    }
+}
+
+//*******************************************************************************
+//
+//  static void FillPixels(COLORREF* Dest, int Count, COLORREF Color)
+// 
+//*******************************************************************************
+static void FillPixels(COLORREF* Dest, int Count, COLORREF Color)
+{
+    for (int i = 0; i < Count; i++) {
+        Dest[i] = Color;
+    }
+}
+
+//*******************************************************************************
+//
+//  CreateDisplayImage(void)
+// 
+//  Create the display image, the display maps and the row templates for
+//  the current display extent, grid, gap and color settings.
+//  If these are the same as the last time, nothing is recreated.  The display
+//  image is only reallocated when the display extent changes, and only the row
+//  templates are recreated when just the colors change.
+//  Displays larger than DISPLAY_VIRTUAL_SIZE or DISPLAY_VIRTUAL_BYTES are
+//  virtual, only the maps and row templates are created.
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::CreateDisplayImages(void)
+{
+    if (DisplayXextent <= 0 || DisplayYextent <= 0) {
+        return APPERR_PARAMETER;
     }
 
     // make sure the clusters are valid
@@ -117,265 +277,993 @@ int Display::CreateDisplayImages(void)
     if (GapXminor < 0) GapXminor = 0;
     if (GapYminor < 0) GapYminor = 0;
 
-    // there are 5 cases for the gaps when calculating the display extent
-    // 
-    // Gap  Major   Minor
-    //      !=0     !=0
-    //      ==0     !=0
-    //      !=0     ==0
-    //      ==0     ==0     
-    //
-    // The overall display is surrounded by a frame of MajorGap size
+    DISPLAYLAYOUT Layout;
+    memset(&Layout, 0, sizeof(Layout));
+    Layout.Xextent = DisplayXextent;
+    Layout.Yextent = DisplayYextent;
+    Layout.GridXmajor = GridXmajor;
+    Layout.GridYmajor = GridYmajor;
+    Layout.GridXminor = GridXminor;
+    Layout.GridYminor = GridYminor;
+    Layout.GapXmajor = GapXmajor;
+    Layout.GapYmajor = GapYmajor;
+    Layout.GapXminor = GapXminor;
+    Layout.GapYminor = GapYminor;
+    Layout.GridEnabled = GridEnabled;
+
+    int iRes;
 
-    if (!GridEnabled) {
-        // Grid disabled case just set the everything to Background image
-        for (int i = 0; i < DisplaySize; i++) {
-            DisplayReference[i] = rgbBackground;
+    // BuiltLayout is cleared when there are no maps, so the same layout means they exist
+    if (memcmp(&Layout, &BuiltLayout, sizeof(Layout)) == 0) {
+        // same layout
+        if (rgbBackground == BuiltBackground && rgbGapMajor == BuiltGapMajor && rgbGapMinor == BuiltGapMinor) {
+            return APP_SUCCESS;
         }
-        return APP_SUCCESS;
+        // only the colors changed
+        iRes = CreateDisplayRows();
+        if (iRes != APP_SUCCESS) {
+            ReleaseDisplayImages();
+        }
+        return iRes;
     }
 
-    int dAddress;
-    int y = 0;
-
-    if (GapYmajor != 0 && GapYminor != 0) {
-        // starts with GapYmajor lines of rgbGapMajor
-        for (int gap = 0; gap < GapYmajor && y < DisplayYextent; gap++, y++) {
-            dAddress = y * DisplayXextent;
-            // MajorGap line (just MajorGap colors1)
-            CreateDisplayLine(dAddress, rgbGapMajor, rgbGapMajor, rgbGapMajor);
-        }
-        
-        // then is goes in groups of GridYminorGridYGap lines of the image
-        // followed by Gap
-        while(y < DisplayYextent) {
-            for (int i = 0; i < GridYminor && y < DisplayYextent; i++, y++) {
-                dAddress = y * DisplayXextent;
-                // regular line (all elements: Major,Minor,background for image)
-                CreateDisplayLine(dAddress, rgbBackground, rgbGapMajor, rgbGapMinor);
-            }
+    size_t DisplayBytes = (size_t)DisplayXextent * DisplayYextent * sizeof(COLORREF);
+    BOOL Virtual = DisplayXextent > DISPLAY_VIRTUAL_SIZE || DisplayYextent > DISPLAY_VIRTUAL_SIZE ||
+        DisplayBytes > DISPLAY_VIRTUAL_BYTES;
 
-            // insert GridYminor lines of using X Grid/gap parameters
+    if (Virtual) {
+        // only the maps and row templates, the display is created by GetDisplayTile()
+        ReleaseDisplayImages();
+    }
+    else if (DisplayImage == NULL || DisplayXextent != BuiltLayout.Xextent || DisplayYextent != BuiltLayout.Yextent) {
+        ReleaseDisplayImages();
 
-            // add Y major grid groups - a group of (minor gap Y image lines, minor grid Y lines)
+        size_t DisplaySize = (size_t)DisplayXextent * DisplayYextent;
 
-            for (int Grid = 0; Grid < (GridYmajor - 1); Grid++) {
-                // line of rgbGapMinor
-                for (int gap = 0; gap < GapYminor && y < DisplayYextent; gap++, y++) {
-                    dAddress = y * DisplayXextent;
-                    // MinorGap line (just MajorGap, MinorGap colors)
-                    CreateDisplayLine(dAddress, rgbGapMinor, rgbGapMajor, rgbGapMinor);
-                }
-                // insert GridYminor lines of using X Grid/gap parameters
-                for (int i = 0; i < GridYminor && y < DisplayYextent; i++, y++) {
-                    dAddress = y * DisplayXextent;
-                    // regular line (all elements: Major,Minor,background for image)
-                    CreateDisplayLine(dAddress, rgbBackground, rgbGapMajor, rgbGapMinor);
-                }
-            }
+        DisplayImage = new COLORREF[DisplaySize];
+        if (DisplayImage == NULL) {
+            return APPERR_MEMALLOC;
+        }
+    }
+    else {
+        // same size, the display image is reused
+        ReleaseDisplayMaps();
+    }
 
-            // Add Major Gap lines
-            for (int gap = 0; gap < GapYmajor && y < DisplayYextent; gap++, y++) {
-                dAddress = y * DisplayXextent;
-                // MajorGap line (just MajorGap colors1)
-                CreateDisplayLine(dAddress, rgbGapMajor, rgbGapMajor, rgbGapMajor);
-            }
+    iRes = CreateDisplayMaps();
+    if (iRes == APP_SUCCESS) {
+        iRes = CreateDisplayRows();
+    }
+    if (iRes != APP_SUCCESS) {
+        ReleaseDisplayImages();
+        return iRes;
+    }
+
+    VirtualDisplay = Virtual;
+    BuiltLayout = Layout;
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int CreateDisplayMaps(void)
+// 
+//  Helper function for CreateDisplayImage()
+//  Create the display row and column runs and maps
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::CreateDisplayMaps(void)
+{
+    DisplayXmap = new int[DisplayXextent];
+    DisplayYmap = new int[DisplayYextent];
+    // worst case is a run per row/column
+    DisplaySpans = new DISPLAYSPAN[DisplayXextent];
+    DisplayRowSpans = new DISPLAYSPAN[DisplayYextent];
+    if (DisplayXmap == NULL || DisplayYmap == NULL || DisplaySpans == NULL || DisplayRowSpans == NULL) {
+        return APPERR_MEMALLOC;
+    }
+
+    NumDisplaySpans = BuildDisplaySpans(DisplaySpans, DisplayXextent, GridEnabled,
+        GridXmajor, GridXminor, GapXmajor, GapXminor);
+    NumDisplayRowSpans = BuildDisplaySpans(DisplayRowSpans, DisplayYextent, GridEnabled,
+        GridYmajor, GridYminor, GapYmajor, GapYminor);
+
+    SpansToMap(DisplayXmap, DisplaySpans, NumDisplaySpans);
+    SpansToMap(DisplayYmap, DisplayRowSpans, NumDisplayRowSpans);
+
+    // block copies are slower than a pixel loop for short runs
+    int ImageSpans = 0;
+    int ImageColumns = 0;
+    for (int s = 0; s < NumDisplaySpans; s++) {
+        if (DisplaySpans[s].Map >= 0) {
+            ImageSpans++;
+            ImageColumns += DisplaySpans[s].Length;
         }
     }
-    else if (GapYmajor == 0 && GapYminor != 0) {
-        // no Major gap exists only Minor gaps
+    CopySpans = ImageColumns >= DISPLAY_MIN_COPY * ImageSpans;
 
-        while (y < DisplayYextent) {
-            for (int i = 0; i < GridYminor && y < DisplayYextent; i++, y++) {
-                dAddress = y * DisplayXextent;
-                // regular line (all elements: Major,Minor,background for image)
-                CreateDisplayLine(dAddress, rgbBackground, rgbGapMajor, rgbGapMinor);
-            }
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int CreateDisplayRows(void)
+// 
+//  Helper function for CreateDisplayImage()
+//  Create a template of each of the 3 types of display rows,
+//  major gap, minor gap, and image rows without the overlay
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::CreateDisplayRows(void)
+{
+    // templates are reused when only the colors change
+    if (GapMajorRow == NULL) {
+        GapMajorRow = new COLORREF[DisplayXextent];
+    }
+    if (GapMinorRow == NULL) {
+        GapMinorRow = new COLORREF[DisplayXextent];
+    }
+    if (BackgroundRow == NULL) {
+        BackgroundRow = new COLORREF[DisplayXextent];
+    }
+    if (GapMajorRow == NULL || GapMinorRow == NULL || BackgroundRow == NULL) {
+        return APPERR_MEMALLOC;
+    }
 
+    // major gap rows are all major gap, major gap columns cross minor gap rows
+    FillPixels(GapMajorRow, DisplayXextent, rgbGapMajor);
+    for (int s = 0; s < NumDisplaySpans; s++) {
+        DISPLAYSPAN* Span = &DisplaySpans[s];
 
-            // insert GridYminor lines of using X Grid/gap parameters
+        if (Span->Map == DISPLAY_GAP_MAJOR) {
+            FillPixels(GapMinorRow + Span->Start, Span->Length, rgbGapMajor);
+            FillPixels(BackgroundRow + Span->Start, Span->Length, rgbGapMajor);
+        }
+        else if (Span->Map == DISPLAY_GAP_MINOR) {
+            FillPixels(GapMinorRow + Span->Start, Span->Length, rgbGapMinor);
+            FillPixels(BackgroundRow + Span->Start, Span->Length, rgbGapMinor);
+        }
+        else {
+            FillPixels(GapMinorRow + Span->Start, Span->Length, rgbGapMinor);
+            FillPixels(BackgroundRow + Span->Start, Span->Length, rgbBackground);
+        }
+    }
 
-            // Add Minor Gap lines
-            for (int gap = 0; gap < GapYminor && y < DisplayYextent; gap++, y++) {
-                dAddress = y * DisplayXextent;
-                // MinorGap line (just MajorGap, MinorGap colors)
-                CreateDisplayLine(dAddress, rgbGapMinor, rgbGapMajor, rgbGapMinor);
-            }
+    BuiltBackground = rgbBackground;
+    BuiltGapMajor = rgbGapMajor;
+    BuiltGapMinor = rgbGapMinor;
+
+    // the display has to be updated with the new rows
+    InvalidateLevels(NULL);
+    DisplayValid = FALSE;
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  static int FindSpan(DISPLAYSPAN* Spans, int NumSpans, int Position)
+// 
+// return
+// int          index of the run that has display row/column Position
+//
+//*******************************************************************************
+static int FindSpan(DISPLAYSPAN* Spans, int NumSpans, int Position)
+{
+    int Low = 0;
+    int High = NumSpans - 1;
+
+    while (Low < High) {
+        int Mid = (Low + High + 1) / 2;
+        if (Spans[Mid].Start <= Position) {
+            Low = Mid;
+        }
+        else {
+            High = Mid - 1;
         }
     }
-    else if (GapYmajor != 0 && GapYminor == 0) {
-        // no Major gap exists only Minor gaps
+    return Low;
+}
+
+//*******************************************************************************
+//
+//  void CreateReferenceRows(COLORREF* Rows, int y, int NumRows)
+// 
+//  Create rows y to y+NumRows-1 of the gridded reference image, the display
+//  with the background color where overlay pixels go.
+// 
+//  COLORREF* Rows          DisplayXextent x NumRows pixels
+// 
+//*******************************************************************************
+void Display::CreateReferenceRows(COLORREF* Rows, int y, int NumRows)
+{
+    size_t RowBytes = (size_t)DisplayXextent * sizeof(COLORREF);
+    int s = FindSpan(DisplayRowSpans, NumDisplayRowSpans, y);
+
+    for (int dy = y; dy < y + NumRows; dy++) {
+        DISPLAYSPAN* RowSpan;
+        COLORREF* Template;
 
-            // Add Major Gap lines
-        for (int gap = 0; gap < GapYmajor && y < DisplayYextent; gap++, y++) {
-            dAddress = y * DisplayXextent;
-            // MajorGap line (just MajorGap colors1)
-            CreateDisplayLine(dAddress, rgbGapMajor, rgbGapMajor, rgbGapMajor);
+        while (dy >= DisplayRowSpans[s].Start + DisplayRowSpans[s].Length) {
+            s++;
         }
+        RowSpan = &DisplayRowSpans[s];
+        if (RowSpan->Map == DISPLAY_GAP_MAJOR) {
+            Template = GapMajorRow;
+        }
+        else if (RowSpan->Map == DISPLAY_GAP_MINOR) {
+            Template = GapMinorRow;
+        }
+        else {
+            Template = BackgroundRow;
+        }
+        memcpy(Rows + (size_t)(dy - y) * DisplayXextent, Template, RowBytes);
+    }
+}
 
-        while (y < DisplayYextent) {
-            for (int i = 0; i < (GridYminor*GridYmajor) && y < DisplayYextent; i++, y++) {
-                dAddress = y * DisplayXextent;
-                // regular line (all elements: Major,Minor,background for image)
-                CreateDisplayLine(dAddress, rgbBackground, rgbGapMajor, rgbGapMinor);
-            }
+//*******************************************************************************
+//
+//  void BuildRows(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+//                  int StartColumn, int EndColumn, int StartRow, int EndRow)
+// 
+//  Helper function for UpdateDisplay() and GetDisplayTile(), merge the overlay
+//  into display columns StartColumn to EndColumn-1 of rows StartRow to EndRow-1
+// 
+//  COLORREF* Dest          display pixel (StartColumn, StartRow)
+//  size_t Stride           pixels from one row of Dest to the next
+// 
+//*******************************************************************************
+void Display::BuildRows(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+    int StartColumn, int EndColumn, int StartRow, int EndRow)
+{
+    int Width = EndColumn - StartColumn;
+    size_t RowBytes = (size_t)Width * sizeof(COLORREF);
+    int FirstSpan = FindSpan(DisplaySpans, NumDisplaySpans, StartColumn);
 
+    for (int dy = StartRow; dy < EndRow; dy++) {
+        COLORREF* Row = Dest + (size_t)(dy - StartRow) * Stride;
+        int OverlayY = DisplayYmap[dy];
+
+        if (OverlayY == DISPLAY_GAP_MAJOR) {
+            memcpy(Row, GapMajorRow + StartColumn, RowBytes);
+            continue;
+        }
+        if (OverlayY == DISPLAY_GAP_MINOR) {
+            memcpy(Row, GapMinorRow + StartColumn, RowBytes);
+            continue;
+        }
+        if (OverlayY >= ysize) {
+            // below the overlay
+            memcpy(Row, BackgroundRow + StartColumn, RowBytes);
+            continue;
+        }
 
-            // insert GridYmajor lines of using X Grid/gap parameters
+        COLORREF* OverlayRow = OverlayImage + (size_t)OverlayY * xsize;
 
-            // Add Major Gap lines
-            for (int gap = 0; gap < GapYmajor && y < DisplayYextent; gap++, y++) {
-                dAddress = y * DisplayXextent;
-                // MajorGap line (just MajorGap colors1)
-                CreateDisplayLine(dAddress, rgbGapMajor, rgbGapMajor, rgbGapMajor);
+        if (!CopySpans) {
+            // short runs, select overlay or template pixel for each column
+            // gap columns are negative so they fail the unsigned compare
+            for (int dx = StartColumn; dx < EndColumn; dx++) {
+                unsigned int Column = (unsigned int)DisplayXmap[dx];
+                Row[dx - StartColumn] = (Column < (unsigned int)xsize) ? OverlayRow[Column] : BackgroundRow[dx];
+            }
+            continue;
+        }
+
+        for (int s = FirstSpan; s < NumDisplaySpans && DisplaySpans[s].Start < EndColumn; s++) {
+            DISPLAYSPAN* Span = &DisplaySpans[s];
+            // part of the run inside of the columns
+            int First = max(Span->Start, StartColumn);
+            int Length = min(Span->Start + Span->Length, EndColumn) - First;
+            COLORREF* Out = Row + (First - StartColumn);
+            int Count = 0;
+
+            if (Span->Map >= 0) {
+                int Map = Span->Map + (First - Span->Start);
+                if (Map < xsize) {
+                    // overlay pixels, then background past the end of the overlay
+                    Count = min(Length, xsize - Map);
+                    memcpy(Out, OverlayRow + Map, Count * sizeof(COLORREF));
+                }
+            }
+            if (Count < Length) {
+                memcpy(Out + Count, BackgroundRow + First + Count, (Length - Count) * sizeof(COLORREF));
             }
         }
     }
-    else {
-        // 0,0 case just set the everything to Background image
-        for (int i = 0; i < DisplaySize; i++) {
-            DisplayReference[i] = rgbBackground;
+}
+
+//*******************************************************************************
+//
+//  void BuildTile(void* Context, int Tile)
+// 
+// ParallelFor() task, build one tile of rows of a DISPLAYJOB
+// 
+//*******************************************************************************
+typedef struct {
+    Display* Owner;
+    COLORREF* Dest;         // display pixel (x, y)
+    size_t Stride;          // pixels per row of Dest
+    COLORREF* OverlayImage;
+    int xsize;
+    int ysize;
+    int x;                  // display rectangle
+    int y;
+    int Width;
+    int Height;
+    int TileRows;           // rows per tile
+} DISPLAYJOB;
+
+void Display::BuildTile(void* Context, int Tile)
+{
+    DISPLAYJOB* Job = (DISPLAYJOB*)Context;
+    int StartRow = Tile * Job->TileRows;
+    int EndRow = min(StartRow + Job->TileRows, Job->Height);
+
+    Job->Owner->BuildRows(Job->Dest + StartRow * Job->Stride, Job->Stride,
+        Job->OverlayImage, Job->xsize, Job->ysize,
+        Job->x, Job->x + Job->Width, Job->y + StartRow, Job->y + EndRow);
+}
+
+//*******************************************************************************
+//
+//  void BuildRectangle(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+//                      int x, int y, int Width, int Height)
+// 
+//  Build a rectangle of the display in tiles of DISPLAY_TILE_BYTES, in parallel.
+// 
+//*******************************************************************************
+void Display::BuildRectangle(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+    int x, int y, int Width, int Height)
+{
+    int TileRows = DISPLAY_TILE_BYTES / (Width * (int)sizeof(COLORREF));
+    if (TileRows < 1) {
+        TileRows = 1;
+    }
+    int NumTiles = (Height + TileRows - 1) / TileRows;
+
+    DISPLAYJOB Job = { this, Dest, Stride, OverlayImage, xsize, ysize, x, y, Width, Height, TileRows };
+    ParallelFor(NumTiles, BuildTile, &Job);
+}
+
+//*******************************************************************************
+//
+//  static void OverlayToSpans(DISPLAYSPAN* Spans, int NumSpans, int First, int End,
+//                              LONG* Start, LONG* Stop)
+// 
+//  Find the display rows/columns of overlay rows/columns First to End-1
+// 
+//  LONG* Start, Stop       returns the display rows/columns Start to Stop-1,
+//                          Start == Stop if they are not in the display
+// 
+//*******************************************************************************
+static void OverlayToSpans(DISPLAYSPAN* Spans, int NumSpans, int First, int End, LONG* Start, LONG* Stop)
+{
+    BOOL Found = FALSE;
+
+    *Start = 0;
+    *Stop = 0;
+    for (int s = 0; s < NumSpans; s++) {
+        if (Spans[s].Map < 0) {
+            continue;
         }
+        int a = max(First, Spans[s].Map);
+        int b = min(End, Spans[s].Map + Spans[s].Length);
+        if (a >= b) {
+            continue;
+        }
+        // runs are in display order, so the first one found is the start
+        if (!Found) {
+            *Start = Spans[s].Start + (a - Spans[s].Map);
+            Found = TRUE;
+        }
+        *Stop = Spans[s].Start + (b - Spans[s].Map);
     }
+}
 
-    return APP_SUCCESS;
+//*******************************************************************************
+//
+//  void OverlayToDisplay(const RECT* Overlay, RECT* Rect)
+// 
+//  Find the display rectangle of an overlay rectangle
+// 
+//*******************************************************************************
+void Display::OverlayToDisplay(const RECT* Overlay, RECT* Rect)
+{
+    OverlayToSpans(DisplaySpans, NumDisplaySpans, Overlay->left, Overlay->right, &Rect->left, &Rect->right);
+    OverlayToSpans(DisplayRowSpans, NumDisplayRowSpans, Overlay->top, Overlay->bottom, &Rect->top, &Rect->bottom);
+    if (IsRectEmpty(Rect)) {
+        SetRectEmpty(Rect);
+    }
 }
 
 //*******************************************************************************
 //
-//  void CreateDisplayLine(COLORREF* dAddress)
+//  UpdateDisplay(COLORREF*, int xsize, int ysize)
+//  UpdateDisplay(COLORREF*, int xsize, int ysize, const RECT* Changed)
 // 
-//  Helper function for CreateDisplayImage()
+//  Merge the overlay image into the display image using the display maps
+//  Display pixels that map to an overlay pixel outside of the overlay
+//  are the background color.
+//  The rows are done in tiles of DISPLAY_TILE_BYTES, in parallel.
+//  A virtual display is not updated, see GetDisplayTile().
+// 
+//  If only part of the overlay has changed since the last update, see
+//  Layers::GetChangedRect(), only that part of the display is updated.
+//  The whole display is updated if the overlay or display layout is not
+//  the same as the last update.
+//  The reduced display levels are built again in the updated region
+//  the next time they are shown.
+// 
+//  COLORREF* OverlayImage  overlay image
+//  int xsize, ysize        size of the overlay
+//  const RECT* Changed     region of the overlay that changed, NULL for all of it
 // 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
 //*******************************************************************************
-void Display::CreateDisplayLine(int StartAddress,
-    COLORREF rgbBackground,
-    COLORREF rgbGapMajor,
-    COLORREF rgbGapMinor)
+int Display::UpdateDisplay(COLORREF* OverlayImage, int xsize, int ysize)
 {
-    // there are four cases for the gaps when calculating the display extent
-    // 
-    // Gap  Major   Minor
-    //      !=0     !=0
-    //      ==0     !=0
-    //      !=0     ==0
-    //      ==0     ==0     
-    //
-    // The overall display is surrounded by a frame of MajorGap size
+    return UpdateDisplay(OverlayImage, xsize, ysize, NULL);
+}
+
+int Display::UpdateDisplay(COLORREF* OverlayImage, int xsize, int ysize, const RECT* Changed)
+{
+    if (BackgroundRow == NULL) {
+        return APPERR_PARAMETER;
+    }
+    if (!VirtualDisplay && DisplayImage == NULL) {
+        return APPERR_PARAMETER;
+    }
 
-    int x = 0;
-    if (GapXmajor != 0 && GapXminor != 0) {
-        // starts with GapXmajor pixels of rgbGapMajor
-        for (int gap = 0; gap < GapXmajor && x < DisplayXextent; gap++, x++) {
-            // pixels of rgbGapMajor
-            DisplayReference[StartAddress + x] = rgbGapMajor;
+    RECT Rect = { 0, 0, DisplayXextent, DisplayYextent };
+    if (Changed != NULL && DisplayValid && OverlayImage == LastOverlay &&
+        xsize == LastOverlayXsize && ysize == LastOverlayYsize) {
+        // same overlay, only part of it changed
+        OverlayToDisplay(Changed, &Rect);
+        if (IsRectEmpty(&Rect)) {
+            return APP_SUCCESS;
         }
+    }
 
-        // then is goes in groups of GridXminor,GridXGap pixels of the image
-        // followed by Gap
-        while (x < DisplayXextent) {
-            for (int i = 0; i < GridXminor && x < DisplayXextent; i++, x++) {
-                DisplayReference[StartAddress + x] = rgbBackground;
-            }
+    InvalidateLevels(&Rect);
+    UnionRect(&UpdatedRect, &UpdatedRect, &Rect);
+    LastOverlay = OverlayImage;
+    LastOverlayXsize = xsize;
+    LastOverlayYsize = ysize;
+    DisplayValid = TRUE;
 
-            // insert GridXminor pixels of using X Grid/gap parameters
+    if (VirtualDisplay) {
+        // created as it is shown
+        return APP_SUCCESS;
+    }
 
-            // add Y major grid groups - a group of (minor gap Y image lines, minor grid Y lines)
+    BuildRectangle(DisplayImage + (size_t)Rect.top * DisplayXextent + Rect.left, DisplayXextent,
+        OverlayImage, xsize, ysize,
+        Rect.left, Rect.top, Rect.right - Rect.left, Rect.bottom - Rect.top);
 
-            for (int Grid = 0; Grid < (GridXmajor - 1); Grid++) {
-                // Pixels(s) of rgbGapMajor
-                for (int gap = 0; gap < GapXminor && x < DisplayXextent; gap++, x++) {
-                    DisplayReference[StartAddress + x] = rgbGapMinor;
-                }
-                // insert GridXminor pixel(s) of using X Grid/gap parameters
-                for (int i = 0; i < GridXminor && x < DisplayXextent; i++, x++) {
-                    DisplayReference[StartAddress + x] = rgbBackground;
-                }
-            }
+    return APP_SUCCESS;
+}
 
-            // Add Major Gap pixels
-            for (int gap = 0; gap < GapXmajor && x < DisplayXextent; gap++, x++) {
-                DisplayReference[StartAddress + x] = rgbGapMajor;
-            }
-        }
+//*******************************************************************************
+//
+//  int GetDisplayTile(int Level, int x, int y, int xsize, int ysize, COLORREF* Tile,
+//                      COLORREF* OverlayImage, int OverlayXsize, int OverlayYsize)
+// 
+//  Create a rectangle of the display, or of a reduced display level.
+//  This is used to show a virtual display or a zoomed out display but
+//  works for any display.
+// 
+//  int Level               0, the display, 1 to DISPLAY_MAX_LEVELS-1 reduced level
+//  int x, y                upper left corner of the rectangle in the level
+//  int xsize, ysize        size of the rectangle
+//  COLORREF* Tile          returns the rectangle, xsize x ysize
+//  COLORREF* OverlayImage  overlay image
+//  int OverlayXsize, OverlayYsize  size of the overlay
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::GetDisplayTile(int Level, int x, int y, int xsize, int ysize, COLORREF* Tile,
+    COLORREF* OverlayImage, int OverlayXsize, int OverlayYsize)
+{
+    int LevelXsize, LevelYsize;
+
+    if (BackgroundRow == NULL || Tile == NULL || OverlayImage == NULL) {
+        return APPERR_PARAMETER;
+    }
+    if (Level < 0 || Level >= DISPLAY_MAX_LEVELS) {
+        return APPERR_PARAMETER;
+    }
+    GetLevelSize(Level, &LevelXsize, &LevelYsize);
+    if (x < 0 || y < 0 || xsize <= 0 || ysize <= 0 ||
+        x + xsize > LevelXsize || y + ysize > LevelYsize) {
+        return APPERR_PARAMETER;
     }
-    else if (GapXmajor == 0 && GapXminor != 0) {
-        // no Major gap exists only Minor gaps
 
-        while (x < DisplayXextent) {
-            for (int i = 0; i < GridXminor && x < DisplayXextent; i++, x++) {
-                DisplayReference[StartAddress + x] = rgbBackground;
-            }
+    if (Level == 0) {
+        BuildRectangle(Tile, xsize, OverlayImage, OverlayXsize, OverlayYsize, x, y, xsize, ysize);
+        return APP_SUCCESS;
+    }
+
+    RECT Rect = { x, y, x + xsize, y + ysize };
+
+    if (CreateLevel(Level) != APP_SUCCESS) {
+        // too large to keep
+        return ReduceDisplay(Level, &Rect, Tile, xsize, OverlayImage, OverlayXsize, OverlayYsize);
+    }
+
+    int iRes = BuildLevel(Level, &Rect, OverlayImage, OverlayXsize, OverlayYsize);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    DISPLAYLEVEL* Reduced = &Levels[Level];
+    for (int Row = 0; Row < ysize; Row++) {
+        memcpy(Tile + (size_t)Row * xsize, Reduced->Image + (size_t)(y + Row) * Reduced->Xsize + x,
+            xsize * sizeof(COLORREF));
+    }
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  void GetLevelSize(int Level, int* x, int* y)
+// 
+//  Size of a reduced display level, each level is half the size of
+//  the one before, rounded up
+// 
+//*******************************************************************************
+void Display::GetLevelSize(int Level, int* x, int* y)
+{
+    *x = (DisplayXextent + (1 << Level) - 1) >> Level;
+    *y = (DisplayYextent + (1 << Level) - 1) >> Level;
+}
 
-            // insert GridYminor lines of using X Grid/gap parameters
+//*******************************************************************************
+//
+//  void SetEmptyColors(COLORREF LayerBackground, COLORREF OverlayBackground)
+// 
+//  Set the overlay colors that are not a set layer pixel.  Reduced display
+//  levels keep set pixels over these, see ReduceRect().
+// 
+//*******************************************************************************
+void Display::SetEmptyColors(COLORREF LayerBackground, COLORREF OverlayBackground)
+{
+    if (LayerBackground != rgbLayerBackground || OverlayBackground != rgbOverlayBackground) {
+        rgbLayerBackground = LayerBackground;
+        rgbOverlayBackground = OverlayBackground;
+        InvalidateLevels(NULL);
+        // the reduced levels shown have changed
+        RECT Rect = { 0, 0, DisplayXextent, DisplayYextent };
+        UnionRect(&UpdatedRect, &UpdatedRect, &Rect);
+    }
+}
+
+//*******************************************************************************
+//
+//  static int PixelRank(COLORREF Color, const COLORREF* Colors)
+// 
+//  Helper function for ReduceRect(), which pixel is kept when reducing
+// 
+//  const COLORREF* Colors  gap major, layer background, overlay background,
+//                          gap minor, display background
+// 
+// return
+// int          4 set layer pixel, 3 major gap, 2 empty overlay pixel,
+//              1 minor gap, 0 display background
+//
+//*******************************************************************************
+static inline int PixelRank(COLORREF Color, const COLORREF* Colors)
+{
+    if (Color == Colors[0]) return 3;
+    if (Color == Colors[1] || Color == Colors[2]) return 2;
+    if (Color == Colors[3]) return 1;
+    if (Color == Colors[4]) return 0;
+    return 4;
+}
 
-            // Add Minor Gap lines
-            for (int gap = 0; gap < GapXminor && x < DisplayXextent; gap++, x++) {
-                DisplayReference[StartAddress + x] = rgbGapMinor;
+//*******************************************************************************
+//
+//  void ReduceRect(const COLORREF* Src, size_t SrcStride, int SrcXsize, int SrcYsize,
+//                  COLORREF* Dest, size_t DestStride)
+// 
+//  Reduce a rectangle to half its size, rounded up.  Each pixel is the
+//  highest ranked pixel of the 2 x 2 pixels, see PixelRank(), so a set
+//  layer pixel is never lost and major gaps stay visible.
+//  Dest can be Src if DestStride is SrcStride.
+// 
+//*******************************************************************************
+void Display::ReduceRect(const COLORREF* Src, size_t SrcStride, int SrcXsize, int SrcYsize,
+    COLORREF* Dest, size_t DestStride)
+{
+    COLORREF Colors[5] = { rgbGapMajor, rgbLayerBackground, rgbOverlayBackground, rgbGapMinor, rgbBackground };
+    int DestXsize = (SrcXsize + 1) / 2;
+    int DestYsize = (SrcYsize + 1) / 2;
+
+    for (int y = 0; y < DestYsize; y++) {
+        const COLORREF* Row0 = Src + (size_t)(2 * y) * SrcStride;
+        const COLORREF* Row1 = (2 * y + 1 < SrcYsize) ? Row0 + SrcStride : Row0;
+        COLORREF* Out = Dest + (size_t)y * DestStride;
+
+        for (int x = 0; x < DestXsize; x++) {
+            int x0 = 2 * x;
+            int x1 = (x0 + 1 < SrcXsize) ? x0 + 1 : x0;
+            COLORREF Pixel = Row0[x0];
+
+            if (Pixel != Row0[x1] || Pixel != Row1[x0] || Pixel != Row1[x1]) {
+                COLORREF Others[3] = { Row0[x1], Row1[x0], Row1[x1] };
+                int Rank = PixelRank(Pixel, Colors);
+                for (int i = 0; i < 3 && Rank < 4; i++) {
+                    int OtherRank = PixelRank(Others[i], Colors);
+                    if (OtherRank > Rank) {
+                        Pixel = Others[i];
+                        Rank = OtherRank;
+                    }
+                }
             }
+            Out[x] = Pixel;
         }
     }
-    else if (GapXmajor != 0 && GapXminor == 0) {
-        // Major gap > 0, no minor gaps
+}
 
-        // Add Major Gap lines
-        for (int gap = 0; gap < GapXmajor && x < DisplayXextent; gap++, x++) {
-            DisplayReference[StartAddress + x] = rgbGapMajor;
+//*******************************************************************************
+//
+//  int ReduceDisplay(int Level, const RECT* Rect, COLORREF* Dest, size_t Stride,
+//                      COLORREF* OverlayImage, int xsize, int ysize)
+// 
+//  Create a rectangle of a reduced level from the display rows without
+//  using the kept levels.  This is used for levels that are too large to keep.
+// 
+//  int Level               reduced level
+//  const RECT* Rect        rectangle in the level
+//  COLORREF* Dest          returns the rectangle
+//  size_t Stride           pixels per row of Dest
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::ReduceDisplay(int Level, const RECT* Rect, COLORREF* Dest, size_t Stride,
+    COLORREF* OverlayImage, int xsize, int ysize)
+{
+    // display rectangle of the level rectangle
+    int x0 = Rect->left << Level;
+    int y0 = Rect->top << Level;
+    int x1 = min(Rect->right << Level, DisplayXextent);
+    int y1 = min(Rect->bottom << Level, DisplayYextent);
+    int Width = x1 - x0;
+    int Height = y1 - y0;
+    size_t ScratchStride = Width;
+
+    COLORREF* Scratch = new COLORREF[(size_t)Width * Height];
+    if (Scratch == NULL) {
+        return APPERR_MEMALLOC;
+    }
+    if (DisplayImage != NULL) {
+        for (int Row = 0; Row < Height; Row++) {
+            memcpy(Scratch + (size_t)Row * Width, DisplayImage + (size_t)(y0 + Row) * DisplayXextent + x0,
+                Width * sizeof(COLORREF));
         }
+    }
+    else {
+        BuildRows(Scratch, Width, OverlayImage, xsize, ysize, x0, x1, y0, y1);
+    }
 
-        while (x < DisplayXextent) {
-            for (int i = 0; i < (GridXminor*GridXmajor) && x < DisplayXextent; i++, x++) {
-                DisplayReference[StartAddress + x] = rgbBackground;
-            }
+    // reduce in place, the last one into Dest
+    for (int i = 1; i < Level; i++) {
+        ReduceRect(Scratch, ScratchStride, Width, Height, Scratch, ScratchStride);
+        Width = (Width + 1) / 2;
+        Height = (Height + 1) / 2;
+    }
+    ReduceRect(Scratch, ScratchStride, Width, Height, Dest, Stride);
+
+    delete[] Scratch;
+    return APP_SUCCESS;
+}
 
-            // insert GridYmajor lines of using X Grid/gap parameters
+//*******************************************************************************
+//
+//  int CreateLevel(int Level)
+// 
+//  Create the image of a reduced level if it is small enough to keep,
+//  the same limits as the display image.  The blocks are not built.
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number, the level is not kept
+//
+//*******************************************************************************
+int Display::CreateLevel(int Level)
+{
+    DISPLAYLEVEL* Reduced = &Levels[Level];
+    int x, y;
+
+    if (Reduced->Image != NULL) {
+        return APP_SUCCESS;
+    }
+
+    GetLevelSize(Level, &x, &y);
+    if (x > DISPLAY_VIRTUAL_SIZE || y > DISPLAY_VIRTUAL_SIZE ||
+        (size_t)x * y * sizeof(COLORREF) > DISPLAY_VIRTUAL_BYTES) {
+        return APPERR_MEMALLOC;
+    }
+
+    Reduced->BlocksX = (x + DISPLAY_LEVEL_BLOCK - 1) / DISPLAY_LEVEL_BLOCK;
+    Reduced->BlocksY = (y + DISPLAY_LEVEL_BLOCK - 1) / DISPLAY_LEVEL_BLOCK;
+    Reduced->Image = new COLORREF[(size_t)x * y];
+    Reduced->BlockValid = new BYTE[(size_t)Reduced->BlocksX * Reduced->BlocksY];
+    if (Reduced->Image == NULL || Reduced->BlockValid == NULL) {
+        delete[] Reduced->Image;
+        delete[] Reduced->BlockValid;
+        memset(Reduced, 0, sizeof(DISPLAYLEVEL));
+        return APPERR_MEMALLOC;
+    }
+    memset(Reduced->BlockValid, 0, (size_t)Reduced->BlocksX * Reduced->BlocksY);
+    Reduced->Xsize = x;
+    Reduced->Ysize = y;
+    return APP_SUCCESS;
+}
 
-            for (int gap = 0; gap < GapXmajor && x < DisplayXextent; gap++, x++) {
-                DisplayReference[StartAddress + x] = rgbGapMajor;
+//*******************************************************************************
+//
+//  void BuildLevelBlock(void* Context, int Block)
+// 
+// ParallelFor() task, build one block of a LEVELJOB
+// 
+//*******************************************************************************
+typedef struct {
+    Display* Owner;
+    int Level;
+    int* Blocks;            // blocks to build, BlocksX * row + column
+    COLORREF* OverlayImage;
+    int xsize;
+    int ysize;
+    volatile LONG Result;
+} LEVELJOB;
+
+void Display::BuildLevelBlock(void* Context, int Block)
+{
+    LEVELJOB* Job = (LEVELJOB*)Context;
+    Display* Owner = Job->Owner;
+    DISPLAYLEVEL* Reduced = &Owner->Levels[Job->Level];
+    int BlockNum = Job->Blocks[Block];
+
+    RECT Rect;
+    Rect.left = (BlockNum % Reduced->BlocksX) * DISPLAY_LEVEL_BLOCK;
+    Rect.top = (BlockNum / Reduced->BlocksX) * DISPLAY_LEVEL_BLOCK;
+    Rect.right = min(Rect.left + DISPLAY_LEVEL_BLOCK, Reduced->Xsize);
+    Rect.bottom = min(Rect.top + DISPLAY_LEVEL_BLOCK, Reduced->Ysize);
+    COLORREF* Dest = Reduced->Image + (size_t)Rect.top * Reduced->Xsize + Rect.left;
+
+    // the level above, the display or a kept level
+    COLORREF* Src = NULL;
+    int SrcXsize = 0;
+    int SrcYsize = 0;
+    if (Job->Level == 1) {
+        Src = Owner->DisplayImage;
+        SrcXsize = Owner->DisplayXextent;
+        SrcYsize = Owner->DisplayYextent;
+    }
+    else {
+        Src = Owner->Levels[Job->Level - 1].Image;
+        SrcXsize = Owner->Levels[Job->Level - 1].Xsize;
+        SrcYsize = Owner->Levels[Job->Level - 1].Ysize;
+    }
+
+    if (Src == NULL) {
+        int iRes = Owner->ReduceDisplay(Job->Level, &Rect, Dest, Reduced->Xsize,
+            Job->OverlayImage, Job->xsize, Job->ysize);
+        if (iRes != APP_SUCCESS) {
+            InterlockedExchange(&Job->Result, iRes);
+            return;
+        }
+    }
+    else {
+        int x0 = Rect.left * 2;
+        int y0 = Rect.top * 2;
+        int Width = min((int)Rect.right * 2, SrcXsize) - x0;
+        int Height = min((int)Rect.bottom * 2, SrcYsize) - y0;
+        Owner->ReduceRect(Src + (size_t)y0 * SrcXsize + x0, SrcXsize, Width, Height, Dest, Reduced->Xsize);
+    }
+    Reduced->BlockValid[BlockNum] = 1;
+}
+
+//*******************************************************************************
+//
+//  int BuildLevel(int Level, const RECT* Rect, COLORREF* OverlayImage, int xsize, int ysize)
+// 
+//  Build the blocks of a kept level in a rectangle that are not up to date.
+//  The blocks of the level above are built first if it is kept.
+//  The blocks are done in parallel.
+// 
+//  int Level               reduced level, created with CreateLevel()
+//  const RECT* Rect        rectangle in the level
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::BuildLevel(int Level, const RECT* Rect, COLORREF* OverlayImage, int xsize, int ysize)
+{
+    DISPLAYLEVEL* Reduced = &Levels[Level];
+    int FirstX = Rect->left / DISPLAY_LEVEL_BLOCK;
+    int FirstY = Rect->top / DISPLAY_LEVEL_BLOCK;
+    int LastX = (Rect->right - 1) / DISPLAY_LEVEL_BLOCK;
+    int LastY = (Rect->bottom - 1) / DISPLAY_LEVEL_BLOCK;
+
+    int* Blocks = new int[(size_t)(LastX - FirstX + 1) * (LastY - FirstY + 1)];
+    if (Blocks == NULL) {
+        return APPERR_MEMALLOC;
+    }
+
+    // blocks to build, and the region of the level above they use
+    int NumBlocks = 0;
+    RECT Source;
+    SetRectEmpty(&Source);
+    for (int by = FirstY; by <= LastY; by++) {
+        for (int bx = FirstX; bx <= LastX; bx++) {
+            int BlockNum = by * Reduced->BlocksX + bx;
+            if (Reduced->BlockValid[BlockNum]) {
+                continue;
             }
+            Blocks[NumBlocks] = BlockNum;
+            NumBlocks++;
+
+            RECT Block;
+            Block.left = bx * DISPLAY_LEVEL_BLOCK * 2;
+            Block.top = by * DISPLAY_LEVEL_BLOCK * 2;
+            Block.right = Block.left + DISPLAY_LEVEL_BLOCK * 2;
+            Block.bottom = Block.top + DISPLAY_LEVEL_BLOCK * 2;
+            UnionRect(&Source, &Source, &Block);
         }
     }
-    // 0,0 case has nothing to do
 
-    return;
+    int iRes = APP_SUCCESS;
+    if (NumBlocks > 0 && Level > 1 && CreateLevel(Level - 1) == APP_SUCCESS) {
+        int x, y;
+        GetLevelSize(Level - 1, &x, &y);
+        Source.right = min((int)Source.right, x);
+        Source.bottom = min((int)Source.bottom, y);
+        iRes = BuildLevel(Level - 1, &Source, OverlayImage, xsize, ysize);
+    }
+
+    if (NumBlocks > 0 && iRes == APP_SUCCESS) {
+        LEVELJOB Job = { this, Level, Blocks, OverlayImage, xsize, ysize, APP_SUCCESS };
+        ParallelFor(NumBlocks, BuildLevelBlock, &Job);
+        iRes = (int)Job.Result;
+    }
+
+    delete[] Blocks;
+    return iRes;
 }
 
 //*******************************************************************************
 //
-//  UpdateDisplay(COLORREF*, int xsize, int ysize)
+//  void InvalidateLevels(const RECT* Rect)
+// 
+//  Mark the blocks of the kept levels in a display rectangle as not up to date
+// 
+//  const RECT* Rect        rectangle of the display, NULL for the whole display
 // 
 //*******************************************************************************
-int Display::UpdateDisplay(COLORREF* OverlayImage, int xsize, int ysize)
+void Display::InvalidateLevels(const RECT* Rect)
 {
-    int ix=0, iy=0;
-    int Daddress;
-    int Iaddress;
-    BOOL Found = FALSE;
+    for (int Level = 1; Level < DISPLAY_MAX_LEVELS; Level++) {
+        DISPLAYLEVEL* Reduced = &Levels[Level];
 
-    for (int dy = 0; dy <DisplayYextent; dy++) {
-        Daddress = dy * DisplayXextent;
-        Iaddress = iy * xsize;
-        Found = FALSE;
-        ix = 0;
-        for (int dx = 0; dx < DisplayXextent; dx++) {
-            if (DisplayReference[Daddress + dx] == rgbBackground &&
-                    ix<xsize && iy<ysize) {
-                DisplayImage[Daddress + dx] = OverlayImage[Iaddress + ix];
-                ix++;
-                Found = TRUE;
-            }
-            else {
-                DisplayImage[Daddress + dx] = DisplayReference[Daddress + dx];
-            }
+        if (Reduced->BlockValid == NULL) {
+            continue;
+        }
+        if (Rect == NULL) {
+            memset(Reduced->BlockValid, 0, (size_t)Reduced->BlocksX * Reduced->BlocksY);
+            continue;
         }
-        if (Found) {
-            iy++;
+        if (IsRectEmpty(Rect)) {
+            return;
+        }
+
+        // level pixels that use the display rectangle
+        int x0 = Rect->left >> Level;
+        int y0 = Rect->top >> Level;
+        int x1 = min((int)(Rect->right + (1 << Level) - 1) >> Level, Reduced->Xsize);
+        int y1 = min((int)(Rect->bottom + (1 << Level) - 1) >> Level, Reduced->Ysize);
+
+        for (int by = y0 / DISPLAY_LEVEL_BLOCK; by <= (y1 - 1) / DISPLAY_LEVEL_BLOCK; by++) {
+            for (int bx = x0 / DISPLAY_LEVEL_BLOCK; bx <= (x1 - 1) / DISPLAY_LEVEL_BLOCK; bx++) {
+                Reduced->BlockValid[by * Reduced->BlocksX + bx] = 0;
+            }
         }
     }
+}
 
+//*******************************************************************************
+//
+//  void ReleaseLevels(void)
+// 
+//  Release the kept reduced levels
+// 
+//*******************************************************************************
+void Display::ReleaseLevels(void)
+{
+    for (int Level = 1; Level < DISPLAY_MAX_LEVELS; Level++) {
+        delete[] Levels[Level].Image;
+        delete[] Levels[Level].BlockValid;
+        memset(&Levels[Level], 0, sizeof(DISPLAYLEVEL));
+    }
+}
+
+//*******************************************************************************
+//
+//  int GetOverlayPosition(int x, int y, int* OverlayX, int* OverlayY)
+// 
+//  Get the overlay pixel shown at a display pixel, from the display maps
+// 
+// int x, y             display pixel
+// int* OverlayX        returns the overlay column, or DISPLAY_GAP_MAJOR/MINOR
+// int* OverlayY        returns the overlay row, or DISPLAY_GAP_MAJOR/MINOR
+//                      an overlay column/row past the overlay size is display background
+// 
+// return
+// int          APP_SUCCESS, 1,	Success
+//              !=1	Standard application error number
+//
+//*******************************************************************************
+int Display::GetOverlayPosition(int x, int y, int* OverlayX, int* OverlayY)
+{
+    // the maps are the size of the display when it was created
+    if (DisplayXmap == NULL || DisplayYmap == NULL ||
+        x < 0 || x >= BuiltLayout.Xextent || y < 0 || y >= BuiltLayout.Yextent) {
+        return APPERR_PARAMETER;
+    }
+    *OverlayX = DisplayXmap[x];
+    *OverlayY = DisplayYmap[y];
     return APP_SUCCESS;
 }
 
+//*******************************************************************************
+//
+//  void GetUpdatedRect(RECT* Updated)
+// 
+//  Get the region of the display updated since the last call, the region
+//  is then cleared.  A virtual display is not created, the region is the
+//  part of it that would have changed.
+// 
+// RECT* Updated        returns the updated region, empty if nothing changed
+//
+//*******************************************************************************
+void Display::GetUpdatedRect(RECT* Updated)
+{
+    *Updated = UpdatedRect;
+    SetRectEmpty(&UpdatedRect);
+}
+
+//*******************************************************************************
+//
+//  BOOL IsVirtual(void)
+// 
+// return
+// BOOL         TRUE, the display image is not created, use GetDisplayTile()
+//
+//*******************************************************************************
+BOOL Display::IsVirtual(void)
+{
+    return VirtualDisplay;
+}
+
 //*******************************************************************************
 //
 //  ReleaseDisplayImages(void)
@@ -386,13 +1274,57 @@ int Display::ReleaseDisplayImages(void) {
         delete[] DisplayImage;
         DisplayImage = NULL;
     }
-    if (DisplayReference != NULL) {
-        delete[] DisplayReference;
-        DisplayReference = NULL;
-    }
+    ReleaseDisplayMaps();
+    ReleaseLevels();
+    memset(&BuiltLayout, 0, sizeof(BuiltLayout));
+    VirtualDisplay = FALSE;
     return APP_SUCCESS;
 };
 
+//*******************************************************************************
+//
+//  void ReleaseDisplayMaps(void)
+// 
+//  Release the display maps and row templates
+// 
+//*******************************************************************************
+void Display::ReleaseDisplayMaps(void) {
+    // the display and levels are made from the maps
+    InvalidateLevels(NULL);
+    DisplayValid = FALSE;
+
+    if (DisplayXmap != NULL) {
+        delete[] DisplayXmap;
+        DisplayXmap = NULL;
+    }
+    if (DisplayYmap != NULL) {
+        delete[] DisplayYmap;
+        DisplayYmap = NULL;
+    }
+    if (DisplaySpans != NULL) {
+        delete[] DisplaySpans;
+        DisplaySpans = NULL;
+    }
+    if (DisplayRowSpans != NULL) {
+        delete[] DisplayRowSpans;
+        DisplayRowSpans = NULL;
+    }
+    NumDisplaySpans = 0;
+    NumDisplayRowSpans = 0;
+    if (GapMajorRow != NULL) {
+        delete[] GapMajorRow;
+        GapMajorRow = NULL;
+    }
+    if (GapMinorRow != NULL) {
+        delete[] GapMinorRow;
+        GapMinorRow = NULL;
+    }
+    if (BackgroundRow != NULL) {
+        delete[] BackgroundRow;
+        BackgroundRow = NULL;
+    }
+};
+
 //*******************************************************************************
 //
 //  GetColors(COLORREF* BackgroundColor, COLORREF* GapMajorColor, COLORREF* GapMinorColor)
@@ -683,9 +1615,25 @@ void Display::CalculateDisplayExtent(int ImageXextent, int ImageYextent) {
 
 //*******************************************************************************
 //
-//  int SaveBMP(WCHAR* Filename)
+//  static int SaveReferenceRows(void* Context, int y, int NumRows, COLORREF* Rows)
 // 
-// This returns the current layer
+// GETBMPROWS function for SaveBMP(), create rows of the reference image
+// 
+//*******************************************************************************
+int Display::SaveReferenceRows(void* Context, int y, int NumRows, COLORREF* Rows)
+{
+    Display* Owner = (Display*)Context;
+
+    Owner->CreateReferenceRows(Rows, y, NumRows);
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int SaveBMP(WCHAR* Filename, int Select)
+// 
+// Save the display image (Select 0) or the reference image (Select 1).
+// The reference image is created a chunk of rows at a time as it is written.
 //
 //*******************************************************************************
 int Display::SaveBMP(WCHAR* Filename, int Select) {
@@ -699,14 +1647,59 @@ int Display::SaveBMP(WCHAR* Filename, int Select) {
         }
         iRes = SaveImageBMP(Filename, DisplayImage, DisplayXextent, DisplayYextent);
     } else {
-        if (DisplayReference == NULL) {
+        if (BackgroundRow == NULL || DisplayRowSpans == NULL) {
             return APPERR_PARAMETER;
         }
-        iRes = SaveImageBMP(Filename, DisplayReference, DisplayXextent, DisplayYextent);
+        iRes = SaveImageBMP(Filename, SaveReferenceRows, this, DisplayXextent, DisplayYextent);
     }
     return iRes;
 }
 
+//*******************************************************************************
+//
+//  static int SaveRows(void* Context, int y, int NumRows, COLORREF* Rows)
+// 
+// GETBMPROWS function for SaveBMP(), create rows of a virtual display
+// 
+//*******************************************************************************
+typedef struct {
+    Display* Owner;
+    COLORREF* OverlayImage;
+    int xsize;
+    int ysize;
+} SAVEJOB;
+
+int Display::SaveRows(void* Context, int y, int NumRows, COLORREF* Rows)
+{
+    SAVEJOB* Job = (SAVEJOB*)Context;
+    Display* Owner = Job->Owner;
+
+    Owner->BuildRectangle(Rows, Owner->DisplayXextent, Job->OverlayImage, Job->xsize, Job->ysize,
+        0, y, Owner->DisplayXextent, NumRows);
+    return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int SaveBMP(WCHAR* Filename, COLORREF* OverlayImage, int xsize, int ysize)
+// 
+// Save the display of a virtual display, the rows of the display are
+// created a chunk at a time as they are written.
+//
+//*******************************************************************************
+int Display::SaveBMP(WCHAR* Filename, COLORREF* OverlayImage, int xsize, int ysize) {
+    if (wcslen(Filename) == 0 || BackgroundRow == NULL) {
+        return APPERR_PARAMETER;
+    }
+    if (!VirtualDisplay) {
+        return SaveBMP(Filename, 0);
+    }
+
+    // rows are created as they are written
+    SAVEJOB Job = { this, OverlayImage, xsize, ysize };
+    return SaveImageBMP(Filename, SaveRows, &Job, DisplayXextent, DisplayYextent);
+}
+
 //*******************************************************************************
 //
 //  int LoadConfiguration(WCHAR* szFilename)
@@ -803,6 +1796,8 @@ int Display::SaveConfiguration(WCHAR* szFilename)
 //
 //  int GetDisplay(COLORREF** Image, int* xsize, int* ysize)
 //
+//  Image is NULL for a virtual display
+//
 //*******************************************************************************
 int Display::GetDisplay(COLORREF** Image, int* xsize, int* ysize)
 {
@@ -24,6 +24,18 @@
 // V0.1.0.1 2023-12-04	Initial pre release 
 // V0.2.0.1 2023-12-08  Added the Display class to provide the on screen display without the use of
 //                      a BMP file viewer.
+// V1.2.11  2026-10-17  Display rows and columns are mapped to the overlay with tables
+//                      calculated from the grid and gap settings, the reference image
+//                      is only created when it is saved
+// V1.2.12  2026-10-17  Added display row runs and row templates
+// V1.2.13  2026-10-17  Display images are kept while the layout and colors are unchanged
+// V1.2.14  2026-10-17  Display is updated in parallel tiles of rows
+// V1.2.15  2026-10-17  Added virtual displays, large displays are created a tile at a time
+// V1.2.16  2026-10-17  Added reduced display levels, partial display updates
+// V1.2.17  2026-10-17  Added display to overlay position query
+// V1.2.18  2026-10-17  Added the updated region of the display
+// V1.2.19  2026-10-17  Virtual displays are saved a chunk of rows at a time
+// V1.2.24  2026-10-17  The reference image is saved a chunk of rows at a time
 //
 // Application standardized error numbers for functions:
 //		See AppErrors.h
@@ -31,6 +43,58 @@
 //	This is the Display class for handling the formatting, display, scaling of the overlayed bitmap
 //
 
+// bytes of display image in each tile when updating the display
+#define DISPLAY_TILE_BYTES (256*1024)
+// average image run length (pixels) needed to update the display with block copies
+#define DISPLAY_MIN_COPY 16
+// displays wider or taller than this, or larger than DISPLAY_VIRTUAL_BYTES, are virtual
+// the display image is not created, rectangles are created with GetDisplayTile()
+// 16384 is the largest bitmap Direct2D supports on most hardware
+#define DISPLAY_VIRTUAL_SIZE 16384
+#define DISPLAY_VIRTUAL_BYTES ((size_t)256*1024*1024)
+
+// reduced display levels for zoomed out viewing, level L is 1/2^L of the display size
+// level 0 is the display
+#define DISPLAY_MAX_LEVELS 7
+// levels are built in blocks of this many pixels square when they are shown
+#define DISPLAY_LEVEL_BLOCK 256
+
+// display map entries that are not an overlay row/column
+#define DISPLAY_GAP_MAJOR -1
+#define DISPLAY_GAP_MINOR -2
+
+// run of display rows/columns that are all the same gap, or consecutive overlay rows/columns
+typedef struct {
+	int Start;		// first display row/column
+	int Length;		// # of rows/columns
+	int Map;		// overlay row/column of the first one, or DISPLAY_GAP_MAJOR/MINOR
+} DISPLAYSPAN;
+
+// settings used to create the display maps
+typedef struct {
+	int Xextent;
+	int Yextent;
+	int GridXmajor;
+	int GridYmajor;
+	int GridXminor;
+	int GridYminor;
+	int GapXmajor;
+	int GapYmajor;
+	int GapXminor;
+	int GapYminor;
+	BOOL GridEnabled;
+} DISPLAYLAYOUT;
+
+// kept reduced display level
+typedef struct {
+	COLORREF* Image;		// NULL, not created
+	int Xsize;
+	int Ysize;
+	int BlocksX;			// # of DISPLAY_LEVEL_BLOCK blocks
+	int BlocksY;
+	BYTE* BlockValid;		// block is up to date
+} DISPLAYLEVEL;
+
 class Display {
 public:
 	Display();
@@ -58,9 +122,18 @@ public:
 	int CreateDisplayImages(void);
 	int ReleaseDisplayImages(void);
 	int UpdateDisplay(COLORREF* OverlayImage, int xsize, int ysize);
+	int UpdateDisplay(COLORREF* OverlayImage, int xsize, int ysize, const RECT* Changed);
+	int GetDisplayTile(int Level, int x, int y, int xsize, int ysize, COLORREF* Tile,
+		COLORREF* OverlayImage, int OverlayXsize, int OverlayYsize);
+	BOOL IsVirtual(void);
+	int GetOverlayPosition(int x, int y, int* OverlayX, int* OverlayY);
+	void GetUpdatedRect(RECT* Updated);
+	void GetLevelSize(int Level, int* x, int* y);
+	void SetEmptyColors(COLORREF LayerBackground, COLORREF OverlayBackground);
 
 	void CalculateDisplayExtent(int ImageXextent, int ImageYextent);
 	int SaveBMP(WCHAR* Filename, int Select);
+	int SaveBMP(WCHAR* Filename, COLORREF* OverlayImage, int xsize, int ysize);
 
 	void LoadConfiguration(WCHAR* szFilename);
 	int SaveConfiguration(WCHAR* szFilename);
@@ -78,6 +151,9 @@ private:
 	COLORREF rgbBackground = 0;      // display background color
 	COLORREF rgbGapMajor = 0;            // display Grid color
 	COLORREF rgbGapMinor = 0;             // display Gap color
+	// overlay colors that are not a set layer pixel, for the reduced levels
+	COLORREF rgbLayerBackground = 0;
+	COLORREF rgbOverlayBackground = 0;
 
 	// display image grid size
 	int GridXmajor = 0;
@@ -101,18 +177,62 @@ private:
 	int NumberMajorYgap = 0;
 	int NumberMinorYgap = 0;
 
-	COLORREF* DisplayReference = NULL;	// This contains the gridded reference image with gaps
-										// This isused to facilitate processing of the Display Image
-										// This is recreated when the grid, gap or display color changes
+	// display to overlay maps, recreated when the grid or gap changes
+	int* DisplayXmap = NULL;			// overlay column of each display column, or DISPLAY_GAP_MAJOR/MINOR
+	int* DisplayYmap = NULL;			// overlay row of each display row, or DISPLAY_GAP_MAJOR/MINOR
+	DISPLAYSPAN* DisplaySpans = NULL;	// display columns as runs
+	int NumDisplaySpans = 0;
+	DISPLAYSPAN* DisplayRowSpans = NULL;	// display rows as runs
+	int NumDisplayRowSpans = 0;
+	BOOL CopySpans = FALSE;				// TRUE, image runs are long enough for block copies
+	BOOL VirtualDisplay = FALSE;		// TRUE, there is no display image
+
+	// display row templates, recreated when the grid, gap or display color changes
+	COLORREF* GapMajorRow = NULL;
+	COLORREF* GapMinorRow = NULL;
+	COLORREF* BackgroundRow = NULL;		// image row without the overlay
+
+	// settings of the current display image, maps and row templates
+	DISPLAYLAYOUT BuiltLayout = { 0 };
+	COLORREF BuiltBackground = 0;
+	COLORREF BuiltGapMajor = 0;
+	COLORREF BuiltGapMinor = 0;
+
+	// overlay of the last UpdateDisplay()
+	BOOL DisplayValid = FALSE;			// display matches the maps, row templates and LastOverlay
+	COLORREF* LastOverlay = NULL;
+	int LastOverlayXsize = 0;
+	int LastOverlayYsize = 0;
+	RECT UpdatedRect = { 0 };			// display region updated since GetUpdatedRect()
+
+	// reduced display levels, Levels[0] is not used
+	DISPLAYLEVEL Levels[DISPLAY_MAX_LEVELS] = { 0 };
 
 	COLORREF* DisplayImage = NULL;		// this the reference image merged with the Overlay image
 										// This is what is acutally displayed.
 										// This is updated whenever the Reference image changes or
 										// the Overlay image changes.
 
-	void CreateDisplayLine(int StartAddress,
-		COLORREF rgbBackground,
-		COLORREF rgbGapMajor,
-		COLORREF rgbGapMinor);
+	int CreateDisplayMaps(void);
+	int CreateDisplayRows(void);
+	void ReleaseDisplayMaps(void);
+	void BuildRows(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+		int StartColumn, int EndColumn, int StartRow, int EndRow);
+	static void BuildTile(void* Context, int Tile);
+	void BuildRectangle(COLORREF* Dest, size_t Stride, COLORREF* OverlayImage, int xsize, int ysize,
+		int x, int y, int Width, int Height);
+	void CreateReferenceRows(COLORREF* Rows, int y, int NumRows);
+	void OverlayToDisplay(const RECT* Overlay, RECT* Rect);
+	void ReduceRect(const COLORREF* Src, size_t SrcStride, int SrcXsize, int SrcYsize,
+		COLORREF* Dest, size_t DestStride);
+	int ReduceDisplay(int Level, const RECT* Rect, COLORREF* Dest, size_t Stride,
+		COLORREF* OverlayImage, int xsize, int ysize);
+	int CreateLevel(int Level);
+	int BuildLevel(int Level, const RECT* Rect, COLORREF* OverlayImage, int xsize, int ysize);
+	static void BuildLevelBlock(void* Context, int Block);
+	static int SaveRows(void* Context, int y, int NumRows, COLORREF* Rows);
+	static int SaveReferenceRows(void* Context, int y, int NumRows, COLORREF* Rows);
+	void InvalidateLevels(const RECT* Rect);
+	void ReleaseLevels(void);
 
 };
\ No newline at end of file
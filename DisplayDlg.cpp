@@ -25,6 +25,7 @@
 //                      update the entire dialog
 // V1.1.1   2023-12-27  Added, window position reset
 //                      Correction, reset pan poistion to 0,0 instead of 1,1
+// V1.2.16  2026-10-17  Only the changed region of the overlay is updated in the display
 //
 // Global Settings dialog box handler
 // 
@@ -516,7 +517,11 @@ void ApplyDisplay(HWND hDlg)
             MessageMySETIviewerError(hDlg, iRes, L"Display 0 gap parameter");
             return;
         }
-        iRes = Displays->UpdateDisplay(Overlay, xsize, ysize);
+        // the display keeps what it has of the overlay outside of the changed region
+        RECT Changed;
+        ImageLayers->GetChangedRect(&Changed);
+        Displays->SetEmptyColors(ImageLayers->GetBackgroundColor(), ImageLayers->GetOverlayColor());
+        iRes = Displays->UpdateDisplay(Overlay, xsize, ysize, &Changed);
         if (hwndImage != NULL) {
             PostMessage(hwndImage, WM_COMMAND, IDC_GENERATE_BMP, 0l);
             ShowWindow(hwndImage, SW_SHOW);
@@ -39,10 +39,34 @@
 //     -4 incorect file type
 //     -5 file sizes mismatch
 //     -6 not yet implemented
+//     -8 file write failure
 //
 // Some function return TRUE/FALSE results
 // 
 // V1.0.1	2023-12-20	Initial release
+// V1.2.0   2026-10-17  LoadImageFile reads the image file in blocks and converts
+//                      pixels using SSE2 instead of one fread per pixel
+// V1.2.1   2026-10-17  Added SwapImagePixels, BMP header reading split out into OpenBMPfile
+//                      Fixed 24 bit BMP pixels, || was used instead of |
+// V1.2.19  2026-10-17  SaveImageBMP writes the image in chunks of rows converted in
+//                      parallel, instead of one fwrite per byte from a full size copy
+// V1.2.20  2026-10-17  PNG files are written by the PNG encoder from the image in memory
+//                      instead of GDI+ reading back the BMP file
+// V1.2.21  2026-10-17  SaveTXT formats bands of rows in parallel with a digit pair table
+//                      instead of one fprintf per pixel, 16 bit pixels use 5 digits
+// V1.2.22  2026-10-17  HEX2Binary decodes the file in blocks using DecodeHexFile,
+//                      invalid input is reported with its byte offset
+// V1.2.24  2026-10-17  ConvertImagePixels description moved to the function
+//                      OpenBMPfile rejects BMP files that are not 1, 8 or 24 bit,
+//                      any bit count was accepted when biPlanes was 1
+//                      LoadBMPfile sets PixelSize 4 for 24 bit BMP files
+//                      SaveBMP writes through the chunked BMP writer instead of a full
+//                      size copy written a byte at a time, all writes are checked
+//                      SaveImagePNG and GetPNGfilename moved from PNGEncoder.cpp, the
+//                      PNG encoder writes through a PNGOUTPUT and does not use Windows
+//                      DecodeHexFile reads a single digit between separators as a byte,
+//                      the same as fscanf "%2x", it was rejected
+//                      Removed SaveBMP2PNG, GDI+ is no longer used
 //
 #include "framework.h"
 #include "resource.h"
@@ -50,13 +74,22 @@
 #include <winver.h>
 #include <vector>
 #include <atlstr.h>
-#include <gdiplus.h>
 #include "globals.h"
 #include <strsafe.h>
 #include "shellapi.h"
 #include "Appfunctions.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
+#include <emmintrin.h>
+#include <limits.h>
+#include <new>
+#include "ParallelTasks.h"
+#include "PNGEncoder.h"
+
+// LoadImageFile() reads the image file in blocks of this many bytes
+#define IMAGE_READ_BLOCK (1024*1024)
+// DecodeHexFile() reads the hex file in blocks of this many bytes
+#define HEX_READ_BLOCK (4*1024*1024)
 
 //****************************************************************
 //
@@ -445,6 +478,159 @@ int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
     return 1;
 }
 
+//*****************************************************************************************
+//
+//	WidenBytes, WidenShorts, SwapLongs
+// 
+//	ConvertImagePixels() kernels.  The bulk of the pixels are converted
+//	16 bytes at a time using SSE2, the remaining pixels one at a time.
+// 
+//*****************************************************************************************
+static void WidenBytes(int* Image, const BYTE* Buffer, size_t NumPixels)
+{
+    const __m128i Zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= NumPixels; i += 16) {
+        __m128i Bytes = _mm_loadu_si128((const __m128i*)(Buffer + i));
+        __m128i Low = _mm_unpacklo_epi8(Bytes, Zero);
+        __m128i High = _mm_unpackhi_epi8(Bytes, Zero);
+        _mm_storeu_si128((__m128i*)(Image + i), _mm_unpacklo_epi16(Low, Zero));
+        _mm_storeu_si128((__m128i*)(Image + i + 4), _mm_unpackhi_epi16(Low, Zero));
+        _mm_storeu_si128((__m128i*)(Image + i + 8), _mm_unpacklo_epi16(High, Zero));
+        _mm_storeu_si128((__m128i*)(Image + i + 12), _mm_unpackhi_epi16(High, Zero));
+    }
+    for (; i < NumPixels; i++) {
+        Image[i] = (int)Buffer[i];
+    }
+}
+
+static void WidenShorts(int* Image, const BYTE* Buffer, size_t NumPixels, int Swap)
+{
+    const __m128i Zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 8 <= NumPixels; i += 8) {
+        __m128i Shorts = _mm_loadu_si128((const __m128i*)(Buffer + i * 2));
+        if (Swap) {
+            Shorts = _mm_or_si128(_mm_slli_epi16(Shorts, 8), _mm_srli_epi16(Shorts, 8));
+        }
+        _mm_storeu_si128((__m128i*)(Image + i), _mm_unpacklo_epi16(Shorts, Zero));
+        _mm_storeu_si128((__m128i*)(Image + i + 4), _mm_unpackhi_epi16(Shorts, Zero));
+    }
+    for (; i < NumPixels; i++) {
+        if (Swap) {
+            Image[i] = ((int)Buffer[i * 2] << 8) | (int)Buffer[i * 2 + 1];
+        }
+        else {
+            Image[i] = (int)Buffer[i * 2] | ((int)Buffer[i * 2 + 1] << 8);
+        }
+    }
+}
+
+static void SwapLongs(int* Image, const BYTE* Buffer, size_t NumPixels)
+{
+    const __m128i Mask1 = _mm_set1_epi32(0x00ff0000);
+    const __m128i Mask2 = _mm_set1_epi32(0x0000ff00);
+    size_t i = 0;
+
+    for (; i + 4 <= NumPixels; i += 4) {
+        __m128i Longs = _mm_loadu_si128((const __m128i*)(Buffer + i * 4));
+        __m128i Swapped = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(Longs, 24), _mm_srli_epi32(Longs, 24)),
+            _mm_or_si128(_mm_and_si128(_mm_slli_epi32(Longs, 8), Mask1),
+                         _mm_and_si128(_mm_srli_epi32(Longs, 8), Mask2)));
+        _mm_storeu_si128((__m128i*)(Image + i), Swapped);
+    }
+    for (; i < NumPixels; i++) {
+        const BYTE* Pixel = Buffer + i * 4;
+        Image[i] = (int)(((DWORD)Pixel[0] << 24) | ((DWORD)Pixel[1] << 16) |
+                         ((DWORD)Pixel[2] << 8) | (DWORD)Pixel[3]);
+    }
+}
+
+//*****************************************************************************************
+//
+//	ConvertImagePixels
+// 
+//	Convert a block of raw image file pixels to 'int' pixels.
+//	This handles the pixel size (BYTE, SHORT, LONG) and the Endian of the
+//	image file.
+// 
+// Parameters:
+//	int* Image				destination, NumPixels 'int's
+//	const BYTE* Buffer		raw pixels as read from the image file
+//	size_t NumPixels		# of pixels to convert
+//	int PixelSize			1, 2 or 4 bytes per pixel
+//	int Endian				0 MAC format (byte swap), -1 PC format
+//
+//*****************************************************************************************
+void ConvertImagePixels(int* Image, const BYTE* Buffer, size_t NumPixels, int PixelSize, int Endian)
+{
+    if (PixelSize == 1) {
+        WidenBytes(Image, Buffer, NumPixels);
+    }
+    else if (PixelSize == 2) {
+        WidenShorts(Image, Buffer, NumPixels, !Endian);
+    }
+    else if (!Endian) {
+        SwapLongs(Image, Buffer, NumPixels);
+    }
+    else {
+        memcpy(Image, Buffer, NumPixels * sizeof(int));
+    }
+}
+
+//*****************************************************************************************
+//
+//	SwapShorts
+// 
+//	SwapImagePixels() kernel, byte swaps 8 shorts at a time using SSE2.
+//	32 bit pixels use SwapLongs().
+// 
+//*****************************************************************************************
+static void SwapShorts(USHORT* Image, const BYTE* Buffer, size_t NumPixels)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= NumPixels; i += 8) {
+        __m128i Shorts = _mm_loadu_si128((const __m128i*)(Buffer + i * 2));
+        Shorts = _mm_or_si128(_mm_slli_epi16(Shorts, 8), _mm_srli_epi16(Shorts, 8));
+        _mm_storeu_si128((__m128i*)(Image + i), Shorts);
+    }
+    for (; i < NumPixels; i++) {
+        Image[i] = (USHORT)(((USHORT)Buffer[i * 2] << 8) | (USHORT)Buffer[i * 2 + 1]);
+    }
+}
+
+//*****************************************************************************************
+//
+//	SwapImagePixels
+// 
+//	Copy a block of raw image file pixels keeping the pixel size.
+//	MAC format pixels are byte swapped to PC format as they are copied.
+// 
+// Parameters:
+//	BYTE* Image				destination, NumPixels*PixelSize bytes
+//	const BYTE* Buffer		raw pixels as read from the image file
+//	size_t NumPixels		# of pixels to copy
+//	int PixelSize			1, 2 or 4 bytes per pixel
+//	int Endian				0 MAC format (byte swap), -1 PC format
+//
+//*****************************************************************************************
+void SwapImagePixels(BYTE* Image, const BYTE* Buffer, size_t NumPixels, int PixelSize, int Endian)
+{
+    if (PixelSize == 1 || Endian) {
+        memcpy(Image, Buffer, NumPixels * (size_t)PixelSize);
+    }
+    else if (PixelSize == 2) {
+        SwapShorts((USHORT*)Image, Buffer, NumPixels);
+    }
+    else {
+        SwapLongs((int*)Image, Buffer, NumPixels);
+    }
+}
+
 //*****************************************************************************************
 //
 //	LoadImageFile
@@ -541,49 +727,192 @@ int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
 
     *ImagePtr = Image;
 
-    // we don't read entire file in one fread since we may need
-    // to covert pixel(BYTE,SHORT or LONG) and Endian to get correct 'int'
-    PIXEL Pixel;
-    for (int i = 0; i < xsize * ysize * NumFrames; i++) {
-        iRead = fread(&Pixel, PixelSize, 1, In);
-        if (iRead != 1) {
+    size_t NumPixels = (size_t)xsize * (size_t)ysize * (size_t)NumFrames;
+
+    if (PixelSize == 4 && Endian) {
+        // PC format 32 bit pixels are already 'int', read directly into the image
+        iRead = fread(Image, sizeof(int), NumPixels, In);
+        if (iRead != NumPixels) {
             fclose(In);
             delete[] Image;
             *ImagePtr = NULL;
             return -3;
         }
+        fclose(In);
+        return 1;
+    }
 
-        if (PixelSize == 1) {
-            Image[i] = (int)Pixel.Byte[0];
-        }
-        else if (PixelSize == 2) {
-            if (!Endian) {
-                int swap;
-                swap = Pixel.Byte[0];
-                Pixel.Byte[0] = Pixel.Byte[1];
-                Pixel.Byte[1] = swap;
-            }
-            Image[i] = (int)Pixel.uShort;
+    // all other formats are read in large blocks and then converted
+    // to 'int' (BYTE, SHORT or LONG and Endian) a block at a time
+    BYTE* Buffer;
+    size_t BlockPixels = IMAGE_READ_BLOCK / PixelSize;
+
+    Buffer = new BYTE[IMAGE_READ_BLOCK];
+    if (Buffer == NULL) {
+        fclose(In);
+        delete[] Image;
+        *ImagePtr = NULL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < NumPixels; i += BlockPixels) {
+        size_t Count = NumPixels - i;
+        if (Count > BlockPixels) {
+            Count = BlockPixels;
         }
-        else {
-            if (!Endian) {
-                int swap;
-                swap = Pixel.Byte[0];
-                Pixel.Byte[0] = Pixel.Byte[3];
-                Pixel.Byte[3] = swap;
-                swap = Pixel.Byte[1];
-                Pixel.Byte[1] = Pixel.Byte[2];
-                Pixel.Byte[2] = swap;
-            }
-            Image[i] = (int)Pixel.Long;
+        iRead = fread(Buffer, PixelSize, Count, In);
+        if (iRead != Count) {
+            fclose(In);
+            delete[] Buffer;
+            delete[] Image;
+            *ImagePtr = NULL;
+            return -3;
         }
+        ConvertImagePixels(Image + i, Buffer, Count, PixelSize, Endian);
     }
+    delete[] Buffer;
+
     fclose(In);
     // calling routine is responsible for deleting 'Image' memory
 
     return 1;
 }
 
+// converts rows y to y+NumRows-1 of an image to BMP strides, Stride bytes apart
+typedef void (*BMPCONVERTROWS)(void* Context, int y, int NumRows, BYTE* Dest, int Stride);
+// sets up rows y to y+NumRows-1 of an image before they are converted
+typedef int (*BMPGETCHUNK)(void* Context, int y, int NumRows);
+
+static int BMPStride(int biWidth, int BitCount);
+static int WriteBMPfile(WCHAR* Filename, int ImageXextent, int ImageYextent, int BitCount,
+    const RGBQUAD* ColorTable, BMPGETCHUNK GetChunk, BMPCONVERTROWS ConvertRows, void* Context);
+
+typedef struct {
+    const int* Image;           // input image, frames of Xsize x Ysize pixels
+    int Xsize;
+    int FrameSize;              // pixels in a frame
+    int PixelSize;
+    float Scale, Offset;        // 8 bpp, 16 bit input pixels to 8 bits
+    float ScaleRed, OffsetRed;  // 24 bpp, frame to color scaling
+    float ScaleGreen, OffsetGreen;
+    float ScaleBlue, OffsetBlue;
+} IMAGEBMPJOB;
+
+//****************************************************************
+//
+//  ClampPixel
+// 
+//  Clamp a scaled pixel to 0 to 255
+// 
+//****************************************************************
+static inline BYTE ClampPixel(int Pixel)
+{
+    if (Pixel < 0) {
+        return 0;
+    }
+    if (Pixel > 255) {
+        return 255;
+    }
+    return (BYTE)Pixel;
+}
+
+//****************************************************************
+//
+//  ImageRowsToBMP8
+// 
+//  BMPCONVERTROWS function for SaveBMP(), convert rows of the first
+//  frame to 8 bit BMP strides.  16 bit pixels are scaled to 8 bits.
+//  The padding at the end of each stride is set to 0.
+// 
+//****************************************************************
+static void ImageRowsToBMP8(void* Context, int y, int NumRows, BYTE* Dest, int Stride)
+{
+    IMAGEBMPJOB* Job = (IMAGEBMPJOB*)Context;
+
+    for (int Row = 0; Row < NumRows; Row++) {
+        const int* Input = Job->Image + (size_t)(y + Row) * Job->Xsize;
+        BYTE* Line = Dest + (size_t)Row * Stride;
+        int ImagePixel;
+
+        for (int x = 0; x < Job->Xsize; x++) {
+            ImagePixel = Input[x];
+            if (Job->PixelSize > 1) {
+                ImagePixel = (int)(Job->Scale * (float)ImagePixel + Job->Offset + 0.5);
+            }
+            Line[x] = (BYTE)ImagePixel;
+        }
+        memset(Line + Job->Xsize, 0, (size_t)Stride - Job->Xsize);
+    }
+}
+
+//****************************************************************
+//
+//  ImageRowsToBMP24
+// 
+//  BMPCONVERTROWS function for SaveBMP(), convert rows of the first
+//  3 frames to 24 bit BMP strides, frame 1 red, frame 2 green,
+//  frame 3 blue.  The padding at the end of each stride is set to 0.
+// 
+//****************************************************************
+static void ImageRowsToBMP24(void* Context, int y, int NumRows, BYTE* Dest, int Stride)
+{
+    IMAGEBMPJOB* Job = (IMAGEBMPJOB*)Context;
+
+    for (int Row = 0; Row < NumRows; Row++) {
+        const int* Frame1 = Job->Image + (size_t)(y + Row) * Job->Xsize;
+        const int* Frame2 = Frame1 + Job->FrameSize;
+        const int* Frame3 = Frame1 + 2 * (size_t)Job->FrameSize;
+        BYTE* Line = Dest + (size_t)Row * Stride;
+
+        for (int x = 0; x < Job->Xsize; x++) {
+            Line[x * 3] = ClampPixel((int)(Job->ScaleRed * (float)Frame3[x] + Job->OffsetRed + 0.5));
+            Line[x * 3 + 1] = ClampPixel((int)(Job->ScaleGreen * (float)Frame2[x] + Job->OffsetGreen + 0.5));
+            Line[x * 3 + 2] = ClampPixel((int)(Job->ScaleBlue * (float)Frame1[x] + Job->OffsetBlue + 0.5));
+        }
+        memset(Line + (size_t)Job->Xsize * 3, 0, (size_t)Stride - (size_t)Job->Xsize * 3);
+    }
+}
+
+typedef struct {
+    BMPCONVERTROWS ConvertRows; // makes the BMP strides of the image
+    void* Job;
+    BYTE* Line;                 // one BMP stride
+    int Stride;
+    int Xsize;                  // BMP width
+    RGBQUAD* ColorTable;        // 8 bpp color map, NULL for 24 bpp
+} BMPIMAGEROWS;
+
+//****************************************************************
+//
+//  GetBMPimageRows
+// 
+//  GETBMPROWS function for SaveBMP(), make BMP strides and convert them
+//  to COLORREF rows for the PNG file.  24 bpp strides are converted the
+//  same way a BMP reader does, byte 0 is blue.
+// 
+//****************************************************************
+static int GetBMPimageRows(void* Context, int y, int NumRows, COLORREF* Rows)
+{
+    BMPIMAGEROWS* Image = (BMPIMAGEROWS*)Context;
+
+    for (int Row = 0; Row < NumRows; Row++) {
+        BYTE* Line = Image->Line;
+        COLORREF* Dest = Rows + (size_t)Row * Image->Xsize;
+
+        Image->ConvertRows(Image->Job, y + Row, 1, Line, Image->Stride);
+        for (int x = 0; x < Image->Xsize; x++) {
+            if (Image->ColorTable) {
+                RGBQUAD* Color = &Image->ColorTable[Line[x]];
+                Dest[x] = RGB(Color->rgbRed, Color->rgbGreen, Color->rgbBlue);
+            }
+            else {
+                Dest[x] = RGB(Line[3 * x + 2], Line[3 * x + 1], Line[3 * x]);
+            }
+        }
+    }
+    return APP_SUCCESS;
+}
+
 //****************************************************************
 //
 //  SaveBMP
@@ -620,6 +949,9 @@ int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
 //          from the others. Only the first 3 frames are used.
 //
 //  If input image is odd columns in size it is 0 padded to even size.
+//
+//  Rows are converted in parallel a chunk at a time and written with
+//  one fwrite per chunk, no full size copy of the BMP image is made.
 //  
 //  return value:
 //  1 - Success
@@ -631,21 +963,16 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
     int iRes;
     int* InputImage;
     IMAGINGHEADER ImageHeader;
-    BITMAPFILEHEADER BMPheader;
-    BITMAPINFOHEADER BMPinfoheader;
+    IMAGEBMPJOB Job;
     RGBQUAD* ColorTable = NULL;
-    BYTE* BMPimage;
 
     iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
     if (iRes != 1) {
         return iRes;
     }
 
-    if (ImageHeader.PixelSize > 2) {
-        return 0;
-    }
-
-    if (ImageHeader.Xsize > 8192) {
+    if (ImageHeader.PixelSize > 2 || ImageHeader.Xsize > 8192) {
+        delete[] InputImage;
         return 0;
     }
 
@@ -653,8 +980,10 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         RGBframes = 0;
     }
 
-    DWORD BMPimageBytes;
-    int biWidth;
+    Job.Image = InputImage;
+    Job.Xsize = ImageHeader.Xsize;
+    Job.FrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+    Job.PixelSize = ImageHeader.PixelSize;
 
     if (RGBframes) {
         //
@@ -682,7 +1011,6 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         int ImagePixelGreen;
         int ImagePixelBlue;
         int InputFrameSize;
-        int Stride;
         float ScaleRed, OffsetRed;
         float ScaleGreen, OffsetGreen;
         float ScaleBlue, OffsetBlue;
@@ -764,76 +1092,12 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
             OffsetGreen = 0.0;
         }
 
-        // correct for odd column size
-        biWidth = ImageHeader.Xsize;
-        if (biWidth % 2 != 0) {
-            // make sure bitmap width is even
-            biWidth++;
-        }
-
-        // BMP files have a specific requirement for # of bytes per line
-        // This is called stride.  The formula used is from the specification.
-        Stride = ((((biWidth * 24) + 31) & ~31) >> 3); // 24 bpp
-        BMPimageBytes = Stride * ImageHeader.Ysize; // size of image in bytes
-
-        // allocate zero paddded image array
-        BMPimage = (BYTE*)calloc(BMPimageBytes, 1);
-        if (BMPimage == NULL) {
-            delete[] InputImage;
-            return -1;
-        }
-
-        int BMPOffset;
-        BYTE PixelRed, PixelGreen, PixelBlue;
-
-        // copy input image to BMPimage DIB format
-        for (int y = 0; y < ImageHeader.Ysize; y++) {
-            BlueOffset = y * ImageHeader.Xsize;
-            GreenOffset = y * ImageHeader.Xsize + InputFrameSize;
-            RedOffset = y * ImageHeader.Xsize + (2* InputFrameSize);
-            BMPOffset = y * Stride;
-            for (int x = 0; x < ImageHeader.Xsize; x++) {
-                ImagePixelRed = InputImage[RedOffset + x];
-                ImagePixelGreen = InputImage[GreenOffset + x];
-                ImagePixelBlue = InputImage[BlueOffset + x];
-                // apply scaling
-                ImagePixelRed = (int)(ScaleRed * (float)ImagePixelRed + OffsetRed + 0.5);
-                if (ImagePixelRed < 0) {
-                    PixelRed = 0;
-                }
-                else if (ImagePixelRed > 255) {
-                    PixelRed = 255;
-                }
-                else {
-                    PixelRed = ImagePixelRed;
-                }
-
-                ImagePixelGreen = (int)(ScaleGreen * (float)ImagePixelGreen + OffsetGreen + 0.5);
-                if (ImagePixelGreen < 0) {
-                    PixelGreen = 0;
-                }
-                else if (ImagePixelGreen > 255) {
-                    PixelGreen = 255;
-                }
-                else {
-                    PixelGreen = ImagePixelGreen;
-                }
-
-                ImagePixelBlue = (int)(ScaleBlue * (float)ImagePixelBlue + OffsetBlue + 0.5);
-                if (ImagePixelBlue < 0) {
-                    PixelBlue = 0;
-                }
-                else if (ImagePixelBlue > 255) {
-                    PixelBlue = 255;
-                }
-                else {
-                    PixelBlue = ImagePixelBlue;
-                }
-                BMPimage[BMPOffset + (x * 3)] = PixelRed;
-                BMPimage[BMPOffset + (x * 3) + 1] = PixelGreen;
-                BMPimage[BMPOffset + (x * 3) + 2] = PixelBlue;
-            }
-        }
+        Job.ScaleRed = ScaleRed;
+        Job.OffsetRed = OffsetRed;
+        Job.ScaleGreen = ScaleGreen;
+        Job.OffsetGreen = OffsetGreen;
+        Job.ScaleBlue = ScaleBlue;
+        Job.OffsetBlue = OffsetBlue;
     }
     else {
         //
@@ -849,7 +1113,6 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         //
         int PixelMin, PixelMax;
         int InputFrameSize;
-        int Stride;
         float Scale, Offset;
         int MaxPixel = 255;
         
@@ -897,42 +1160,8 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
             Scale = 1.0;
         }
 
-        // correct for odd column size
-        biWidth = ImageHeader.Xsize;
-        if (biWidth % 2 != 0) {
-            // make sure bitmap width is even
-            biWidth++;
-        }
-
-        // BMP files have a specific requirement for # of bytes per line
-        // This is called stride.  The formula used is from the specification.
-        Stride = ((((biWidth * 8) + 31) & ~31) >> 3); // 8 bpp
-        BMPimageBytes = Stride * ImageHeader.Ysize; // size of image in pixels, 8bpp
-
-        // allocate zero paddded image array
-        BMPimage = (BYTE*) calloc(BMPimageBytes, 1);
-        if (BMPimage == NULL) {
-            delete[] InputImage;
-            return -1;
-        }
-
-        int InputOffset;
-        int BMPOffset;
-        int ImagePixel;
-
-        // copy image to BMPimage
-        for (int y = 0; y < ImageHeader.Ysize; y++) {
-            InputOffset = y * ImageHeader.Xsize;
-            BMPOffset = y * Stride;
-            for (int x = 0; x < ImageHeader.Xsize; x++) {
-                ImagePixel = InputImage[InputOffset + x];
-                if (ImageHeader.PixelSize > 1) {
-                    ImagePixel = (int)(Scale * (float)ImagePixel + Offset + 0.5);
-                }
-                // copy results into BMPimage
-                BMPimage[BMPOffset + x] = (BYTE)ImagePixel;
-            }
-        }
+        Job.Scale = Scale;
+        Job.Offset = Offset;
 
         // generate RGBDQUAD colormaps
         int k;
@@ -958,87 +1187,134 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
 
         }
     }
-    delete[] InputImage;
 
-    // fill in BMPheader
+    // strides are made a chunk at a time as they are written
+    BMPCONVERTROWS ConvertRows = RGBframes ? ImageRowsToBMP24 : ImageRowsToBMP8;
+    int BitCount = RGBframes ? 24 : 8;
 
-    BMPheader.bfType = 0x4d42;  // required ID
-    if (!RGBframes) {
-        // 8 bpp colormap
-        BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader) + sizeof(RGBQUAD) * 256) + BMPimageBytes;
-    }
-    else {
-        // 24 bit bpp does not have a colormap
-        BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader)) + BMPimageBytes;
-    }
-    BMPheader.bfReserved1 = 0;
-    BMPheader.bfReserved2 = 0;
-    if (!RGBframes) {
-        // 8 bpp colormap
-        BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader) + sizeof(RGBQUAD) * 256);
-    }
-    else {
-        // 24 bit bpp does not have a colormap
-        BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader));
-    }
+    iRes = WriteBMPfile(Filename, ImageHeader.Xsize, ImageHeader.Ysize, BitCount, ColorTable,
+        NULL, ConvertRows, &Job);
 
-    // fill in BMPinfoheader
-    BMPinfoheader.biSize = (DWORD) sizeof(BMPinfoheader);
-    BMPinfoheader.biWidth = (LONG) biWidth; // calculated and then padded in needed
-    BMPinfoheader.biHeight = (LONG)-ImageHeader.Ysize;
-    BMPinfoheader.biPlanes = 1;
-    if (RGBframes) {
-        BMPinfoheader.biBitCount = 24;
-    }
-    else {
-        BMPinfoheader.biBitCount = 8;
-    }
-    BMPinfoheader.biCompression = BI_RGB;
-    BMPinfoheader.biSizeImage = BMPimageBytes;
-    BMPinfoheader.biXPelsPerMeter = 2834;
-    BMPinfoheader.biYPelsPerMeter = 2834;
-    BMPinfoheader.biClrUsed = 0;
-    BMPinfoheader.biClrImportant = 0;
+    if (iRes == APP_SUCCESS && AutoPNG) {
+        // PNG is made from the same strides, the BMP file is not read back
+        int biWidth = ImageHeader.Xsize + (ImageHeader.Xsize % 2);
+        BMPIMAGEROWS Rows = { ConvertRows, &Job, NULL, BMPStride(biWidth, BitCount), biWidth, ColorTable };
+        WCHAR PNGfilename[MAX_PATH];
 
-    // write BMP file
+        Rows.Line = (BYTE*)malloc(Rows.Stride);
+        if (Rows.Line == NULL) {
+            iRes = APPERR_MEMALLOC;
+        }
+        else {
+            iRes = GetPNGfilename(Filename, PNGfilename);
+            if (iRes == APP_SUCCESS) {
+                iRes = SaveImagePNG(PNGfilename, GetBMPimageRows, &Rows, biWidth, ImageHeader.Ysize);
+            }
+            free(Rows.Line);
+        }
+        if (iRes != APP_SUCCESS) {
+            iRes = 0;
+        }
+    }
 
-    FILE* Out;
-    errno_t ErrNum;
-    ErrNum = _wfopen_s(&Out, Filename, L"wb");
-    if (Out == NULL) {
-        free(BMPimage);
-        return -2;
+    delete[] InputImage;
+    if (ColorTable) {
+        delete[] ColorTable;
     }
+    return iRes;
+}
 
-    // write the BMPheader
-    fwrite(&BMPheader, sizeof(BMPheader), 1, Out);
+// "00" to "99", two digits at a time for FormatPixel()
+static const char DigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
 
-    // write the BMPinfoheader
-    fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out);
+//****************************************************************
+//
+//  FormatPixel
+// 
+//  Format a pixel the same as fprintf "%*d ", right justified in
+//  at least Width characters followed by a space.
+// 
+//  return value:
+//  end of the formatted pixel
+//
+//****************************************************************
+static char* FormatPixel(char* Dest, unsigned int Value, int Width)
+{
+    char Digits[10];
+    char* First = Digits + 10;
 
-    // write color map only if greyscale image
-    if (!RGBframes) {
-        fwrite(ColorTable, sizeof(RGBQUAD), 256, Out);
-        delete[] ColorTable;
+    while (Value >= 100) {
+        unsigned int Pair = Value % 100;
+        Value /= 100;
+        First -= 2;
+        memcpy(First, DigitPairs + 2 * Pair, 2);
+    }
+    if (Value >= 10) {
+        First -= 2;
+        memcpy(First, DigitPairs + 2 * Value, 2);
+    }
+    else {
+        *--First = (char)('0' + Value);
     }
 
-    // write the image data
-    int Address = 0;
-    for (int i = 0; i < (int)BMPimageBytes; i++) {
-        fwrite(&BMPimage[i], 1, 1, Out);
-        Address++;
+    int NumDigits = (int)(Digits + 10 - First);
+    for (int i = NumDigits; i < Width; i++) {
+        *Dest++ = ' ';
     }
+    memcpy(Dest, First, NumDigits);
+    Dest += NumDigits;
+    *Dest++ = ' ';
+    return Dest;
+}
 
-    free(BMPimage);
-    fclose(Out);
+typedef struct {
+    const int* Image;           // all frames
+    int Xsize;
+    int Ysize;
+    int Width;                  // minimum characters per pixel
+    int MaxValue;               // pixels are clipped to this
+    int FirstRow;               // rows of the chunk, counting the rows of all frames
+    int EndRow;
+    int TaskRows;               // rows formatted by each task
+    char* Buffer;               // TaskBytes for each task
+    size_t TaskBytes;
+    size_t* Len;                // returns the characters formatted by each task
+} TXTCHUNKJOB;
 
-    if (AutoPNG) {
-        if (SaveBMP2PNG(Filename) != 1) {
-            return 0;
+//****************************************************************
+//
+//  FormatTXTTask
+// 
+//  ParallelFor task, format the rows of one part of a chunk
+// 
+//****************************************************************
+static void FormatTXTTask(void* Context, int Index)
+{
+    TXTCHUNKJOB* Job = (TXTCHUNKJOB*)Context;
+    int First = Job->FirstRow + Index * Job->TaskRows;
+    int End = min(First + Job->TaskRows, Job->EndRow);
+    char* Start = Job->Buffer + (size_t)Index * Job->TaskBytes;
+    char* Dest = Start;
+
+    for (int Row = First; Row < End; Row++) {
+        const int* Pixels = Job->Image + (size_t)Row * Job->Xsize;
+        for (int x = 0; x < Job->Xsize; x++) {
+            int Pixel = Pixels[x];
+            // make sure pixel is not less than 0, clip value to match pixel size
+            if (Pixel < 0) Pixel = 0;
+            if (Pixel > Job->MaxValue) Pixel = Job->MaxValue;
+            Dest = FormatPixel(Dest, (unsigned int)Pixel, Job->Width);
+        }
+        *Dest++ = '\n';
+        if (Row % Job->Ysize == Job->Ysize - 1) {
+            // end of a frame
+            *Dest++ = '\n';
         }
     }
-
-    return 1;
+    Job->Len[Index] = Dest - Start;
 }
 
 //****************************************************************
@@ -1071,56 +1347,286 @@ int SaveTXT(WCHAR* Filename, WCHAR* InputFile)
 {
     int iRes;
     int* InputImage;
-IMAGINGHEADER ImageHeader;
+    IMAGINGHEADER ImageHeader;
 
-iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-if (iRes != 1) {
-    return iRes;
-}
+    iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+    if (iRes != 1) {
+        return iRes;
+    }
 
-FILE* Out;
-errno_t ErrNum;
-int Address;
+    TXTCHUNKJOB Job;
+    int TotalRows = ImageHeader.NumFrames * ImageHeader.Ysize;
+    int MaxTasks = GetNumWorkers() * 2;
 
-ErrNum = _wfopen_s(&Out, Filename, L"w");
-if (Out == NULL) {
-    delete[] InputImage;
-    return -2;
-}
+    Job.Image = InputImage;
+    Job.Xsize = ImageHeader.Xsize;
+    Job.Ysize = ImageHeader.Ysize;
+    if (ImageHeader.PixelSize == 1) {
+        Job.Width = 3;
+        Job.MaxValue = 255;
+    }
+    else if (ImageHeader.PixelSize == 2) {
+        Job.Width = 5;
+        Job.MaxValue = 65535;
+    }
+    else {
+        Job.Width = 7;
+        Job.MaxValue = INT_MAX;
+    }
+    Job.TaskRows = max(1, TXT_BAND_PIXELS / ImageHeader.Xsize);
+    // widest pixel is 10 digits and a space, each row can end with 2 newlines
+    Job.TaskBytes = (size_t)Job.TaskRows * ((size_t)ImageHeader.Xsize * 11 + 2);
+    Job.Buffer = (char*)malloc((size_t)MaxTasks * Job.TaskBytes);
+    Job.Len = new size_t[MaxTasks];
+    if (Job.Buffer == NULL || Job.Len == NULL) {
+        free(Job.Buffer);
+        if (Job.Len) {
+            delete[] Job.Len;
+        }
+        delete[] InputImage;
+        return APPERR_MEMALLOC;
+    }
 
-// save file in text format, blank line between frames
-Address = 0;
-int Pixel;
+    FILE* Out;
+    errno_t ErrNum;
 
-for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
-    for (int y = 0; y < ImageHeader.Ysize; y++) {
-        for (int x = 0; x < ImageHeader.Xsize; x++) {
-            Pixel = InputImage[Address];
-            // make sure pixel is not less than 0
-            if (Pixel < 0) Pixel = 0;
-            if (ImageHeader.PixelSize == 1) {
-                // clip value to match pixel size
-                if (Pixel > 255) Pixel = 255;
-                fprintf(Out, "%3d ", Pixel);
+    ErrNum = _wfopen_s(&Out, Filename, L"w");
+    if (Out == NULL) {
+        free(Job.Buffer);
+        delete[] Job.Len;
+        delete[] InputImage;
+        return APPERR_FILEOPEN;
+    }
+
+    // save file in text format, blank line between frames
+    // bands of rows are formatted in parallel, then written in order
+    iRes = APP_SUCCESS;
+    for (int Row = 0; Row < TotalRows && iRes == APP_SUCCESS; Row += MaxTasks * Job.TaskRows) {
+        Job.FirstRow = Row;
+        Job.EndRow = min(Row + MaxTasks * Job.TaskRows, TotalRows);
+        int NumTasks = (Job.EndRow - Row + Job.TaskRows - 1) / Job.TaskRows;
+        ParallelFor(NumTasks, FormatTXTTask, &Job);
+
+        for (int Task = 0; Task < NumTasks; Task++) {
+            if (fwrite(Job.Buffer + (size_t)Task * Job.TaskBytes, 1, Job.Len[Task], Out) != Job.Len[Task]) {
+                iRes = APPERR_FILEWRITE;
+                break;
             }
-            else if (ImageHeader.PixelSize == 1) {
-                // clip value to match pixel size
-                if (Pixel > 65535) Pixel = 65535;
-                fprintf(Out, "%5d ", Pixel);
+        }
+    }
+    if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+        iRes = APPERR_FILEWRITE;
+    }
+    free(Job.Buffer);
+    delete[] Job.Len;
+    delete[] InputImage;
+
+    return iRes;
+}
+
+// HexDigit[] values that are not digits
+#define HEX_INVALID -1
+#define HEX_SEPARATOR 16
+
+// hex digit value of each character, or HEX_SEPARATOR for whitespace
+// and the , : ; separators
+static signed char HexDigit[256];
+static BOOL HexDigitValid = FALSE;
+
+static void MakeHexDigitTable(void)
+{
+    if (HexDigitValid) {
+        return;
+    }
+    memset(HexDigit, HEX_INVALID, sizeof(HexDigit));
+    for (int i = 0; i < 10; i++) {
+        HexDigit['0' + i] = (signed char)i;
+    }
+    for (int i = 0; i < 6; i++) {
+        HexDigit['a' + i] = (signed char)(10 + i);
+        HexDigit['A' + i] = (signed char)(10 + i);
+    }
+    const char Separators[] = " \t\r\n\f\v,:;";
+    for (int i = 0; Separators[i] != 0; i++) {
+        HexDigit[(BYTE)Separators[i]] = HEX_SEPARATOR;
+    }
+    HexDigitValid = TRUE;
+}
+
+//****************************************************************
+//
+//  DecodeHex16
+// 
+//  Decode 16 hex digits into 8 bytes using SSE2
+// 
+//  return value:
+//  TRUE - decoded, FALSE - the 16 characters are not all hex digits
+//
+//****************************************************************
+static BOOL DecodeHex16(const BYTE* Input, BYTE* Output)
+{
+    __m128i Chars = _mm_loadu_si128((const __m128i*)Input);
+    // signed compares, bias so '0'..'9' and 'a'..'f' are ranges
+    __m128i Digits = _mm_sub_epi8(Chars, _mm_set1_epi8('0'));
+    __m128i Lower = _mm_sub_epi8(_mm_or_si128(Chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i IsDigit = _mm_and_si128(_mm_cmpgt_epi8(Digits, _mm_set1_epi8(-1)),
+        _mm_cmplt_epi8(Digits, _mm_set1_epi8(10)));
+    __m128i IsLetter = _mm_and_si128(_mm_cmpgt_epi8(Lower, _mm_set1_epi8(-1)),
+        _mm_cmplt_epi8(Lower, _mm_set1_epi8(6)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(IsDigit, IsLetter)) != 0xffff) {
+        return FALSE;
+    }
+    __m128i Nibbles = _mm_or_si128(_mm_and_si128(IsDigit, Digits),
+        _mm_and_si128(IsLetter, _mm_add_epi8(Lower, _mm_set1_epi8(10))));
+    // first digit of each pair is the high nibble
+    __m128i Pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(Nibbles, _mm_set1_epi16(0xff)), 4),
+        _mm_srli_epi16(Nibbles, 8));
+    _mm_storel_epi64((__m128i*)Output, _mm_packus_epi16(Pairs, Pairs));
+    return TRUE;
+}
+
+//****************************************************************
+//
+//  DecodeHexFile
+// 
+//  Convert a text file of hex bytes to a binary file.
+//  Whitespace and , : ; are separators and are skipped.  Bytes are read
+//  the same as fscanf "%2x", each run of hex digits between separators
+//  is split into pairs from its start, a single digit left at the end
+//  of a run is a byte of its own, "1 2 a" is 01 02 0A and "123" is
+//  12 03.  The input is read and the output written HEX_READ_BLOCK at
+//  a time.
+// 
+//  Parameters:
+//      WCHAR* InputFilename    hex text file
+//      WCHAR* OutputFilename   binary file
+//      LONGLONG* ErrorOffset   returns the byte offset in the input file
+//                              of invalid input, -1 if none
+// 
+//  return value:
+//  1 - Success
+//  -4 - invalid character, see ErrorOffset
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int DecodeHexFile(WCHAR* InputFilename, WCHAR* OutputFilename, LONGLONG* ErrorOffset)
+{
+    FILE* Input;
+    FILE* Output;
+    errno_t ErrNum;
+    BYTE* InBuffer;
+    BYTE* OutBuffer;
+    int iRes = APP_SUCCESS;
+
+    *ErrorOffset = -1;
+    MakeHexDigitTable();
+
+    InBuffer = (BYTE*)malloc(HEX_READ_BLOCK);
+    OutBuffer = (BYTE*)malloc(HEX_READ_BLOCK / 2 + 1);
+    if (InBuffer == NULL || OutBuffer == NULL) {
+        free(InBuffer);
+        free(OutBuffer);
+        return APPERR_MEMALLOC;
+    }
+
+    ErrNum = _wfopen_s(&Input, InputFilename, L"rb");
+    if (Input == NULL) {
+        free(InBuffer);
+        free(OutBuffer);
+        return APPERR_FILEOPEN;
+    }
+    ErrNum = _wfopen_s(&Output, OutputFilename, L"wb");
+    if (Output == NULL) {
+        fclose(Input);
+        free(InBuffer);
+        free(OutBuffer);
+        return APPERR_FILEOPEN;
+    }
+    // blocks are read and written in one call, no stream buffers are needed
+    setvbuf(Input, NULL, _IONBF, 0);
+    setvbuf(Output, NULL, _IONBF, 0);
+
+    LONGLONG Offset = 0;            // file offset of InBuffer[0]
+    int High = -1;                  // first digit of a pair, -1 if none
+
+    while (iRes == APP_SUCCESS) {
+        size_t NumRead = fread(InBuffer, 1, HEX_READ_BLOCK, Input);
+        if (NumRead == 0) {
+            if (ferror(Input)) {
+                iRes = APPERR_FILEREAD;
             }
-            else {
-                fprintf(Out, "%7d ", Pixel);
+            break;
+        }
+
+        size_t i = 0;
+        size_t NumOut = 0;
+        while (i < NumRead) {
+            if (High < 0) {
+                // runs of digits 16 at a time
+                while (i + 16 <= NumRead && DecodeHex16(InBuffer + i, OutBuffer + NumOut)) {
+                    i += 16;
+                    NumOut += 8;
+                }
+            }
+            // the next 16 characters one at a time before trying again
+            size_t End = min(i + 16, NumRead);
+            for (; i < End; i++) {
+                int Digit = HexDigit[InBuffer[i]];
+                if (High < 0 && (unsigned)Digit < HEX_SEPARATOR && i + 1 < NumRead &&
+                    (unsigned)HexDigit[InBuffer[i + 1]] < HEX_SEPARATOR) {
+                    // whole pair
+                    OutBuffer[NumOut++] = (BYTE)((Digit << 4) | HexDigit[InBuffer[i + 1]]);
+                    i++;
+                }
+                else if ((unsigned)Digit < HEX_SEPARATOR) {
+                    if (High < 0) {
+                        High = Digit;
+                    }
+                    else {
+                        OutBuffer[NumOut++] = (BYTE)((High << 4) | Digit);
+                        High = -1;
+                    }
+                }
+                else {
+                    if (High >= 0) {
+                        // a single digit is a byte, the same as fscanf "%2x"
+                        OutBuffer[NumOut++] = (BYTE)High;
+                        High = -1;
+                    }
+                    if (Digit == HEX_INVALID) {
+                        *ErrorOffset = Offset + i;
+                        iRes = APPERR_FILETYPE;
+                        break;
+                    }
+                }
+            }
+            if (iRes != APP_SUCCESS) {
+                break;
             }
-            Address++;
         }
-        fprintf(Out, "\n");
+
+        // bytes before an error are still written
+        if (NumOut > 0 && fwrite(OutBuffer, 1, NumOut, Output) != NumOut) {
+            iRes = APPERR_FILEWRITE;
+        }
+        Offset += NumRead;
+    }
+    if (iRes == APP_SUCCESS && High >= 0) {
+        // file ends with a single digit
+        BYTE Last = (BYTE)High;
+        if (fwrite(&Last, 1, 1, Output) != 1) {
+            iRes = APPERR_FILEWRITE;
+        }
     }
-    fprintf(Out, "\n");
-}
-fclose(Out);
-delete[] InputImage;
 
-return 1;
+    if (fclose(Output) != 0 && iRes == APP_SUCCESS) {
+        iRes = APPERR_FILEWRITE;
+    }
+    fclose(Input);
+    free(InBuffer);
+    free(OutBuffer);
+    return iRes;
 }
 
 //****************************************************************
@@ -1165,36 +1671,18 @@ int HEX2Binary(HWND hWnd)
     WritePrivateProfileString(L"Hex2Binary", L"InputFile", InputFilename, (LPCTSTR)strAppNameINI);
     WritePrivateProfileString(L"Hex2Binary", L"OutputFile", OutputFilename, (LPCTSTR)strAppNameINI);
 
-    FILE* Input;
-    FILE* Output;
-    errno_t ErrNum;
-    BYTE HexValue;
-    int HexRead;
     int iRes;
+    LONGLONG ErrorOffset;
 
-    ErrNum = _wfopen_s(&Input, InputFilename, L"rb");
-    if (Input ==NULL) {
-        return -2;
-    }
-
-    ErrNum = _wfopen_s(&Output, OutputFilename, L"wb");
-    if (Output == NULL) {
-        return -2;
-    }
-
-    while (!feof(Input)) {
-        iRes = fscanf_s(Input, "%2x", &HexRead);
-        if (iRes != 1) {
-            break;
-        }
-        HexValue = (BYTE)HexRead;
-        fwrite(&HexValue, 1, 1, Output);
+    iRes = DecodeHexFile(InputFilename, OutputFilename, &ErrorOffset);
+    if (iRes == APPERR_FILETYPE && ErrorOffset >= 0) {
+        WCHAR szString[MAX_PATH];
+        swprintf_s(szString, MAX_PATH, L"Invalid hex input at byte offset %lld\nThe bytes before it were converted",
+            ErrorOffset);
+        MessageBox(hWnd, szString, L"Hex to binary", MB_OK);
     }
 
-    fclose(Output);
-    fclose(Input);
-
-    return 1;
+    return iRes;
 }
 
 //****************************************************************
@@ -1382,124 +1870,146 @@ int GetFileSize(WCHAR* szString)
 
 //****************************************************************
 //
-//  SaveBMP2PNG
+//  ColorRowToBMP
 // 
-// This is based on a solution provided at:
-// https://learn.microsoft.com/en-us/windows/win32/gdiplus/-gdiplus-converting-a-bmp-image-to-a-png-image-use
+//  Convert a row of COLORREF pixels to a 24 bit BMP stride row, B G R
+//  byte order.  4 pixels are written as 3 DWORDs.
+//  The padding at the end of the stride is set to 0.
 // 
 //****************************************************************
-// using namespace Gdiplus;
-
-int SaveBMP2PNG(WCHAR* Filename)
+static void ColorRowToBMP(BYTE* Dest, const COLORREF* Row, int xsize, int Stride)
 {
-    // Initialize GDI+.
-    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-    ULONG_PTR gdiplusToken;
-    Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
-
-    CLSID   encoderClsid;
-    Gdiplus::Status  stat;
-
-    // load BMP file to image
-    Gdiplus::Image* image = new Gdiplus::Image(Filename);
-
-    // Get the CLSID of the PNG encoder.
-    GetEncoderClsid(L"image/png", &encoderClsid);
-    // generate .png name version of Filename
-    {
-        //parse for just filename
-        int err;
-        WCHAR Drive[_MAX_DRIVE];
-        WCHAR Dir[_MAX_DIR];
-        WCHAR Fname[_MAX_FNAME];
-        WCHAR Ext[_MAX_EXT];
-        WCHAR PNGfilename[MAX_PATH];
-
-        // split apart original filename
-        err = _wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
-            _MAX_FNAME, Ext, _MAX_EXT);
-        if (err != 0) {
-            return 0;
-        }
+    int x = 0;
+    DWORD* Dest32 = (DWORD*)Dest;
+
+    for (; x + 4 <= xsize; x += 4) {
+        // 0x00BBGGRR to 0x00RRGGBB, bytes B G R 0
+        DWORD p0 = ((Row[x] & 0xff) << 16) | (Row[x] & 0xff00) | ((Row[x] >> 16) & 0xff);
+        DWORD p1 = ((Row[x + 1] & 0xff) << 16) | (Row[x + 1] & 0xff00) | ((Row[x + 1] >> 16) & 0xff);
+        DWORD p2 = ((Row[x + 2] & 0xff) << 16) | (Row[x + 2] & 0xff00) | ((Row[x + 2] >> 16) & 0xff);
+        DWORD p3 = ((Row[x + 3] & 0xff) << 16) | (Row[x + 3] & 0xff00) | ((Row[x + 3] >> 16) & 0xff);
+        Dest32[0] = p0 | (p1 << 24);
+        Dest32[1] = (p1 >> 8) | (p2 << 16);
+        Dest32[2] = (p2 >> 16) | (p3 << 8);
+        Dest32 += 3;
+    }
+    BYTE* Dest8 = (BYTE*)Dest32;
+    for (; x < xsize; x++) {
+        Dest8[0] = (BYTE)(Row[x] >> 16);
+        Dest8[1] = (BYTE)(Row[x] >> 8);
+        Dest8[2] = (BYTE)Row[x];
+        Dest8 += 3;
+    }
+    memset(Dest8, 0, Stride - (size_t)xsize * 3);
+}
 
-        err = _wmakepath_s(PNGfilename, _MAX_PATH, Drive, Dir, Fname, L".png");
-        if (err != 0) {
-            return 0;
-        }
+typedef struct {
+    BMPCONVERTROWS ConvertRows;
+    void* Context;              // passed to ConvertRows()
+    BYTE* Dest;                 // BMP strides of the chunk
+    int Stride;
+    int y;                      // first image row of the chunk
+    int NumRows;                // rows in the chunk
+    int TaskRows;               // rows converted by each task
+} BMPCHUNKJOB;
 
-        stat = image->Save(PNGfilename, &encoderClsid, NULL);
-    }
-    delete image;
-    Gdiplus::GdiplusShutdown(gdiplusToken);
+//****************************************************************
+//
+//  ConvertBMPTask
+// 
+//  ParallelFor task, convert the rows of one part of a chunk
+// 
+//****************************************************************
+static void ConvertBMPTask(void* Context, int Index)
+{
+    BMPCHUNKJOB* Job = (BMPCHUNKJOB*)Context;
+    int First = Index * Job->TaskRows;
+    int End = min(First + Job->TaskRows, Job->NumRows);
 
-    if (stat == Gdiplus::Ok) {
-        return 1;
+    if (First < End) {
+        Job->ConvertRows(Job->Context, Job->y + First, End - First,
+            Job->Dest + (size_t)First * Job->Stride, Job->Stride);
     }
-
-    return 0;
 }
 
 //****************************************************************
 //
-//  SaveImageBMP
+//  BMPStride
+// 
+//  BMP files have a specific requirement for # of bytes per line
+//  This is called stride.  The formula used is from the specification.
 // 
 //****************************************************************
-int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYextent) {
-    if (wcslen(Filename) == 0) {
-        return APPERR_PARAMETER;
-    }
+static int BMPStride(int biWidth, int BitCount)
+{
+    return ((((biWidth * BitCount) + 31) & ~31) >> 3);
+}
 
+//****************************************************************
+//
+//  WriteBMPfile
+// 
+//  Write an 8 or 24 bit BMP file.  The image is converted and written
+//  BMP_CHUNK_BYTES at a time, the rows of each chunk are converted in
+//  parallel and the chunk is written with one fwrite.
+// 
+//  Parameters:
+//      WCHAR* Filename         BMP file
+//      int ImageXextent, ImageYextent  size of the image, odd widths
+//                              are padded to even
+//      int BitCount            8 or 24
+//      RGBQUAD* ColorTable     256 colors for 8 bit, NULL for 24 bit
+//      BMPGETCHUNK GetChunk    called before the rows of each chunk are
+//                              converted, NULL if not needed
+//      BMPCONVERTROWS ConvertRows  converts rows to BMP strides, it is
+//                              called from several threads at once
+//      void* Context           passed to GetChunk() and ConvertRows()
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+static int WriteBMPfile(WCHAR* Filename, int ImageXextent, int ImageYextent, int BitCount,
+    const RGBQUAD* ColorTable, BMPGETCHUNK GetChunk, BMPCONVERTROWS ConvertRows, void* Context)
+{
     int biWidth;
     int Stride;
-    int BMPimageBytes;
-    BYTE* BMPimage = NULL;
+    DWORD BMPimageBytes;
+    DWORD ColorTableBytes;
 
     // correct for odd column size
-
     biWidth = ImageXextent;
     if (biWidth % 2 != 0) {
         // make sure bitmap width is even
         biWidth++;
     }
+    Stride = BMPStride(biWidth, BitCount);
+    BMPimageBytes = (DWORD)Stride * ImageYextent; // size of image in bytes
+    ColorTableBytes = ColorTable ? (DWORD)sizeof(RGBQUAD) * 256 : 0;
 
-    // BMP files have a specific requirement for # of bytes per line
-    // This is called stride.  The formula used is from the specification. 
-    Stride = ((((biWidth * 24) + 31) & ~31) >> 3); // 24 bpp
-    BMPimageBytes = Stride * ImageYextent; // size of image in bytes
-
-    // allocate zero paddded image array
-    BMPimage = (BYTE*)calloc(BMPimageBytes, 1);
-    if (BMPimage == NULL) {
-        return APPERR_MEMALLOC;
+    // rows converted and written at a time
+    int ChunkRows = BMP_CHUNK_BYTES / Stride;
+    if (ChunkRows < 1) {
+        ChunkRows = 1;
+    }
+    if (ChunkRows > ImageYextent) {
+        ChunkRows = ImageYextent;
     }
 
-    int BMPOffset;
-    int Offset;
-    union {
-        COLORREF Color;
-        RGBQUAD rgb;
-    } iColor;
-
-    // copy input COLORREF image to BMPimage DIB format
-    for (int y = 0; y < ImageYextent; y++) {
-        Offset = y * ImageXextent;
-        BMPOffset = y * Stride;
-        for (int x = 0; x < ImageXextent; x++) {
-            iColor.Color = Image[Offset + x];
-            BMPimage[BMPOffset + (x * 3)] = iColor.rgb.rgbRed;
-            BMPimage[BMPOffset + (x * 3) + 1] = iColor.rgb.rgbGreen;
-            BMPimage[BMPOffset + (x * 3) + 2] = iColor.rgb.rgbBlue;
-        }
+    BYTE* Chunk = (BYTE*)malloc((size_t)ChunkRows * Stride);
+    if (Chunk == NULL) {
+        return APPERR_MEMALLOC;
     }
 
     // fill in BMPheader
     BITMAPFILEHEADER BMPheader;
 
     BMPheader.bfType = 0x4d42;  // required ID
-    BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER)) + BMPimageBytes;
+    BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER)) + ColorTableBytes + BMPimageBytes;
     BMPheader.bfReserved1 = 0;
     BMPheader.bfReserved2 = 0;
-    BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER));
+    BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER)) + ColorTableBytes;
 
     // fill in BMPinfoheader
     BITMAPINFOHEADER BMPinfoheader;
@@ -1508,7 +2018,7 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
     BMPinfoheader.biWidth = (LONG)biWidth; // calculated and then padded if needed
     BMPinfoheader.biHeight = (LONG)-ImageYextent;
     BMPinfoheader.biPlanes = 1;
-    BMPinfoheader.biBitCount = 24;
+    BMPinfoheader.biBitCount = (WORD)BitCount;
     BMPinfoheader.biCompression = BI_RGB;
     BMPinfoheader.biSizeImage = BMPimageBytes;
     BMPinfoheader.biXPelsPerMeter = 2834;
@@ -1522,28 +2032,169 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
     errno_t ErrNum;
     ErrNum = _wfopen_s(&Out, Filename, L"wb");
     if (Out == NULL) {
-        free(BMPimage);
+        free(Chunk);
         return APPERR_FILEOPEN;
     }
+    // chunks are written in one call, no stream buffer is needed
+    setvbuf(Out, NULL, _IONBF, 0);
 
-    // write the BMPheader
-    fwrite(&BMPheader, sizeof(BMPheader), 1, Out);
+    int iRes = APP_SUCCESS;
 
-    // write the BMPinfoheader
-    fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out);
+    // write the BMPheader, BMPinfoheader and the color map of 8 bit files
+    if (fwrite(&BMPheader, sizeof(BMPheader), 1, Out) != 1 ||
+        fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out) != 1 ||
+        (ColorTable && fwrite(ColorTable, sizeof(RGBQUAD), 256, Out) != 256)) {
+        iRes = APPERR_FILEWRITE;
+    }
 
     // write the image data
-    int Address = 0;
-    for (int i = 0; i < (int)BMPimageBytes; i++) {
-        fwrite(&BMPimage[i], 1, 1, Out);
-        Address++;
+    for (int y = 0; y < ImageYextent && iRes == APP_SUCCESS; y += ChunkRows) {
+        BMPCHUNKJOB Job;
+
+        Job.ConvertRows = ConvertRows;
+        Job.Context = Context;
+        Job.Dest = Chunk;
+        Job.Stride = Stride;
+        Job.y = y;
+        Job.NumRows = min(ChunkRows, ImageYextent - y);
+        if (GetChunk != NULL) {
+            iRes = GetChunk(Context, y, Job.NumRows);
+            if (iRes != APP_SUCCESS) {
+                break;
+            }
+        }
+
+        // about 4 tasks per worker
+        int NumTasks = min(Job.NumRows, GetNumWorkers() * 4);
+        Job.TaskRows = (Job.NumRows + NumTasks - 1) / NumTasks;
+        NumTasks = (Job.NumRows + Job.TaskRows - 1) / Job.TaskRows;
+        ParallelFor(NumTasks, ConvertBMPTask, &Job);
+
+        if (fwrite(Chunk, Stride, Job.NumRows, Out) != (size_t)Job.NumRows) {
+            iRes = APPERR_FILEWRITE;
+        }
+    }
+
+    free(Chunk);
+    if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+        iRes = APPERR_FILEWRITE;
+    }
+    return iRes;
+}
+
+typedef struct {
+    GETBMPROWS GetRows;         // NULL, Image is the image
+    void* Context;              // passed to GetRows()
+    const COLORREF* Image;
+    COLORREF* Rows;             // rows from GetRows()
+    const COLORREF* ChunkRows;  // rows of the chunk being written
+    int ChunkY;                 // first image row of the chunk
+    int xsize;
+} COLORBMPJOB;
+
+//****************************************************************
+//
+//  GetColorChunk
+// 
+//  BMPGETCHUNK function for SaveImageBMP(), get the rows of a chunk
+// 
+//****************************************************************
+static int GetColorChunk(void* Context, int y, int NumRows)
+{
+    COLORBMPJOB* Job = (COLORBMPJOB*)Context;
+
+    Job->ChunkY = y;
+    if (Job->GetRows != NULL) {
+        Job->ChunkRows = Job->Rows;
+        return Job->GetRows(Job->Context, y, NumRows, Job->Rows);
+    }
+    Job->ChunkRows = Job->Image + (size_t)y * Job->xsize;
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  ColorRowsToBMP
+// 
+//  BMPCONVERTROWS function for SaveImageBMP(), rows of the chunk to
+//  24 bit strides
+// 
+//****************************************************************
+static void ColorRowsToBMP(void* Context, int y, int NumRows, BYTE* Dest, int Stride)
+{
+    COLORBMPJOB* Job = (COLORBMPJOB*)Context;
+
+    for (int Row = 0; Row < NumRows; Row++) {
+        ColorRowToBMP(Dest + (size_t)Row * Stride, Job->ChunkRows + (size_t)(y - Job->ChunkY + Row) * Job->xsize,
+            Job->xsize, Stride);
+    }
+}
+
+//****************************************************************
+//
+//  SaveImageBMP
+// 
+//  Save a COLORREF image as a 24 bit BMP file.
+//  The image is converted and written BMP_CHUNK_BYTES at a time, a
+//  full size copy of the image is not made.  The rows of each chunk
+//  are converted in parallel.
+// 
+//  Parameters:
+//      WCHAR* Filename         BMP file
+//      COLORREF* Image         image, ImageXextent x ImageYextent
+//  or
+//      GETBMPROWS GetRows      creates rows of the image as they are written
+//      void* Context           passed to GetRows()
+// 
+//      int ImageXextent, ImageYextent  size of the image
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int SaveImageBMP(WCHAR* Filename, COLORREF* Image, int ImageXextent, int ImageYextent) {
+    if (Image == NULL) {
+        return APPERR_PARAMETER;
     }
+    // without GetRows the context is the image
+    return SaveImageBMP(Filename, NULL, Image, ImageXextent, ImageYextent);
+}
 
-    free(BMPimage);
-    fclose(Out);
+int SaveImageBMP(WCHAR* Filename, GETBMPROWS GetRows, void* Context, int ImageXextent, int ImageYextent) {
+    if (wcslen(Filename) == 0 || ImageXextent <= 0 || ImageYextent <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    COLORBMPJOB Job = { GetRows, Context, (const COLORREF*)Context, NULL, NULL, 0, ImageXextent };
+    if (GetRows != NULL) {
+        // rows of one chunk, the same as WriteBMPfile()
+        int Stride = BMPStride(ImageXextent + (ImageXextent % 2), 24);
+        int ChunkRows = min(max(BMP_CHUNK_BYTES / Stride, 1), ImageYextent);
+        Job.Image = NULL;
+        Job.Rows = new (std::nothrow) COLORREF[(size_t)ChunkRows * ImageXextent];
+        if (Job.Rows == NULL) {
+            return APPERR_MEMALLOC;
+        }
+    }
+
+    int iRes = WriteBMPfile(Filename, ImageXextent, ImageYextent, 24, NULL, GetColorChunk, ColorRowsToBMP, &Job);
+    if (Job.Rows) {
+        delete[] Job.Rows;
+    }
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
 
     if (AutoPNG) {
-        if (SaveBMP2PNG(Filename) != 1) {
+        // PNG is made from the same image, the BMP file is not read back
+        WCHAR PNGfilename[MAX_PATH];
+
+        iRes = GetPNGfilename(Filename, PNGfilename);
+        if (iRes == APP_SUCCESS) {
+            iRes = SaveImagePNG(PNGfilename, GetRows, Context, ImageXextent, ImageYextent);
+        }
+        if (iRes != APP_SUCCESS) {
             return 0;
         }
     }
@@ -1552,16 +2203,144 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
 
 //****************************************************************
 //
-//  LoadBMPfile
+//  PNG file output, see PNGEncoder.cpp
+//
+//****************************************************************
+typedef struct {
+    GETBMPROWS GetRows;
+    void* Context;
+} PNGROWSJOB;
+
+// PNGGETROWS for a GETBMPROWS, a PNGPIXEL is a COLORREF
+static int GetPNGrows(void* Context, int y, int NumRows, PNGPIXEL* Rows)
+{
+    PNGROWSJOB* Job = (PNGROWSJOB*)Context;
+
+    return Job->GetRows(Job->Context, y, NumRows, (COLORREF*)Rows);
+}
+
+// PNGOUTPUT write function
+static int WritePNGfile(void* File, const uint8_t* Data, size_t Len)
+{
+    return fwrite(Data, Len, 1, (FILE*)File) == 1 ? APP_SUCCESS : APPERR_FILEWRITE;
+}
+
+//****************************************************************
+//
+//  SaveImagePNG
+// 
+//  Save a COLORREF image as a PNG file.  Images with 256 colors or less
+//  are saved as palette images, others as 24 bit RGB.  The file is
+//  written by EncodePNG() and its bands are compressed in parallel
+//  using ParallelFor().
 // 
+//  Parameters:
+//      WCHAR* Filename         PNG file
+//      COLORREF* Image         image, ImageXextent x ImageYextent
+//  or
+//      GETBMPROWS GetRows      creates rows of the image, it is called twice
+//                              for each row, once to find the colors and
+//                              once to write them
+//      void* Context           passed to GetRows()
+// 
+//      int ImageXextent, ImageYextent  size of the image
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
 //****************************************************************
-int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
+int SaveImagePNG(WCHAR* Filename, COLORREF* Image, int ImageXextent, int ImageYextent) {
+    if (Image == NULL) {
+        return APPERR_PARAMETER;
+    }
+    // without GetRows the context is the image
+    return SaveImagePNG(Filename, NULL, Image, ImageXextent, ImageYextent);
+}
+
+int SaveImagePNG(WCHAR* Filename, GETBMPROWS GetRows, void* Context, int ImageXextent, int ImageYextent) {
+    PNGROWSJOB Job = { GetRows, Context };
+    PNGOUTPUT Output;
+    FILE* Out;
+    errno_t ErrNum;
+    int iRes;
+
+    if (wcslen(Filename) == 0 || ImageXextent <= 0 || ImageYextent <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    ErrNum = _wfopen_s(&Out, Filename, L"wb");
+    if (Out == NULL) {
+        return APPERR_FILEOPEN;
+    }
+    Output.Write = WritePNGfile;
+    Output.File = Out;
+    Output.ParallelFor = ParallelFor;
+    Output.NumWorkers = GetNumWorkers();
+    if (GetRows != NULL) {
+        iRes = EncodePNG(&Output, GetPNGrows, &Job, ImageXextent, ImageYextent);
+    }
+    else {
+        iRes = EncodePNG(&Output, NULL, Context, ImageXextent, ImageYextent);
+    }
+    if (fclose(Out) != 0 && iRes == APP_SUCCESS) {
+        iRes = APPERR_FILEWRITE;
+    }
+    return iRes;
+}
+
+//****************************************************************
+//
+//  GetPNGfilename
+// 
+//  Parameters:
+//      WCHAR* Filename         file name to change to .png
+//      WCHAR* PNGfilename      returns the .png file name, MAX_PATH
+// 
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int GetPNGfilename(WCHAR* Filename, WCHAR* PNGfilename) {
+    WCHAR Drive[_MAX_DRIVE];
+    WCHAR Dir[_MAX_DIR];
+    WCHAR Fname[_MAX_FNAME];
+    WCHAR Ext[_MAX_EXT];
+
+    if (_wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname, _MAX_FNAME, Ext, _MAX_EXT) != 0) {
+        return APPERR_PARAMETER;
+    }
+    if (_wmakepath_s(PNGfilename, MAX_PATH, Drive, Dir, Fname, L".png") != 0) {
+        return APPERR_PARAMETER;
+    }
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  OpenBMPfile
+// 
+//  Open a BMP file and read its headers.  Only uncompressed 1, 8 and
+//  24 bit BMP files are accepted.  The color table is skipped, on success
+//  the file is positioned at the first stride of the image.
+//  The file must be closed by the caller using fclose().
+//
+// Parameters:
+//	FILE** BMPfilePtr				returned open file
+//	WCHAR* InputFilename			BMP file to open
+//	BITMAPINFOHEADER* BMPinfoheader	returned BMP info header, biHeight is always positive
+//	int* TopDown					1, first stride is the last image line
+//
+//****************************************************************
+int OpenBMPfile(FILE** BMPfilePtr, WCHAR* InputFilename, BITMAPINFOHEADER* BMPinfoheader, int* TopDown)
 {
     // open BMP file
     FILE* BMPfile;
     errno_t ErrNum;
     int iRes;
 
+    *BMPfilePtr = NULL;
     ErrNum = _wfopen_s(&BMPfile, InputFilename, L"rb");
     if (!BMPfile) {
         return APPERR_FILEOPEN;
@@ -1569,10 +2348,6 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
 
     // read BMP headers
     BITMAPFILEHEADER BMPheader;
-    BITMAPINFOHEADER BMPinfoheader;
-    int StrideLen;
-    int* Image;
-    BYTE* Stride;
 
     iRes = (int)fread(&BMPheader, sizeof(BITMAPFILEHEADER), 1, BMPfile);
     if (iRes != 1) {
@@ -1580,7 +2355,7 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
         return APPERR_FILETYPE;
     }
 
-    iRes = (int)fread(&BMPinfoheader, sizeof(BITMAPINFOHEADER), 1, BMPfile);
+    iRes = (int)fread(BMPinfoheader, sizeof(BITMAPINFOHEADER), 1, BMPfile);
     if (iRes != 1) {
         fclose(BMPfile);
         return APPERR_FILETYPE;
@@ -1592,31 +2367,76 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
         fclose(BMPfile);
         return APPERR_FILETYPE;
     }
-    if (BMPinfoheader.biSize != sizeof(BITMAPINFOHEADER)) {
+    if (BMPinfoheader->biSize != sizeof(BITMAPINFOHEADER)) {
         // this is not a BMP file
         fclose(BMPfile);
         return APPERR_FILETYPE;
     }
 
-    if (BMPinfoheader.biCompression != BI_RGB) {
+    if (BMPinfoheader->biCompression != BI_RGB) {
         // this is wrong type of BMP file
         fclose(BMPfile);
         return APPERR_PARAMETER;
     }
-    if (BMPinfoheader.biBitCount != 1 && BMPinfoheader.biBitCount != 8 &&
-        BMPinfoheader.biBitCount != 24 && BMPinfoheader.biPlanes != 1) {
+    if ((BMPinfoheader->biBitCount != 1 && BMPinfoheader->biBitCount != 8 &&
+        BMPinfoheader->biBitCount != 24) || BMPinfoheader->biPlanes != 1) {
         // this is wrong type of BMP file
         fclose(BMPfile);
         return APPERR_PARAMETER;
     }
 
+    *TopDown = 1;
+    if (BMPinfoheader->biHeight < 0) {
+        *TopDown = 0;
+        BMPinfoheader->biHeight = -BMPinfoheader->biHeight;
+    }
+
+    // skip the color table
+    long ColorTable;
+    if (BMPinfoheader->biBitCount == 1) {
+        // This is bit image, has color table, 2 entries
+        ColorTable = sizeof(RGBQUAD) * 2;
+    }
+    else if (BMPinfoheader->biBitCount == 8) {
+        // this is a byte image, has color table, 256 entries
+        ColorTable = sizeof(RGBQUAD) * 256;
+    }
+    else {
+        // this is a 24 bit, RGB image
+        // The color table is biClrUsed long
+        ColorTable = sizeof(RGBQUAD) * BMPinfoheader->biClrUsed;
+    }
+    if (ColorTable != 0 && fseek(BMPfile, ColorTable, SEEK_CUR) != 0) {
+        fclose(BMPfile);
+        return APPERR_FILETYPE;
+    }
+
+    *BMPfilePtr = BMPfile;
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  LoadBMPfile
+// 
+//****************************************************************
+int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
+{
+    FILE* BMPfile;
+    BITMAPINFOHEADER BMPinfoheader;
+    int StrideLen;
+    int* Image;
+    BYTE* Stride;
+    int TopDown;
+    int iRes;
+
+    iRes = OpenBMPfile(&BMPfile, InputFilename, &BMPinfoheader, &TopDown);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
     // read in image
     int BMPimageBytes;
-    int TopDown = 1;
-    if (BMPinfoheader.biHeight < 0) {
-        TopDown = 0;
-        BMPinfoheader.biHeight = -BMPinfoheader.biHeight;
-    }
 
     // BMP files have a specific requirement for # of bytes per line
     // This is called stride.  The formula used is from the specification.
@@ -1633,13 +2453,7 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
     int NumFrames = 1;
 
     if (BMPinfoheader.biBitCount == 1) {
-        // This is bit image, has color table, 2 entries
-        // Skip the 2 RGBQUAD entries
-        if (fseek(BMPfile, sizeof(RGBQUAD) * 2, SEEK_CUR) != 0) {
-            delete[] Stride;
-            fclose(BMPfile);
-            return APPERR_FILETYPE;
-        }
+        // This is bit image
         int BitCount;
         int StrideIndex;
         int Offset;
@@ -1689,13 +2503,7 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
         }
     }
     else if (BMPinfoheader.biBitCount == 8) {
-        // this is a byte image, has color table, 256 entries
-        // Skip the 256 RGBQUAD entries
-        if (fseek(BMPfile, sizeof(RGBQUAD) * 256, SEEK_CUR) != 0) {
-            delete[] Stride;
-            fclose(BMPfile);
-            return APPERR_FILETYPE;
-        }
+        // this is a byte image
 
         // allocate Image
         // alocate array of 'int's to receive image
@@ -1732,15 +2540,6 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
     }
     else {
         // this is a 24 bit, RGB image
-        // The color table is biClrUsed long
-        if (BMPinfoheader.biClrUsed != 0) {
-            // skip the color table if present
-            if (fseek(BMPfile, sizeof(RGBQUAD) * BMPinfoheader.biClrUsed, SEEK_CUR) != 0) {
-                delete[] Stride;
-                fclose(BMPfile);
-                return APPERR_FILETYPE;
-            }
-        }
 
         Image = new int[(size_t)BMPinfoheader.biWidth * (size_t)BMPinfoheader.biHeight];
         if (Image == NULL) {
@@ -1772,7 +2571,7 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
             }
 
             for (int x = 0; x < BMPinfoheader.biWidth; x++) {
-                Image[Offset + x] = ((int)Stride[x * 3 + 0]) | ((int)Stride[x * 3 + 1]<<8) || ((int)Stride[x * 3 + 2]<<16);
+                Image[Offset + x] = ((int)Stride[x * 3 + 0]) | ((int)Stride[x * 3 + 1]<<8) | ((int)Stride[x * 3 + 2]<<16);
             }
         }
     }
@@ -1786,7 +2585,8 @@ int  LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
     ImgHeader->ID = (short)0xaaaa;
     ImgHeader->Version = (short)1;
     ImgHeader->NumFrames = (short)1;
-    ImgHeader->PixelSize = (short)1;
+    // 24 bit RGB pixels need an 'int', 1 and 8 bit pixels fit in a byte
+    ImgHeader->PixelSize = (short)(BMPinfoheader.biBitCount == 24 ? 4 : 1);
     ImgHeader->Xsize = BMPinfoheader.biWidth;
     ImgHeader->Ysize = BMPinfoheader.biHeight;
     ImgHeader->Padding[0] = 0;
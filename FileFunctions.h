@@ -1,4 +1,16 @@
 #pragma once
+
+// bytes of BMP strides converted and written at a time by SaveImageBMP()
+#define BMP_CHUNK_BYTES (4*1024*1024)
+
+// pixels formatted by each task in SaveTXT()
+#define TXT_BAND_PIXELS (64*1024)
+
+// Called by SaveImageBMP() to create rows of the image as they are written
+// y is the first row, Rows is NumRows x the image width
+// return APP_SUCCESS or a standard application error number
+typedef int (*GETBMPROWS)(void* Context, int y, int NumRows, COLORREF* Rows);
+
 // 
 // function prototypes
 //
@@ -8,11 +20,18 @@ BOOL CCFileOpen(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
 BOOL bSelectFolder, int NumTypes, COMDLG_FILTERSPEC* FileTypes, LPCWSTR szDefExt);
 int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader);
 int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header);
+void ConvertImagePixels(int* Image, const BYTE* Buffer, size_t NumPixels, int PixelSize, int Endian);
+void SwapImagePixels(BYTE* Image, const BYTE* Buffer, size_t NumPixels, int PixelSize, int Endian);
+int OpenBMPfile(FILE** BMPfilePtr, WCHAR* InputFilename, BITMAPINFOHEADER* BMPinfoheader, int* TopDown);
 int LoadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader);
 int SaveBMP(WCHAR* Filename, WCHAR* InputFile, int RGBframes, int AutoScale);
 int SaveTXT(WCHAR* Filename, WCHAR* InputFile);
+int DecodeHexFile(WCHAR* InputFilename, WCHAR* OutputFilename, LONGLONG* ErrorOffset);
 int HEX2Binary(HWND hWnd);
 int CamIRaImport(HWND hWnd);
 int GetFileSize(WCHAR* szString);
-int SaveBMP2PNG(WCHAR* Filename);
 int SaveImageBMP(WCHAR* Filename, COLORREF* Image, int ImageXextent, int ImageYextent);
+int SaveImageBMP(WCHAR* Filename, GETBMPROWS GetRows, void* Context, int ImageXextent, int ImageYextent);
+int SaveImagePNG(WCHAR* Filename, COLORREF* Image, int ImageXextent, int ImageYextent);
+int SaveImagePNG(WCHAR* Filename, GETBMPROWS GetRows, void* Context, int ImageXextent, int ImageYextent);
+int GetPNGfilename(WCHAR* Filename, WCHAR* PNGfilename);
@@ -0,0 +1,775 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageBuffer.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the ImageBuffer class methods/functions
+// This class holds the pixels of an image file used as a layer.
+//
+// Image files (.raw) are opened as a read only memory mapped file.
+// Pixels keep the pixel size of the file (PIXEL_UINT8, PIXEL_UINT16, PIXEL_INT32).
+// If the file is small it is copied into memory and the file is closed.
+// If the file is large (MAP_IMAGE_THRESHOLD) the mapping is kept:
+//		PC format frames (and all 1 byte frames) are used directly from the
+//		mapped view, no copy.
+//		MAC format frames are byte swapped one frame at a time, only when the frame
+//		is first requested.
+// While the mapping is kept the file can not be overwritten by another program.
+//
+// BMP files are loaded as:
+//		1 bit BMP		PIXEL_BIT, 64 pixels per UINT64
+//		8 bit BMP		PIXEL_UINT8
+//		24 bit BMP		PIXEL_INT32, 0x00RRGGBB
+//
+// Images are shared between layers by the image cache, so frames and bitplanes
+// made on request can be asked for by more than one thread at once.
+// ImageLock is held exclusive while one is made, the others wait and use it.
+//
+// V1.2.0	2026-10-17	Initial release
+// V1.2.1	2026-10-17	Pixels are stored as uint8, uint16, int32 or bit packed
+// V1.2.2	2026-10-17	Added bitplanes (pixel != 0) of the frames for compositing
+// V1.2.8	2026-10-17	Added GetMemorySize for the image cache
+// V1.2.17	2026-10-17	Added GetPixel for pixel queries
+// V1.2.24	2026-10-17	BMP files set PixelSize 4 for 24 bit pixels instead of always 1
+//						Frames and bitplanes made on request are guarded by ImageLock,
+//						two threads could make the same one and leak one of them
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <string.h>
+#include <stdio.h>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "ImageBuffer.h"
+
+//*******************************************************************************
+//
+//  ImageBuffer()
+//	Class constructor
+//
+//*******************************************************************************
+ImageBuffer::ImageBuffer() {
+	// constructor
+};
+
+//*******************************************************************************
+//
+//  ~ImageBuffer()
+//	Class destuctor
+//
+//*******************************************************************************
+ImageBuffer::~ImageBuffer() {
+	// destuctor
+	Release();
+};
+
+//*******************************************************************************
+//
+//  void Release(void)
+//
+// Release the copied frames and unmap the image file
+//
+//*******************************************************************************
+void ImageBuffer::Release(void) {
+	if (Frames != NULL) {
+		for (int i = 0; i < NumFrames; i++) {
+			if (Frames[i] != NULL) {
+				delete[] Frames[i];
+			}
+		}
+		delete[] Frames;
+		Frames = NULL;
+	}
+
+	if (Bitplanes != NULL) {
+		for (int i = 0; i < NumFrames; i++) {
+			if (Bitplanes[i] != NULL) {
+				delete[] Bitplanes[i];
+			}
+		}
+		delete[] Bitplanes;
+		Bitplanes = NULL;
+	}
+
+	if (MapView != NULL) {
+		UnmapViewOfFile(MapView);
+		MapView = NULL;
+	}
+	MapPixels = NULL;
+	InPlace = FALSE;
+	NumFrames = 0;
+	Pitch = 0;
+	FrameBytes = 0;
+	PixelType = PIXEL_INT32;
+	memset(&Header, 0, sizeof(IMAGINGHEADER));
+};
+
+//*******************************************************************************
+//
+//  int Load(WCHAR* Filename)
+//
+// Load an image (.raw) or BMP file
+//
+// WCHAR* Filename		Image, or BMP file
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int ImageBuffer::Load(WCHAR* Filename) {
+	int iRes;
+
+	Release();
+
+	// try as an image file
+	iRes = MapImageFile(Filename);
+	if (iRes == APP_SUCCESS) {
+		return APP_SUCCESS;
+	}
+	Release();
+
+	// try as a BMP file
+	iRes = LoadBMP(Filename);
+	if (iRes != APP_SUCCESS) {
+		Release();
+		return iRes;
+	}
+
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  int AllocateFrames(int Count)
+//
+// Allocate the (empty) list of copied frames
+//
+//*******************************************************************************
+int ImageBuffer::AllocateFrames(int Count) {
+	Frames = new UINT64* [Count];
+	if (Frames == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	Bitplanes = new UINT64* [Count];
+	if (Bitplanes == NULL) {
+		delete[] Frames;
+		Frames = NULL;
+		return APPERR_MEMALLOC;
+	}
+	for (int i = 0; i < Count; i++) {
+		Frames[i] = NULL;
+		Bitplanes[i] = NULL;
+	}
+	NumFrames = Count;
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  int MapImageFile(WCHAR* Filename)
+//
+// Map an image file (.raw) into memory
+//
+// WCHAR* Filename		Image file
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int ImageBuffer::MapImageFile(WCHAR* Filename) {
+	HANDLE hFile;
+	HANDLE hMapping;
+	LARGE_INTEGER FileSize;
+	int iRes;
+
+	hFile = CreateFile(Filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (!GetFileSizeEx(hFile, &FileSize) || FileSize.QuadPart < (LONGLONG)sizeof(IMAGINGHEADER)) {
+		CloseHandle(hFile);
+		return APPERR_FILEREAD;
+	}
+
+	hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL) {
+		CloseHandle(hFile);
+		return APPERR_FILEOPEN;
+	}
+
+	// the view keeps the file open, the handles are not needed anymore
+	MapView = (BYTE*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	CloseHandle(hFile);
+	if (MapView == NULL) {
+		// The file may be too large for the address space (Win32)
+		return APPERR_MEMALLOC;
+	}
+
+	memcpy(&Header, MapView, sizeof(IMAGINGHEADER));
+
+	// same checks as LoadImageFile()
+	if (Header.Endian != 0 && Header.Endian != -1 && Header.ID != 0xaaaa) {
+		return APPERR_FILETYPE;
+	}
+
+	if (Header.Xsize <= 0 || Header.Ysize <= 0 || Header.NumFrames <= 0) {
+		return APPERR_FILETYPE;
+	}
+
+	if (Header.PixelSize != 1 && Header.PixelSize != 2 && Header.PixelSize != 4) {
+		return APPERR_FILETYPE;
+	}
+
+	LONGLONG ImageSize = (LONGLONG)Header.Xsize * (LONGLONG)Header.Ysize *
+		(LONGLONG)Header.NumFrames * (LONGLONG)Header.PixelSize;
+	if (FileSize.QuadPart < (LONGLONG)sizeof(IMAGINGHEADER) + ImageSize) {
+		// truncated file
+		return APPERR_FILEREAD;
+	}
+
+	PixelType = (PIXELTYPE)Header.PixelSize;
+	Pitch = (size_t)Header.Xsize;
+	FrameBytes = (size_t)Header.Xsize * (size_t)Header.Ysize * (size_t)Header.PixelSize;
+	MapPixels = MapView + sizeof(IMAGINGHEADER);
+
+	iRes = AllocateFrames((int)Header.NumFrames);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	if (ImageSize >= MAP_IMAGE_THRESHOLD) {
+		// large file, keep the mapping
+		if (Header.PixelSize == 1 || Header.Endian) {
+			// PC format pixels are used as is
+			InPlace = TRUE;
+		}
+		return APP_SUCCESS;
+	}
+
+	// small file, copy all the frames and release the mapping
+	for (int i = 0; i < NumFrames; i++) {
+		iRes = CopyFrame(i);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+	}
+	UnmapViewOfFile(MapView);
+	MapView = NULL;
+	MapPixels = NULL;
+
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  int CopyFrame(int Frame)
+//
+// Copy one frame from the mapped view, MAC format pixels are byte swapped
+// Called with ImageLock held exclusive, or while loading before the image is shared.
+//
+// int Frame			frame number, 0 to NumFrames-1
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int ImageBuffer::CopyFrame(int Frame) {
+	size_t FramePixels = (size_t)Header.Xsize * (size_t)Header.Ysize;
+	UINT64* Image;
+
+	Image = new UINT64[(FrameBytes + 7) / 8];
+	if (Image == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	SwapImagePixels((BYTE*)Image, MapPixels + (size_t)Frame * FrameBytes,
+		FramePixels, (int)Header.PixelSize, (int)Header.Endian);
+
+	Frames[Frame] = Image;
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  int LoadBMP(WCHAR* Filename)
+//
+// Load a 1, 8 or 24 bit BMP file
+//
+// WCHAR* Filename		BMP file
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int ImageBuffer::LoadBMP(WCHAR* Filename) {
+	FILE* BMPfile;
+	BITMAPINFOHEADER BMPinfoheader;
+	int TopDown;
+	int StrideLen;
+	BYTE* Stride;
+	UINT64* Image;
+	int iRes;
+
+	iRes = OpenBMPfile(&BMPfile, Filename, &BMPinfoheader, &TopDown);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	int Xsize = BMPinfoheader.biWidth;
+	int Ysize = BMPinfoheader.biHeight;
+
+	if (BMPinfoheader.biBitCount == 1) {
+		PixelType = PIXEL_BIT;
+		Pitch = ((size_t)Xsize + 63) / 64;
+		FrameBytes = Pitch * sizeof(UINT64) * (size_t)Ysize;
+	}
+	else if (BMPinfoheader.biBitCount == 8) {
+		PixelType = PIXEL_UINT8;
+		Pitch = (size_t)Xsize;
+		FrameBytes = (size_t)Xsize * (size_t)Ysize;
+	}
+	else {
+		PixelType = PIXEL_INT32;
+		Pitch = (size_t)Xsize;
+		FrameBytes = (size_t)Xsize * (size_t)Ysize * sizeof(int);
+	}
+
+	// BMP files have a specific requirement for # of bytes per line
+	// This is called stride.  The formula used is from the specification.
+	StrideLen = ((((Xsize * BMPinfoheader.biBitCount) + 31) & ~31) >> 3);
+
+	Stride = new BYTE[(size_t)StrideLen];
+	if (Stride == NULL) {
+		fclose(BMPfile);
+		return APPERR_MEMALLOC;
+	}
+
+	iRes = AllocateFrames(1);
+	if (iRes != APP_SUCCESS) {
+		delete[] Stride;
+		fclose(BMPfile);
+		return iRes;
+	}
+
+	Image = new UINT64[(FrameBytes + 7) / 8];
+	if (Image == NULL) {
+		delete[] Stride;
+		fclose(BMPfile);
+		return APPERR_MEMALLOC;
+	}
+	Frames[0] = Image;
+
+	for (int y = 0; y < Ysize; y++) {
+		// read stride
+		iRes = (int)fread(Stride, 1, StrideLen, BMPfile);
+		if (iRes != StrideLen) {
+			delete[] Stride;
+			fclose(BMPfile);
+			return APPERR_FILETYPE;
+		}
+
+		size_t Row;
+		if (TopDown) {
+			Row = (size_t)((Ysize - 1) - y);
+		}
+		else {
+			Row = (size_t)y;
+		}
+
+		if (PixelType == PIXEL_BIT) {
+			// BMP pixels are msb first, bit packed rows are lsb first
+			UINT64* Words = Image + Row * Pitch;
+			for (size_t w = 0; w < Pitch; w++) {
+				UINT64 Word = 0;
+				for (int b = 0; b < 8; b++) {
+					size_t Index = w * 8 + (size_t)b;
+					if (Index >= (size_t)StrideLen) {
+						break;
+					}
+					BYTE Bits = Stride[Index];
+					Bits = (BYTE)(((Bits & 0xf0) >> 4) | ((Bits & 0x0f) << 4));
+					Bits = (BYTE)(((Bits & 0xcc) >> 2) | ((Bits & 0x33) << 2));
+					Bits = (BYTE)(((Bits & 0xaa) >> 1) | ((Bits & 0x55) << 1));
+					Word |= (UINT64)Bits << (b * 8);
+				}
+				Words[w] = Word;
+			}
+			// clear the stride padding bits past the end of the row
+			if (Xsize & 63) {
+				Words[Pitch - 1] &= ((UINT64)1 << (Xsize & 63)) - 1;
+			}
+		}
+		else if (PixelType == PIXEL_UINT8) {
+			memcpy((BYTE*)Image + Row * Pitch, Stride, (size_t)Xsize);
+		}
+		else {
+			int* Pixels = (int*)Image + Row * Pitch;
+			for (int x = 0; x < Xsize; x++) {
+				Pixels[x] = ((int)Stride[x * 3 + 0]) | ((int)Stride[x * 3 + 1] << 8) | ((int)Stride[x * 3 + 2] << 16);
+			}
+		}
+	}
+
+	delete[] Stride;
+	fclose(BMPfile);
+
+	// save image
+	Header.Endian = (short)-1;  // PC format
+	Header.HeaderSize = (short)sizeof(IMAGINGHEADER);
+	Header.ID = (short)0xaaaa;
+	Header.Version = (short)1;
+	Header.NumFrames = (short)1;
+	// PIXEL_BIT pixels are 0 or 1, stored as a byte in an image file
+	Header.PixelSize = (short)(PixelType == PIXEL_INT32 ? 4 : 1);
+	Header.Xsize = Xsize;
+	Header.Ysize = Ysize;
+
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  const void* GetFrame(int Frame)
+//
+// Get the pixels of a frame
+// A frame from a large MAC format file is byte swapped the first time it is requested.
+// Use GetPixelType() to determine the type of the pixels.
+// Rows are GetPitch() pixels (PIXEL_BIT: UINT64 words) apart.
+//
+// int Frame			frame number, 0 to NumFrames-1
+//
+// return
+// const void*			pointer to the pixels, NULL if not available
+//
+//*******************************************************************************
+const void* ImageBuffer::GetFrame(int Frame) {
+	if (Frame < 0 || Frame >= NumFrames) {
+		return NULL;
+	}
+
+	if (InPlace) {
+		return MapPixels + (size_t)Frame * FrameBytes;
+	}
+
+	UINT64* Image = GetCopiedFrame(Frame);
+	if (Image == NULL && MapPixels != NULL) {
+		AcquireSRWLockExclusive(&ImageLock);
+		// another thread may have copied it while this one waited
+		if (Frames[Frame] == NULL) {
+			CopyFrame(Frame);
+		}
+		Image = Frames[Frame];
+		ReleaseSRWLockExclusive(&ImageLock);
+	}
+	return Image;
+};
+
+//*******************************************************************************
+//
+//  UINT64* GetCopiedFrame(int Frame)
+//
+// int Frame			frame number, 0 to NumFrames-1
+//
+// return
+// UINT64*				the copied frame, NULL if it has not been copied
+//
+//*******************************************************************************
+UINT64* ImageBuffer::GetCopiedFrame(int Frame) {
+	UINT64* Image;
+
+	AcquireSRWLockShared(&ImageLock);
+	Image = Frames[Frame];
+	ReleaseSRWLockShared(&ImageLock);
+	return Image;
+};
+
+//*******************************************************************************
+//
+//  int GetPixel(int Frame, int x, int y, int* Value)
+//
+// Get the value of one pixel.  A frame that has not been copied is read
+// from the mapped view, so this does not copy or byte swap the frame.
+//
+// int Frame			frame number, 0 to NumFrames-1
+// int x, y				pixel in the frame
+// int* Value			returns the pixel value, PIXEL_BIT: 0 or 1
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int ImageBuffer::GetPixel(int Frame, int x, int y, int* Value) {
+	const BYTE* Pixels;
+	BYTE Pixel[4];
+
+	*Value = 0;
+	if (Frame < 0 || Frame >= NumFrames || x < 0 || x >= (int)Header.Xsize || y < 0 || y >= (int)Header.Ysize) {
+		return APPERR_PARAMETER;
+	}
+
+	if (!InPlace && GetCopiedFrame(Frame) == NULL) {
+		if (MapPixels == NULL) {
+			return APPERR_PARAMETER;
+		}
+		// MAC format frame that has not been swapped yet
+		size_t Offset = ((size_t)y * Pitch + (size_t)x) * (size_t)Header.PixelSize;
+		SwapImagePixels(Pixel, MapPixels + (size_t)Frame * FrameBytes + Offset, 1,
+			(int)Header.PixelSize, (int)Header.Endian);
+		Pixels = Pixel;
+		x = 0;
+		y = 0;
+	}
+	else {
+		Pixels = (const BYTE*)GetFrame(Frame);
+		if (Pixels == NULL) {
+			return APPERR_PARAMETER;
+		}
+	}
+
+	size_t Index = (size_t)y * Pitch + (size_t)x;
+	switch (PixelType) {
+	case PIXEL_BIT:
+		*Value = (int)((((const UINT64*)Pixels)[(size_t)y * Pitch + (x >> 6)] >> (x & 63)) & 1);
+		break;
+	case PIXEL_UINT8:
+		*Value = (int)Pixels[Index];
+		break;
+	case PIXEL_UINT16:
+		*Value = (int)((const USHORT*)Pixels)[Index];
+		break;
+	default:
+		*Value = ((const int*)Pixels)[Index];
+		break;
+	}
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  PackRow
+//
+// Pack a row of pixels into bits, bit set when pixel != 0
+// pixel x is bit (x & 63) of word (x >> 6), unused bits are 0
+//
+//*******************************************************************************
+template <typename T>
+static void PackRow(UINT64* Words, const T* Pixels, int Xsize) {
+	int x = 0;
+
+	for (size_t w = 0; x < Xsize; w++) {
+		UINT64 Word = 0;
+		int Count = Xsize - x;
+		if (Count > 64) {
+			Count = 64;
+		}
+		for (int b = 0; b < Count; b++) {
+			Word |= (UINT64)(Pixels[x + b] != 0) << b;
+		}
+		Words[w] = Word;
+		x += Count;
+	}
+}
+
+//*******************************************************************************
+//
+//  const UINT64* GetBitplane(int Frame)
+//
+// Get the bitplane of a frame, bit set when pixel != 0
+// Rows are GetBitplanePitch() UINT64 words apart.
+// The bitplane is made the first time it is requested, by one thread only.
+//
+// int Frame			frame number, 0 to NumFrames-1
+//
+// return
+// const UINT64*		pointer to the bitplane, NULL if not available
+//
+//*******************************************************************************
+const UINT64* ImageBuffer::GetBitplane(int Frame) {
+	const void* Pixels;
+
+	if (PixelType == PIXEL_BIT) {
+		return (const UINT64*)GetFrame(Frame);
+	}
+
+	if (Frame < 0 || Frame >= NumFrames) {
+		return NULL;
+	}
+
+	UINT64* Bits;
+
+	AcquireSRWLockShared(&ImageLock);
+	Bits = Bitplanes[Frame];
+	ReleaseSRWLockShared(&ImageLock);
+	if (Bits != NULL) {
+		return Bits;
+	}
+
+	// GetFrame() takes ImageLock, get the pixels before holding it
+	Pixels = GetFrame(Frame);
+	if (Pixels == NULL) {
+		return NULL;
+	}
+
+	AcquireSRWLockExclusive(&ImageLock);
+	if (Bitplanes[Frame] != NULL) {
+		// made by another thread while this one waited
+		Bits = Bitplanes[Frame];
+		ReleaseSRWLockExclusive(&ImageLock);
+		return Bits;
+	}
+
+	size_t BitPitch = GetBitplanePitch();
+	int Xsize = (int)Header.Xsize;
+	int Ysize = (int)Header.Ysize;
+
+	Bits = new UINT64[BitPitch * (size_t)Ysize];
+	if (Bits == NULL) {
+		ReleaseSRWLockExclusive(&ImageLock);
+		return NULL;
+	}
+
+	for (int y = 0; y < Ysize; y++) {
+		UINT64* Row = Bits + (size_t)y * BitPitch;
+		switch (PixelType) {
+		case PIXEL_UINT8:
+			PackRow<BYTE>(Row, (const BYTE*)Pixels + (size_t)y * Pitch, Xsize);
+			break;
+
+		case PIXEL_UINT16:
+			PackRow<USHORT>(Row, (const USHORT*)Pixels + (size_t)y * Pitch, Xsize);
+			break;
+
+		default:
+			PackRow<int>(Row, (const int*)Pixels + (size_t)y * Pitch, Xsize);
+			break;
+		}
+	}
+
+	Bitplanes[Frame] = Bits;
+	ReleaseSRWLockExclusive(&ImageLock);
+	return Bits;
+};
+
+//*******************************************************************************
+//
+//  size_t GetBitplanePitch(void)
+//
+// return
+// size_t				# of UINT64 words per bitplane row
+//
+//*******************************************************************************
+size_t ImageBuffer::GetBitplanePitch(void) {
+	return ((size_t)Header.Xsize + 63) / 64;
+};
+
+//*******************************************************************************
+//
+//  PIXELTYPE GetPixelType(void)
+//
+//*******************************************************************************
+PIXELTYPE ImageBuffer::GetPixelType(void) {
+	return PixelType;
+};
+
+//*******************************************************************************
+//
+//  size_t GetPitch(void)
+//
+// return
+// size_t				# of pixels per row (PIXEL_BIT: # of UINT64 words per row)
+//
+//*******************************************************************************
+size_t ImageBuffer::GetPitch(void) {
+	return Pitch;
+};
+
+//*******************************************************************************
+//
+//  int GetXsize(void)
+//
+//*******************************************************************************
+int ImageBuffer::GetXsize(void) {
+	return (int)Header.Xsize;
+};
+
+//*******************************************************************************
+//
+//  int GetYsize(void)
+//
+//*******************************************************************************
+int ImageBuffer::GetYsize(void) {
+	return (int)Header.Ysize;
+};
+
+//*******************************************************************************
+//
+//  int GetNumFrames(void)
+//
+//*******************************************************************************
+int ImageBuffer::GetNumFrames(void) {
+	return NumFrames;
+};
+
+//*******************************************************************************
+//
+//  BOOL IsMapped(void)
+//
+// return
+// BOOL					TRUE, image file is still memory mapped
+//
+//*******************************************************************************
+BOOL ImageBuffer::IsMapped(void) {
+	return MapView != NULL;
+};
+
+//*******************************************************************************
+//
+//  size_t GetMemorySize(void)
+//
+// return
+// size_t				bytes of memory used by the copied frames and bitplanes
+//						the mapped view of the file is not included
+//
+// Other threads can be making frames or bitplanes, this is the size at the time.
+//
+//*******************************************************************************
+size_t ImageBuffer::GetMemorySize(void) {
+	size_t Bytes = 0;
+	size_t BitplaneBytes = GetBitplanePitch() * sizeof(UINT64) * (size_t)Header.Ysize;
+
+	AcquireSRWLockShared(&ImageLock);
+	for (int i = 0; i < NumFrames; i++) {
+		if (Frames != NULL && Frames[i] != NULL) {
+			Bytes += ((FrameBytes + 7) / 8) * sizeof(UINT64);
+		}
+		if (Bitplanes != NULL && Bitplanes[i] != NULL) {
+			Bytes += BitplaneBytes;
+		}
+	}
+	ReleaseSRWLockShared(&ImageLock);
+	return Bytes;
+};
@@ -0,0 +1,105 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageBuffer.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations of the ImageBuffer class
+// This class holds the pixels of an image file used as a layer.
+// Large image files are memory mapped instead of being read into memory.
+// Pixels are kept at the width of the file, they are not widened to 'int'.
+//
+// V1.2.0	2026-10-17	Initial release
+// V1.2.1	2026-10-17	Pixels are stored as uint8, uint16, int32 or bit packed
+// V1.2.2	2026-10-17	Added bitplanes (pixel != 0) of the frames for compositing
+// V1.2.8	2026-10-17	Added GetMemorySize for the image cache
+// V1.2.17	2026-10-17	Added GetPixel for pixel queries
+// V1.2.24	2026-10-17	Frames and bitplanes made on request are guarded by ImageLock
+//
+#include "framework.h"
+#include "imageheader.h"
+
+// image files this size or larger are kept memory mapped
+// smaller files are converted into memory and the file is closed
+#define MAP_IMAGE_THRESHOLD (64*1024*1024)
+
+// pixel storage types
+// PIXEL_BIT frames are rows of UINT64 words, pixel x of a row is
+// bit (x & 63) of word (x >> 6), unused bits at the end of a row are 0
+typedef enum {
+	PIXEL_UINT8 = 1,
+	PIXEL_UINT16 = 2,
+	PIXEL_INT32 = 4,
+	PIXEL_BIT = 0
+} PIXELTYPE;
+
+class ImageBuffer {
+private:
+	IMAGINGHEADER Header = { 0 };
+	PIXELTYPE PixelType = PIXEL_INT32;
+	size_t Pitch = 0;			// # of pixels (PIXEL_BIT: UINT64 words) per row
+	size_t FrameBytes = 0;		// size of a frame in bytes
+
+	// memory mapped image file
+	// This is kept open only for large image files.
+	BYTE* MapView = NULL;
+	BYTE* MapPixels = NULL;		// first pixel in the mapped view
+	BOOL InPlace = FALSE;		// TRUE, frames are used directly from the mapped view
+
+	// copied frames, allocated as they are requested
+	// not used when InPlace is TRUE
+	// frames are allocated as UINT64 so bit packed rows are aligned
+	UINT64** Frames = NULL;
+	int NumFrames = 0;
+
+	// bitplanes of the frames, pixel != 0, made as they are requested
+	// same layout as PIXEL_BIT frames, not used for PIXEL_BIT
+	UINT64** Bitplanes = NULL;
+
+	// A cached image is shared by layers on different threads.
+	// Frames[] and Bitplanes[] entries are read with this held shared
+	// and made with it held exclusive.
+	SRWLOCK ImageLock = SRWLOCK_INIT;
+
+	int AllocateFrames(int Count);
+	int MapImageFile(WCHAR* Filename);
+	int LoadBMP(WCHAR* Filename);
+	int CopyFrame(int Frame);
+	UINT64* GetCopiedFrame(int Frame);
+
+public:
+	ImageBuffer();
+	~ImageBuffer();
+
+	int Load(WCHAR* Filename);
+	void Release(void);
+
+	const void* GetFrame(int Frame);
+	template <typename T> const T* GetPixels(int Frame) {
+		return (const T*)GetFrame(Frame);
+	}
+	const UINT64* GetBitplane(int Frame);
+	size_t GetBitplanePitch(void);
+	int GetPixel(int Frame, int x, int y, int* Value);
+
+	PIXELTYPE GetPixelType(void);
+	size_t GetPitch(void);
+	int GetXsize(void);
+	int GetYsize(void);
+	int GetNumFrames(void);
+	BOOL IsMapped(void);
+	size_t GetMemorySize(void);
+};
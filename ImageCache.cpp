@@ -0,0 +1,286 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageCache.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the functions of the shared layer image cache
+//
+// Loaded images (ImageBuffer) are kept in a process wide cache.
+// A cached image is found using the full path of the file plus the file size
+// and last write time, so a file that has changed is loaded again.
+// Each image has a reference count, one for each layer using it.
+//
+// When an image is no longer used by any layer:
+//		Images copied into memory are kept so that reloading a configuration
+//		doesn't load the file again.  The least recently used of these are
+//		released when the cache is over IMAGE_CACHE_LIMIT.
+//		Images that are still memory mapped are released right away so the
+//		file is not kept open after the layer is gone.
+//
+// The cache can be used from more than one thread.  The file is loaded
+// without holding the cache lock.
+//
+// V1.2.8	2026-10-17	Initial release
+// V1.2.24	2026-10-17	When the same file is loaded by two threads at once, the image
+//						loaded first is shared and the other is released
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <vector>
+#include "AppErrors.h"
+#include "ImageBuffer.h"
+#include "ImageCache.h"
+
+typedef struct {
+	WCHAR Path[MAX_PATH];		// full path of the file
+	ULONGLONG FileSize;
+	FILETIME LastWrite;
+	ImageBuffer* Image;
+	int RefCount;				// # of layers using the image
+	ULONGLONG LastUsed;			// for least recently used order
+} IMAGECACHEENTRY;
+
+static std::vector<IMAGECACHEENTRY> CacheEntries;
+static SRWLOCK CacheLock = SRWLOCK_INIT;
+static ULONGLONG CacheUseCount = 0;
+
+//*******************************************************************************
+//
+//  static int FindEntry(ImageBuffer* Image)
+//
+// return
+// int					index of the entry for Image, -1 if not in the cache
+//
+//*******************************************************************************
+static int FindEntry(ImageBuffer* Image) {
+	for (int i = 0; i < (int)CacheEntries.size(); i++) {
+		if (CacheEntries[i].Image == Image) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+//*******************************************************************************
+//
+//  static void RemoveEntry(int Entry)
+//
+// Release the image of an unused entry and remove it from the cache
+//
+//*******************************************************************************
+static void RemoveEntry(int Entry) {
+	delete CacheEntries[Entry].Image;
+	CacheEntries.erase(CacheEntries.begin() + Entry);
+}
+
+//*******************************************************************************
+//
+//  static void TrimCache(void)
+//
+// Release the least recently used unused images until the cache
+// is under IMAGE_CACHE_LIMIT
+//
+//*******************************************************************************
+static void TrimCache(void) {
+	size_t Total = 0;
+
+	for (int i = 0; i < (int)CacheEntries.size(); i++) {
+		Total += CacheEntries[i].Image->GetMemorySize();
+	}
+
+	while (Total > IMAGE_CACHE_LIMIT) {
+		int Oldest = -1;
+		for (int i = 0; i < (int)CacheEntries.size(); i++) {
+			if (CacheEntries[i].RefCount == 0 &&
+				(Oldest < 0 || CacheEntries[i].LastUsed < CacheEntries[Oldest].LastUsed)) {
+				Oldest = i;
+			}
+		}
+		if (Oldest < 0) {
+			// the rest are all in use
+			break;
+		}
+		Total -= CacheEntries[Oldest].Image->GetMemorySize();
+		RemoveEntry(Oldest);
+	}
+}
+
+//*******************************************************************************
+//
+//  int AcquireImage(WCHAR* Filename, ImageBuffer** Image)
+//
+// Get the image of a file from the cache, the file is loaded if it is not
+// in the cache or it has changed.  The image must be released using
+// ReleaseImage(), not deleted.
+//
+// WCHAR* Filename		Image, or BMP file
+// ImageBuffer** Image	returns the image
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int AcquireImage(WCHAR* Filename, ImageBuffer** Image) {
+	IMAGECACHEENTRY Entry;
+	WIN32_FILE_ATTRIBUTE_DATA FileData;
+	ImageBuffer* NewImage;
+	int iRes;
+
+	*Image = NULL;
+
+	if (GetFullPathName(Filename, MAX_PATH, Entry.Path, NULL) == 0) {
+		return APPERR_FILEOPEN;
+	}
+	if (!GetFileAttributesEx(Entry.Path, GetFileExInfoStandard, &FileData)) {
+		return APPERR_FILEOPEN;
+	}
+	Entry.FileSize = ((ULONGLONG)FileData.nFileSizeHigh << 32) | FileData.nFileSizeLow;
+	Entry.LastWrite = FileData.ftLastWriteTime;
+
+	AcquireSRWLockExclusive(&CacheLock);
+	for (int i = 0; i < (int)CacheEntries.size(); i++) {
+		if (_wcsicmp(CacheEntries[i].Path, Entry.Path) != 0) {
+			continue;
+		}
+		if (CacheEntries[i].FileSize == Entry.FileSize &&
+			CompareFileTime(&CacheEntries[i].LastWrite, &Entry.LastWrite) == 0) {
+			// same file, share the image
+			CacheEntries[i].RefCount++;
+			CacheEntries[i].LastUsed = ++CacheUseCount;
+			*Image = CacheEntries[i].Image;
+			ReleaseSRWLockExclusive(&CacheLock);
+			return APP_SUCCESS;
+		}
+		if (CacheEntries[i].RefCount == 0) {
+			// file has changed, old image is not used
+			RemoveEntry(i);
+			i--;
+		}
+	}
+	ReleaseSRWLockExclusive(&CacheLock);
+
+	// not in the cache, load the file
+	NewImage = new ImageBuffer;
+	if (NewImage == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	iRes = NewImage->Load(Filename);
+	if (iRes != APP_SUCCESS) {
+		delete NewImage;
+		return iRes;
+	}
+
+	Entry.Image = NewImage;
+	Entry.RefCount = 1;
+
+	AcquireSRWLockExclusive(&CacheLock);
+	for (int i = 0; i < (int)CacheEntries.size(); i++) {
+		if (_wcsicmp(CacheEntries[i].Path, Entry.Path) == 0 &&
+			CacheEntries[i].FileSize == Entry.FileSize &&
+			CompareFileTime(&CacheEntries[i].LastWrite, &Entry.LastWrite) == 0) {
+			// loaded by another thread while this one was loading
+			CacheEntries[i].RefCount++;
+			CacheEntries[i].LastUsed = ++CacheUseCount;
+			*Image = CacheEntries[i].Image;
+			ReleaseSRWLockExclusive(&CacheLock);
+			delete NewImage;
+			return APP_SUCCESS;
+		}
+	}
+	Entry.LastUsed = ++CacheUseCount;
+	CacheEntries.push_back(Entry);
+	TrimCache();
+	ReleaseSRWLockExclusive(&CacheLock);
+
+	*Image = NewImage;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  void AddImageRef(ImageBuffer* Image)
+//
+// Add a reference to an image from AcquireImage()
+//
+//*******************************************************************************
+void AddImageRef(ImageBuffer* Image) {
+	int Entry;
+
+	AcquireSRWLockExclusive(&CacheLock);
+	Entry = FindEntry(Image);
+	if (Entry >= 0) {
+		CacheEntries[Entry].RefCount++;
+	}
+	ReleaseSRWLockExclusive(&CacheLock);
+}
+
+//*******************************************************************************
+//
+//  void ReleaseImage(ImageBuffer* Image)
+//
+// Release a reference to an image from AcquireImage()
+// Images not from the cache are deleted.
+//
+//*******************************************************************************
+void ReleaseImage(ImageBuffer* Image) {
+	int Entry;
+
+	if (Image == NULL) {
+		return;
+	}
+
+	AcquireSRWLockExclusive(&CacheLock);
+	Entry = FindEntry(Image);
+	if (Entry < 0) {
+		ReleaseSRWLockExclusive(&CacheLock);
+		delete Image;
+		return;
+	}
+
+	CacheEntries[Entry].RefCount--;
+	if (CacheEntries[Entry].RefCount <= 0) {
+		CacheEntries[Entry].RefCount = 0;
+		CacheEntries[Entry].LastUsed = ++CacheUseCount;
+		if (Image->IsMapped()) {
+			// don't keep the file open
+			RemoveEntry(Entry);
+		}
+		else {
+			TrimCache();
+		}
+	}
+	ReleaseSRWLockExclusive(&CacheLock);
+}
+
+//*******************************************************************************
+//
+//  void FlushImageCache(void)
+//
+// Release all of the cached images that are not used by a layer
+//
+//*******************************************************************************
+void FlushImageCache(void) {
+	AcquireSRWLockExclusive(&CacheLock);
+	for (int i = (int)CacheEntries.size() - 1; i >= 0; i--) {
+		if (CacheEntries[i].RefCount == 0) {
+			RemoveEntry(i);
+		}
+	}
+	ReleaseSRWLockExclusive(&CacheLock);
+}
@@ -0,0 +1,36 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ImageCache.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations for the shared layer image cache
+// Images are shared by all the layers that use the same file.
+//
+// V1.2.8	2026-10-17	Initial release
+//
+#include "framework.h"
+#include "ImageBuffer.h"
+
+// memory limit of the cached images (copied frames and bitplanes)
+// images that are not used by a layer are released to stay under this limit
+#define IMAGE_CACHE_LIMIT ((size_t)1024*1024*1024)
+
+// function prototypes
+int AcquireImage(WCHAR* Filename, ImageBuffer** Image);
+void AddImageRef(ImageBuffer* Image);
+void ReleaseImage(ImageBuffer* Image);
+void FlushImageCache(void);
@@ -25,13 +25,27 @@
 //                      https://learn.microsoft.com/en-us/windows/win32/controls/create-status-bars
 //                      Changed, zoom, pan behavior of bitmap
 //                      Changed window resize of image display
+// V1.2.15  2026-10-17  Added virtual images for displays too large for one bitmap.
+//                      Only the tiles in the window are created and drawn, the
+//                      last IMAGE_TILE_CACHE tiles are kept as bitmaps.
+// V1.2.16  2026-10-17  Zoomed out images are drawn from reduced levels of the image.
+//                      Zoom can go down to IMAGE_MIN_SCALE, steps below 1 are x0.8/x1.25
+// V1.2.17  2026-10-17  Status bar can show a description of the pixel under the mouse
+// V1.2.18  2026-10-17  Render target and bitmap are kept when the image is loaded again,
+//                      only the changed region is copied.  The render target is resized
+//                      with the window instead of being created again.
+// V1.2.24  2026-10-17  Bitmaps are created and copied to through a render backend, see
+//                      D2DBackend.cpp.  The image bitmap is kept in an ImageSurface
+//                      (RenderBackend.cpp), it is only created again when the image size
+//                      changes or the device is lost.
+//                      The number of tiles kept is sized from the window, from
+//                      IMAGE_TILE_CACHE (32) up to IMAGE_TILE_CACHE_MAX tiles
 // 
 // This handles all the actual display of the bitmap generated
 //
 #include "framework.h"
 #include <d2d1.h>
 #include <d2d1_1.h>
-#pragma comment(lib, "d2d1.lib")
 #include <CommCtrl.h>
 #include <math.h>
 #include "AppErrors.h"
@@ -46,11 +60,11 @@ extern HWND hwndImage;
 //*******************************************************************************
 int ImageDialog::InitializeDirect2D(void)
 {
-    HRESULT hResult;
-    hResult = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &pFactory);
-    if (FAILED(hResult)) {
-        return APPERR_MEMALLOC;
+    int iRes = Backend.Initialize();
+    if (iRes != APP_SUCCESS) {
+        return iRes;
     }
+    Surface.SetBackend(&Backend);
     return APP_SUCCESS;
 }
 
@@ -62,21 +76,18 @@ int ImageDialog::InitializeDirect2D(void)
 void ImageDialog::ReleaseDirect2D(void)
 {
     // release resources
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
+    ReleaseTiles();
+    if (TileImage) {
+        delete[] TileImage;
+        TileImage = NULL;
     }
+    GetTile = NULL;
+    VirtualImage = FALSE;
 
-    if (pRenderTarget) {
-        pRenderTarget->Release();
-        pRenderTarget = nullptr;
-    }
-
-    // factory is last
-    if (pFactory) {
-        pFactory->Release();
-        pFactory = nullptr;
-    }
+    // bitmaps before the render target, factory is last
+    Surface.Release();
+    Backend.Release();
+    LoadedImage = NULL;
     return;
 }
 
@@ -87,72 +98,445 @@ void ImageDialog::ReleaseDirect2D(void)
 //*******************************************************************************
 void ImageDialog::ReleaseBitmapRender(void)
 {
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
-    }
-    if (pRenderTarget) {
-        pRenderTarget->Release();
-        pRenderTarget = nullptr;
-    }
+    // tile bitmaps belong to the render target
+    ReleaseTiles();
+    Surface.Release();
+    Backend.ReleaseTarget();
+    LoadedImage = NULL;
     return;
 }
 
 //*******************************************************************************
 //
+//  BOOL CreateRenderTarget(HWND hWnd)
 // 
+//  Create the render target for the window, or resize the existing one.
+//  The bitmaps of the render target are kept when it is resized, they are
+//  only created again for a new window or when the device is lost.
 // 
+// return
+// BOOL             TRUE, render target is ready
+//
+//*******************************************************************************
+BOOL ImageDialog::CreateRenderTarget(HWND hWnd)
+{
+    RECT Rect;
+    int xt, yt;
+    GetClientRect(hWnd, &Rect);
+    xt = (Rect.right - Rect.left) - 1;
+    yt = (Rect.bottom - Rect.top) - 1;
+
+    if (Backend.GetTarget() && hWnd == Backend.GetTargetWindow()) {
+        if (Backend.Resize(xt, yt) == APP_SUCCESS) {
+            return TRUE;
+        }
+    }
+
+    // new window, or the render target could not be resized
+    ReleaseBitmapRender();
+    return Backend.CreateTarget(hWnd, xt, yt) == APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  BOOL LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image)
+//  BOOL LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image, const RECT* Changed)
+// 
+//  Show an image.  The render target and bitmap are kept from the last image
+//  when the image is the same size, only the changed region is copied to the
+//  bitmap.  They are created again when the size changes or the device is lost.
+// 
+//  HWND hWnd           window to draw in
+//  int xsize, ysize    size of the image
+//  COLORREF* Image     image, it is copied
+//  const RECT* Changed region of the image changed since the last load,
+//                      NULL, the whole image
+// 
+// return
+// BOOL             TRUE, image can be drawn
+//
 //*******************************************************************************
 BOOL ImageDialog::LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image)
 {
-    // delete old data first
-    if (pBitmap) {
-        pBitmap->Release();
-        pBitmap = nullptr;
+    return LoadCOLORREFimage(hWnd, xsize, ysize, Image, NULL);
+}
+
+BOOL ImageDialog::LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image, const RECT* Changed)
+{
+    RENDERRECT Rect;
+    const RENDERRECT* Region = NULL;
+
+    if (!CreateRenderTarget(hWnd)) {
+        BitmapSize = { 0.0f, 0.0f };
+        return FALSE;
     }
 
-    if (pRenderTarget) {
-        pRenderTarget->Release();
-        pRenderTarget = nullptr;
+    // the changed region is of the image loaded last time
+    if (Changed != NULL && !VirtualImage && Image == LoadedImage &&
+        xsize == DisplayXsize && ysize == DisplayYsize) {
+        Rect = { Changed->left, Changed->top, Changed->right, Changed->bottom };
+        Region = &Rect;
+    }
+    if (VirtualImage || xsize != DisplayXsize || ysize != DisplayYsize) {
+        ReleaseTiles();
+        GetTile = NULL;
+        VirtualImage = FALSE;
+    }
+    DisplayXsize = xsize;
+    DisplayYsize = ysize;
+
+    int iRes = Surface.Load(xsize, ysize, (RENDERPIXEL*)Image, Region);
+    if (iRes == APPERR_DEVICELOST) {
+        // render target and all of its bitmaps are created again
+        ReleaseBitmapRender();
+        if (CreateRenderTarget(hWnd)) {
+            Region = NULL;
+            iRes = Surface.Load(xsize, ysize, (RENDERPIXEL*)Image, NULL);
+        }
+    }
+    if (iRes != APP_SUCCESS) {
+        ReleaseTiles();
+        LoadedImage = NULL;
+        BitmapSize = { 0.0f, 0.0f };
+        return FALSE;
+    }
+
+    // kept tiles of the reduced levels in the changed region are made again
+    if (Region != NULL) {
+        RECT Invalid = { Region->left, Region->top, Region->right, Region->bottom };
+        InvalidateTiles(&Invalid);
+    }
+    else {
+        ReleaseTiles();
+    }
+    LoadedImage = Image;
+    BitmapSize = { (float)xsize, (float)ysize };
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+//  BOOL LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context)
+//  BOOL LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context,
+//                          const RECT* Changed)
+// 
+//  Show an image without a bitmap of the whole image.  The tiles of the image
+//  in the window are created with GetImageTile() when they are drawn.
+//  This is also called when the image changes, the kept tiles in the changed
+//  region are released.
+// 
+//  HWND hWnd                   window to draw in
+//  int xsize, ysize            size of the image
+//  GETIMAGETILE GetImageTile   creates a rectangle of the image
+//  void* Context               passed to GetImageTile()
+//  const RECT* Changed         region of the image changed since the last load,
+//                              NULL, the whole image
+// 
+// return
+// BOOL             TRUE, image can be drawn
+//
+//*******************************************************************************
+BOOL ImageDialog::LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context)
+{
+    return LoadVirtualImage(hWnd, xsize, ysize, GetImageTile, Context, NULL);
+}
+
+BOOL ImageDialog::LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context,
+    const RECT* Changed)
+{
+    BOOL Reuse = Changed != NULL && VirtualImage && GetTile == GetImageTile && GetTileContext == Context &&
+        xsize == DisplayXsize && ysize == DisplayYsize;
+
+    if (!CreateRenderTarget(hWnd)) {
+        BitmapSize = { 0.0f, 0.0f };
+        return FALSE;
+    }
+
+    if (Reuse) {
+        // tiles outside of the changed region are kept
+        InvalidateTiles(Changed);
+        return TRUE;
     }
 
+    // delete old data first
+    ReleaseTiles();
+    Surface.Release();
+    LoadedImage = NULL;
+
     DisplayXsize = xsize;
     DisplayYsize = ysize;
+    BitmapSize = { 0.0f, 0.0f };
+    GetTile = NULL;
+    VirtualImage = FALSE;
 
-    // create render target
-    RECT Rect;
-    int xt, yt;
-    GetClientRect(hWnd, &Rect);
-    xt = (Rect.right - Rect.left) - 1;
-    yt = (Rect.bottom - Rect.top) - 1;
+    if (TileImage == NULL) {
+        TileImage = new COLORREF[IMAGE_TILE_SIZE * IMAGE_TILE_SIZE];
+        if (TileImage == NULL) {
+            return FALSE;
+        }
+    }
 
-    pFactory->CreateHwndRenderTarget(
-        D2D1::RenderTargetProperties(),
-        D2D1::HwndRenderTargetProperties(hWnd, D2D1::SizeU(xt, yt)),
-        &pRenderTarget
-    );
+    GetTile = GetImageTile;
+    GetTileContext = Context;
+    VirtualImage = TRUE;
+    BitmapSize = { (float)xsize, (float)ysize };
+    return TRUE;
+}
 
-    if (pRenderTarget) {
-        // bitmap properties set to RGBA 8 bit ignore alpha,96 DPI (Windows default DPI)
-        HRESULT hRes = pRenderTarget->CreateBitmap(D2D1::SizeU(xsize, ysize), Image,
-                                        xsize * sizeof(COLORREF),
-                                        bitmapProperties, &pBitmap);
-        if (FAILED(hRes)) {
-            if (pBitmap) {
-                pBitmap->Release();
-                pBitmap = nullptr;
+//*******************************************************************************
+//
+//  void SetTileSource(GETIMAGETILE GetImageTile, void* Context)
+// 
+//  Set the function that creates the reduced levels of an image loaded with
+//  LoadCOLORREFimage().  Without it the image is always drawn full size.
+//  Call this after LoadCOLORREFimage().
+// 
+//*******************************************************************************
+void ImageDialog::SetTileSource(GETIMAGETILE GetImageTile, void* Context)
+{
+    if (GetImageTile == GetTile && Context == GetTileContext) {
+        // tiles are still good, LoadCOLORREFimage() released the changed ones
+        return;
+    }
+    ReleaseTiles();
+    GetTile = GetImageTile;
+    GetTileContext = Context;
+
+    if (GetTile && TileImage == NULL) {
+        TileImage = new COLORREF[IMAGE_TILE_SIZE * IMAGE_TILE_SIZE];
+        if (TileImage == NULL) {
+            GetTile = NULL;
+        }
+    }
+    return;
+}
+
+//*******************************************************************************
+//
+//  int GetLevel(void)
+// 
+//  Reduced level to draw at the current scale.  Each level pixel is drawn
+//  as 1 to 2 window pixels.
+// 
+// return
+// int              0, the image, or reduced level
+//
+//*******************************************************************************
+int ImageDialog::GetLevel(void)
+{
+    int Level = 0;
+    float Scale = scaleFactor;
+
+    if (!GetTile) {
+        return 0;
+    }
+    while (Level < IMAGE_MAX_LEVELS - 1 && Scale <= 0.5f) {
+        Scale *= 2.0f;
+        Level++;
+    }
+    return Level;
+}
+
+//*******************************************************************************
+//
+//  void ReleaseTiles(void)
+// 
+//  Release the kept tile bitmaps of a virtual image
+// 
+//*******************************************************************************
+void ImageDialog::ReleaseTiles(void)
+{
+    for (int i = 0; i < IMAGE_TILE_CACHE_MAX; i++) {
+        if (Tiles[i].Bitmap) {
+            Backend.ReleaseBitmap(Tiles[i].Bitmap);
+            Tiles[i].Bitmap = NULL;
+        }
+    }
+    return;
+}
+
+//*******************************************************************************
+//
+//  void InvalidateTiles(const RECT* Rect)
+// 
+//  Release the kept tile bitmaps, of any level, that show part of a region
+//  of the image
+// 
+//  const RECT* Rect    region of the image
+// 
+//*******************************************************************************
+void ImageDialog::InvalidateTiles(const RECT* Rect)
+{
+    if (IsRectEmpty(Rect)) {
+        return;
+    }
+    for (int i = 0; i < IMAGE_TILE_CACHE_MAX; i++) {
+        if (Tiles[i].Bitmap == NULL) {
+            continue;
+        }
+        // image pixels of the tile
+        int TileSpan = IMAGE_TILE_SIZE << Tiles[i].Level;
+        RECT TileRect = { Tiles[i].x * TileSpan, Tiles[i].y * TileSpan,
+            (Tiles[i].x + 1) * TileSpan, (Tiles[i].y + 1) * TileSpan };
+        RECT Overlap;
+        if (IntersectRect(&Overlap, &TileRect, Rect)) {
+            Backend.ReleaseBitmap(Tiles[i].Bitmap);
+            Tiles[i].Bitmap = NULL;
+        }
+    }
+    return;
+}
+
+//*******************************************************************************
+//
+//  IMAGETILE* GetTileBitmap(int Level, int TileX, int TileY)
+// 
+//  Get the bitmap of a tile of a level of the image, it is created if it is
+//  not kept.  The least recently drawn tile is replaced when all are used.
+// 
+// return
+// IMAGETILE*       tile with its bitmap, nullptr if it can't be created
+//
+//*******************************************************************************
+IMAGETILE* ImageDialog::GetTileBitmap(int Level, int TileX, int TileY)
+{
+    int Oldest = 0;
+
+    for (int i = 0; i < NumTilesKept; i++) {
+        if (Tiles[i].Bitmap && Tiles[i].Level == Level && Tiles[i].x == TileX && Tiles[i].y == TileY) {
+            Tiles[i].LastUsed = ++TileUseCount;
+            return &Tiles[i];
+        }
+        if (Tiles[Oldest].Bitmap && (!Tiles[i].Bitmap || Tiles[i].LastUsed < Tiles[Oldest].LastUsed)) {
+            Oldest = i;
+        }
+    }
+
+    // size of the level, rounded up
+    int LevelXsize = (DisplayXsize + (1 << Level) - 1) >> Level;
+    int LevelYsize = (DisplayYsize + (1 << Level) - 1) >> Level;
+    int x = TileX * IMAGE_TILE_SIZE;
+    int y = TileY * IMAGE_TILE_SIZE;
+    int xsize = min(IMAGE_TILE_SIZE, LevelXsize - x);
+    int ysize = min(IMAGE_TILE_SIZE, LevelYsize - y);
+
+    if (!GetTile(GetTileContext, Level, x, y, xsize, ysize, TileImage)) {
+        return nullptr;
+    }
+
+    IMAGETILE* Tile = &Tiles[Oldest];
+    if (Tile->Bitmap) {
+        if (Tile->xsize == xsize && Tile->ysize == ysize) {
+            // same size, reuse the bitmap
+            RENDERRECT Dest = { 0, 0, xsize, ysize };
+            if (Backend.CopyFromMemory(Tile->Bitmap, &Dest, (RENDERPIXEL*)TileImage, xsize) == APP_SUCCESS) {
+                Tile->Level = Level;
+                Tile->x = TileX;
+                Tile->y = TileY;
+                Tile->LastUsed = ++TileUseCount;
+                return Tile;
             }
-            BitmapSize = { 0.0f, 0.0f };
-            return FALSE;
         }
+        Backend.ReleaseBitmap(Tile->Bitmap);
+        Tile->Bitmap = NULL;
+    }
 
-        if (pBitmap) {
-            BitmapSize = { (float)xsize, (float)ysize };
-            return TRUE;
+    if (Backend.CreateBitmap(xsize, ysize, (RENDERPIXEL*)TileImage, xsize, &Tile->Bitmap) != APP_SUCCESS) {
+        Tile->Bitmap = NULL;
+        return nullptr;
+    }
+    Tile->Level = Level;
+    Tile->x = TileX;
+    Tile->y = TileY;
+    Tile->xsize = xsize;
+    Tile->ysize = ysize;
+    Tile->LastUsed = ++TileUseCount;
+    return Tile;
+}
+
+//*******************************************************************************
+//
+//  void SetTileCacheSize(int xsize, int ysize)
+// 
+//  Set the number of tile bitmaps kept for the size of the window.  A level
+//  is drawn at a scale down to 1/2, so the window can show twice its size of
+//  the level, which is one more tile across and down when the tiles are not
+//  lined up with the window.  When fewer tiles are kept than a repaint draws,
+//  every tile would be made again each repaint.
+//  Tiles over the new number are released.
+// 
+//  int xsize, ysize    size of the window in pixels
+// 
+//*******************************************************************************
+void ImageDialog::SetTileCacheSize(int xsize, int ysize)
+{
+    int NumX = (2 * xsize + IMAGE_TILE_SIZE - 1) / IMAGE_TILE_SIZE + 1;
+    int NumY = (2 * ysize + IMAGE_TILE_SIZE - 1) / IMAGE_TILE_SIZE + 1;
+    int NumTiles = NumX * NumY;
+
+    NumTiles = max(IMAGE_TILE_CACHE, min(IMAGE_TILE_CACHE_MAX, NumTiles));
+    for (int i = NumTiles; i < NumTilesKept; i++) {
+        if (Tiles[i].Bitmap) {
+            Backend.ReleaseBitmap(Tiles[i].Bitmap);
+            Tiles[i].Bitmap = NULL;
         }
     }
-    BitmapSize = { 0.0f, 0.0f };
-    return FALSE;
+    NumTilesKept = NumTiles;
+    return;
+}
+
+//*******************************************************************************
+//
+//  void DrawTiles(int Level, int ix, int iy)
+// 
+//  Helper function for Repaint(), draw the tiles of a level of the image
+//  that are in the window
+// 
+//  int Level       0, the image, or reduced level
+//  int ix, iy      pan offset in image pixels
+// 
+//*******************************************************************************
+void ImageDialog::DrawTiles(int Level, int ix, int iy)
+{
+    ID2D1HwndRenderTarget* pRenderTarget = Backend.GetTarget();
+    D2D1_SIZE_F TargetSize = pRenderTarget->GetSize();
+    int Step = 1 << Level;                  // image pixels per level pixel
+    int TileSpan = IMAGE_TILE_SIZE * Step;  // image pixels per tile
+    int NumTilesX = (DisplayXsize + TileSpan - 1) / TileSpan;
+    int NumTilesY = (DisplayYsize + TileSpan - 1) / TileSpan;
+
+    SetTileCacheSize((int)ceilf(TargetSize.width), (int)ceilf(TargetSize.height));
+
+    // image pixels in the window
+    int Left = -ix;
+    int Top = -iy;
+    int Right = Left + (int)ceilf(TargetSize.width / scaleFactor);
+    int Bottom = Top + (int)ceilf(TargetSize.height / scaleFactor);
+    if (Right < 0 || Bottom < 0) {
+        return;
+    }
+
+    int FirstX = max(0, Left / TileSpan);
+    int FirstY = max(0, Top / TileSpan);
+    int LastX = min(NumTilesX - 1, Right / TileSpan);
+    int LastY = min(NumTilesY - 1, Bottom / TileSpan);
+
+    // tiles edges are on pixel boundaries, no blending between tiles
+    pRenderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+    for (int TileY = FirstY; TileY <= LastY; TileY++) {
+        for (int TileX = FirstX; TileX <= LastX; TileX++) {
+            IMAGETILE* Tile = GetTileBitmap(Level, TileX, TileY);
+            if (!Tile) {
+                continue;
+            }
+            float x = (float)(ix + TileX * TileSpan);
+            float y = (float)(iy + TileY * TileSpan);
+
+            D2D1_RECT_F Rectf = D2D1::RectF(x, y, x + (float)(Tile->xsize * Step), y + (float)(Tile->ysize * Step));
+            pRenderTarget->DrawBitmap((ID2D1Bitmap*)Tile->Bitmap, Rectf, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        }
+    }
+    return;
 }
 
 //*******************************************************************************
@@ -162,6 +546,8 @@ BOOL ImageDialog::LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* I
 //*******************************************************************************
 BOOL ImageDialog::Repaint()
 {
+    ID2D1HwndRenderTarget* pRenderTarget = Backend.GetTarget();
+
     // only do this if target exists
     if (pRenderTarget) {
         pRenderTarget->BeginDraw();
@@ -174,13 +560,20 @@ BOOL ImageDialog::Repaint()
         pRenderTarget->Clear(D2D1::ColorF(D2D1::ColorF::SeaShell));
         
         //Pan bitmap in bitmap pixel steps not display pixel steps
-        D2D1_SIZE_F RectSize = pBitmap->GetSize();
         int ix, iy;
         ix = (int)(panOffset.x + 0.5f);
         iy = (int)(panOffset.y + 0.5f);
 
-        D2D1_RECT_F Rectf = D2D1::RectF((float)ix, float(iy), (float)ix + RectSize.width, float(iy) + RectSize.height);
-        pRenderTarget->DrawBitmap(pBitmap, Rectf, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        int Level = GetLevel();
+        if (VirtualImage || Level > 0) {
+            DrawTiles(Level, ix, iy);
+        }
+        else if (Surface.GetBitmap()) {
+            ID2D1Bitmap* pBitmap = (ID2D1Bitmap*)Surface.GetBitmap();
+            D2D1_SIZE_F RectSize = pBitmap->GetSize();
+            D2D1_RECT_F Rectf = D2D1::RectF((float)ix, float(iy), (float)ix + RectSize.width, float(iy) + RectSize.height);
+            pRenderTarget->DrawBitmap(pBitmap, Rectf, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        }
         
         HRESULT hr = pRenderTarget->EndDraw();
         if (hr == D2DERR_RECREATE_TARGET) {
@@ -199,8 +592,24 @@ BOOL ImageDialog::Repaint()
 //*******************************************************************************
 void ImageDialog::Rescale(int Delta)
 {
-    scaleFactor += (Delta > 0) ? 0.1f : -0.1f;
-    scaleFactor = max(0.5f, min(20.0f, scaleFactor));
+    // steps of 0.1 above 1, below 1 the steps are relative so the
+    // reduced levels can be reached
+    if (Delta > 0) {
+        if (scaleFactor < 1.0f) {
+            // stop at 1 on the way up
+            scaleFactor = min(1.0f, scaleFactor * 1.25f);
+        }
+        else {
+            scaleFactor += 0.1f;
+        }
+    }
+    else {
+        scaleFactor = (scaleFactor <= 1.0f) ? scaleFactor * 0.8f : scaleFactor - 0.1f;
+    }
+    if (fabsf(scaleFactor - 1.0f) < 0.01f) {
+        scaleFactor = 1.0f;
+    }
+    scaleFactor = max(IMAGE_MIN_SCALE, min(IMAGE_MAX_SCALE, scaleFactor));
 }
 
 //*******************************************************************************
@@ -210,7 +619,7 @@ void ImageDialog::Rescale(int Delta)
 //*******************************************************************************
 void ImageDialog::SetScale(float Scale)
 {
-    scaleFactor = max(0.5f, min(20.0f, Scale));
+    scaleFactor = max(IMAGE_MIN_SCALE, min(IMAGE_MAX_SCALE, Scale));
 }
 
 //*******************************************************************************
@@ -463,7 +872,8 @@ void ImageDialog::SetReportedWindowPos(HWND hwndWindow, WINDOWPOS* wpos)
 //*******************************************************************************
 void ImageDialog::UpdateStatusBar(HWND ParentWindow) {
     if (hwndStatusBar) {
-        WCHAR szString[MAX_PATH];
+        WCHAR szString[2 * MAX_PATH];
+        WCHAR szPosition[MAX_PATH] = L"";
         RECT Rect;
 
         if (!hwndStatusBar) {
@@ -471,17 +881,36 @@ void ImageDialog::UpdateStatusBar(HWND ParentWindow) {
         }
 
         GetClientRect(ParentWindow, &Rect);
+
+        if (GetPositionText && BitmapSize.x > 0.0f && BitmapSize.y > 0.0f) {
+            GetPositionText(PositionTextContext, BitMapMousePos.x, BitMapMousePos.y, szPosition, MAX_PATH);
+        }
         
-        swprintf_s(szString, MAX_PATH,
-            L"BitMapPos=(%4d,%4d), ScaleFactor=%.3f, Bitmap=(%4d,%4d)",
+        swprintf_s(szString, 2 * MAX_PATH,
+            L"BitMapPos=(%4d,%4d), ScaleFactor=%.3f, Bitmap=(%4d,%4d) %s",
             BitMapMousePos.x, BitMapMousePos.y,
             scaleFactor,
-            (int)BitmapSize.x,(int)BitmapSize.y);
+            (int)BitmapSize.x,(int)BitmapSize.y,
+            szPosition);
 
         SendMessage(hwndStatusBar, SB_SETTEXT, MAKEWPARAM(0, SBT_POPOUT), reinterpret_cast<LPARAM>(szString));
     }
 }
 
+//*******************************************************************************
+//
+//  void SetPositionText(GETPOSITIONTEXT GetText, void* Context)
+// 
+//  Set the function that describes the pixel under the mouse in the status bar.
+//  It is called on every mouse move, so it should be quick.
+// 
+//*******************************************************************************
+void ImageDialog::SetPositionText(GETPOSITIONTEXT GetText, void* Context)
+{
+    GetPositionText = GetText;
+    PositionTextContext = Context;
+}
+
 //*******************************************************************************
 //
 // 
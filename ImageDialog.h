@@ -2,16 +2,46 @@
 #include "framework.h"
 #include <windows.h>
 #include <d2d1.h>
+#include "RenderBackend.h"
+#include "D2DBackend.h"
+
+// virtual images are drawn in tiles of IMAGE_TILE_SIZE x IMAGE_TILE_SIZE pixels
+// the last tiles drawn are kept, as many as the window can show at any zoom,
+// at least IMAGE_TILE_CACHE and at most IMAGE_TILE_CACHE_MAX (1 MB per tile)
+#define IMAGE_TILE_SIZE 512
+#define IMAGE_TILE_CACHE 32
+#define IMAGE_TILE_CACHE_MAX 192
+// zoomed out images are drawn from reduced levels, level L is 1/2^L of the image size
+#define IMAGE_MAX_LEVELS 7
+#define IMAGE_MIN_SCALE (1.0f/64.0f)
+#define IMAGE_MAX_SCALE 20.0f
+
+// Called to create a rectangle of a virtual image, or of a reduced level of
+// an image, when it is drawn
+// Level is 0 for the image, x, y is the upper left corner in the level,
+// Tile is xsize x ysize
+// return FALSE if the rectangle can't be created
+typedef BOOL (*GETIMAGETILE)(void* Context, int Level, int x, int y, int xsize, int ysize, COLORREF* Tile);
+
+// Called to get a description of the image pixel under the mouse for the status bar
+// x, y is the image pixel, Text is TextSize characters
+typedef void (*GETPOSITIONTEXT)(void* Context, int x, int y, WCHAR* Text, int TextSize);
+
+typedef struct {
+	int Level;
+	int x;					// tile column, row
+	int y;
+	int xsize;				// size of the bitmap
+	int ysize;
+	RENDERBITMAP Bitmap;	// NULL, entry is not used
+	ULONGLONG LastUsed;
+} IMAGETILE;
 
 class ImageDialog
 {
 private:
-	ID2D1Factory* pFactory = nullptr;
-	ID2D1HwndRenderTarget* pRenderTarget = nullptr;
-	ID2D1Bitmap* pBitmap = nullptr;
-	D2D1_BITMAP_PROPERTIES bitmapProperties = { D2D1::PixelFormat(DXGI_FORMAT_R8G8B8A8_UNORM,
-														 D2D1_ALPHA_MODE_IGNORE),
-												96.0f, 96.0f };
+	D2DBackend Backend;					// render target of the window and its bitmaps
+	ImageSurface Surface;				// bitmap of the image
 
 	// bitmap display scaling
 	float scaleFactor = 1.0f;
@@ -30,6 +60,29 @@ private:
 	int DisplayYsize = 0;
 	WINDOWPOS WindowPos = { NULL,NULL,0,0,0,0,0 };
 
+	// virtual image, or reduced levels, only the tiles in the window are created
+	BOOL VirtualImage = FALSE;		// there is no bitmap of the whole image
+	GETIMAGETILE GetTile = NULL;
+	void* GetTileContext = NULL;
+	IMAGETILE Tiles[IMAGE_TILE_CACHE_MAX] = { 0 };
+	int NumTilesKept = IMAGE_TILE_CACHE;	// tiles kept for the window size, see SetTileCacheSize()
+	ULONGLONG TileUseCount = 0;
+	COLORREF* TileImage = NULL;
+
+	// status bar description of the pixel under the mouse
+	GETPOSITIONTEXT GetPositionText = NULL;
+	void* PositionTextContext = NULL;
+
+	COLORREF* LoadedImage = NULL;		// image copied to Surface
+
+	BOOL CreateRenderTarget(HWND hWnd);
+	void InvalidateTiles(const RECT* Rect);
+	int GetLevel(void);
+	IMAGETILE* GetTileBitmap(int Level, int TileX, int TileY);
+	void SetTileCacheSize(int xsize, int ysize);
+	void ReleaseTiles(void);
+	void DrawTiles(int Level, int ix, int iy);
+
 public:
 	ImageDialog() {
 	};
@@ -41,6 +94,11 @@ public:
 	void ReleaseDirect2D(void);
 	void ReleaseBitmapRender(void);
 	BOOL LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image);
+	BOOL LoadCOLORREFimage(HWND hWnd, int xsize, int ysize, COLORREF* Image, const RECT* Changed);
+	BOOL LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context);
+	BOOL LoadVirtualImage(HWND hWnd, int xsize, int ysize, GETIMAGETILE GetImageTile, void* Context,
+		const RECT* Changed);
+	void SetTileSource(GETIMAGETILE GetImageTile, void* Context);
 	BOOL Repaint(void);
 
 	void Rescale(int Delta);
@@ -53,6 +111,7 @@ public:
 	BOOL PanImage(HWND hwndParent,int x, int y);
 	HWND CreateStatusBar(HWND hwndParent, int idStatus, HINSTANCE hinst);
 	void UpdateStatusBar(HWND ParentWindow);
+	void SetPositionText(GETPOSITIONTEXT GetText, void* Context);
 	BOOL StatusBarExists(void);
 	void ShowStatusBar(BOOL Show);
 	void DestroyStatusBar();
@@ -26,6 +26,10 @@
 //                          Reset Zoom
 //                          Close
 //                      Changed Image Window, does not close with ESC or Enter keys
+// V1.2.15  2026-10-17  Virtual displays are shown a tile at a time
+// V1.2.16  2026-10-17  Zoomed out displays are drawn from reduced levels
+// V1.2.17  2026-10-17  Status bar shows the overlay pixel and layer values under the mouse
+// V1.2.18  2026-10-17  Only the updated region of the display is loaded into the image window
 // 
 // This handles all the actual display of the bitmap generated
 //
@@ -47,6 +51,93 @@
 
 extern void ApplyDisplay(HWND hDlg);
 
+//*******************************************************************************
+//
+// GETIMAGETILE function for ImageDialog::LoadVirtualImage() and SetTileSource()
+// Create a rectangle of a level of the display from the current overlay
+// 
+//*******************************************************************************
+static BOOL GetDisplayTile(void* Context, int Level, int x, int y, int xsize, int ysize, COLORREF* Tile)
+{
+    COLORREF* Overlay;
+    int OverlayXsize, OverlayYsize;
+
+    if (ImageLayers->GetOverlayImage(&Overlay, &OverlayXsize, &OverlayYsize) != APP_SUCCESS) {
+        return FALSE;
+    }
+    if (Displays->GetDisplayTile(Level, x, y, xsize, ysize, Tile, Overlay, OverlayXsize, OverlayYsize) != APP_SUCCESS) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+// GETPOSITIONTEXT function for ImageDialog::SetPositionText()
+// Describe the display pixel under the mouse, the overlay pixel and the
+// enabled layers there with their pixel values
+// 
+//*******************************************************************************
+static void GetPositionText(void* Context, int x, int y, WCHAR* Text, int TextSize)
+{
+    LAYERPIXEL Pixels[COVERAGE_LAYERS];
+    int OverlayX, OverlayY;
+    int OverlayXsize, OverlayYsize;
+
+    Text[0] = L'\0';
+    if (Displays->GetOverlayPosition(x, y, &OverlayX, &OverlayY) != APP_SUCCESS) {
+        return;
+    }
+    if (OverlayX == DISPLAY_GAP_MAJOR || OverlayY == DISPLAY_GAP_MAJOR) {
+        swprintf_s(Text, TextSize, L"Major gap");
+        return;
+    }
+    if (OverlayX == DISPLAY_GAP_MINOR || OverlayY == DISPLAY_GAP_MINOR) {
+        swprintf_s(Text, TextSize, L"Minor gap");
+        return;
+    }
+    ImageLayers->GetCurrentOverlaySize(&OverlayXsize, &OverlayYsize);
+    if (OverlayX >= OverlayXsize || OverlayY >= OverlayYsize) {
+        swprintf_s(Text, TextSize, L"Background");
+        return;
+    }
+
+    int Length = swprintf_s(Text, TextSize, L"Overlay=(%d,%d)", OverlayX, OverlayY);
+    int NumPixels = ImageLayers->GetLayersAt(OverlayX, OverlayY, Pixels, COVERAGE_LAYERS);
+    for (int i = 0; i < NumPixels && Length > 0 && Length < TextSize - 48; i++) {
+        Length += swprintf_s(Text + Length, (size_t)TextSize - Length, L" Layer %d (%d,%d)=%d",
+            Pixels[i].Layer, Pixels[i].x, Pixels[i].y, Pixels[i].Value);
+    }
+    return;
+}
+
+//*******************************************************************************
+//
+// Helper function for ImageDlg, load the display into the image window
+// The image window keeps what it has of the display outside of the region
+// updated since the last load.
+// 
+//*******************************************************************************
+static BOOL LoadDisplay(void)
+{
+    int xsize, ysize;
+    COLORREF* Image;
+    RECT Updated;
+    Displays->GetDisplay(&Image, &xsize, &ysize);
+    Displays->GetUpdatedRect(&Updated);
+
+    if (Displays->IsVirtual()) {
+        // too large for one bitmap
+        return ImgDlg->LoadVirtualImage(hwndImage, xsize, ysize, GetDisplayTile, NULL, &Updated);
+    }
+    if (!ImgDlg->LoadCOLORREFimage(hwndImage, xsize, ysize, Image, &Updated)) {
+        return FALSE;
+    }
+    // reduced levels when zoomed out
+    ImgDlg->SetTileSource(GetDisplayTile, NULL);
+    return TRUE;
+}
+
 //*******************************************************************************
 //
 // Message handler for ImageDlg dialog box.
@@ -71,6 +162,7 @@ INT_PTR CALLBACK ImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
         }
 
         ImgDlg->CreateStatusBar(hDlg, ID_IMG_STATUSBAR, hInst);
+        ImgDlg->SetPositionText(GetPositionText, NULL);
         if (ShowStatusBar) {
             ImgDlg->ShowStatusBar(TRUE);
         }
@@ -118,11 +210,7 @@ INT_PTR CALLBACK ImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 
         case IDC_GENERATE_BMP:
         {
-            int xsize, ysize;
-            COLORREF* Image;
-            Displays->GetDisplay(&Image, &xsize, &ysize);
-            
-            if(ImgDlg->LoadCOLORREFimage(hwndImage, xsize, ysize,Image)) {
+            if (LoadDisplay()) {
                 ImgDlg->Repaint();
                 ImgDlg->UpdateStatusBar(hDlg);
             }
@@ -192,11 +280,7 @@ INT_PTR CALLBACK ImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 
     case WM_SIZE:
     {
-        int xsize, ysize;
-        COLORREF* Image;
-        Displays->GetDisplay(&Image, &xsize, &ysize);
-
-        if (ImgDlg->LoadCOLORREFimage(hwndImage, xsize, ysize, Image)) {
+        if (LoadDisplay()) {
             ImgDlg->Repaint();
             ImgDlg->UpdateStatusBar(hDlg);
         }
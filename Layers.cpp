@@ -23,6 +23,30 @@
 // V1.0.1	2023-12-20	Initial release
 // V1.0.2	2023-12-20  Added Y direction flag for which direction to move image
 //						Changed color mixing formula when pixels are overlapped.
+// V1.2.0	2026-10-17	Layer images are loaded using ImageBuffer, large image files
+//						are memory mapped instead of read into memory
+// V1.2.1	2026-10-17	Layers are composited at their own pixel size using templated kernels
+// V1.2.2	2026-10-17	Layers are composited from bitplanes, 64 pixels at a time
+// V1.2.3	2026-10-17	Overlay is kept as layer coverage masks, colors are resolved with
+//						a lookup table so color and enable changes only need a remap
+// V1.2.4	2026-10-17	When a layer is moved only its old and new locations are recomposited
+// V1.2.5	2026-10-17	Coverage masks and color lookup use SSE2/AVX2 row kernels,
+//						selected at run time
+// V1.2.6	2026-10-17	Overlay is composited in tiles of rows, tiles are done in parallel
+// V1.2.7	2026-10-17	Removed the 8 layer limit, layers are kept in vectors with handles
+//						More than 8 layers are composited directly instead of with masks
+// V1.2.8	2026-10-17	Layer images are shared through the image cache (ImageCache.cpp)
+// V1.2.9	2026-10-17	Layer files in a configuration are loaded in parallel, then added
+//						in configuration order.  The load time of each file is kept.
+// V1.2.10	2026-10-17	Loading reports progress and can be cancelled, see SetLoadProgress()
+// V1.2.16	2026-10-17	The overlay region changed by UpdateOverlay() and RemapOverlay() is kept
+//						for the display, see GetChangedRect()
+// V1.2.17	2026-10-17	Added GetLayersAt(), the layers and layer pixels under an overlay pixel
+// V1.2.24	2026-10-17	GetLayersAt() checks the layer bounds of pixels in regions waiting to be
+//						recomposited, the footprint mask is not up to date there
+//						The color lookup row kernels are in OverlayRemap.cpp
+//						Mixed colors that are the overlay color are only made the background
+//						color by a later 0 layer pixel, the same as V1.0.2
 //
 // Application standardized error numbers for functions:
 //		See AppErrors.h
@@ -31,11 +55,81 @@
 #include <shtypes.h>
 #include <string.h>
 #include <stdio.h>
+#include <intrin.h>
+#include <emmintrin.h>
 #include "AppErrors.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
+#include "ImageBuffer.h"
+#include "ImageCache.h"
+#include "ParallelTasks.h"
+#include "OverlayRemap.h"
 #include "Layers.h"
 
+// layer file loaded by LoadLayers()
+typedef struct {
+	WCHAR Filename[MAX_PATH];
+	int Duplicate;			// index of an earlier entry with the same file, -1 if none
+	ImageBuffer* Image;
+	int Result;				// from AcquireImage()
+	double LoadTime;		// milliseconds
+} LAYERLOAD;
+
+// context of the LoadLayerTask() tasks
+typedef struct {
+	LAYERLOAD* Loads;
+	int Total;
+	LOADPROGRESS Progress;
+	void* ProgressContext;
+	volatile LONG Done;		// # of files done
+	volatile LONG Cancel;	// TRUE, the rest of the files are not loaded
+} LAYERLOADJOB;
+
+//*******************************************************************************
+//
+//  static double ElapsedTime(LARGE_INTEGER* Start)
+//
+// return
+// double				milliseconds since Start (from QueryPerformanceCounter)
+//
+//*******************************************************************************
+static double ElapsedTime(LARGE_INTEGER* Start) {
+	LARGE_INTEGER Now;
+	LARGE_INTEGER Frequency;
+
+	QueryPerformanceCounter(&Now);
+	QueryPerformanceFrequency(&Frequency);
+	return (double)(Now.QuadPart - Start->QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+}
+
+//*******************************************************************************
+//
+//  static void LoadLayerTask(void* Context, int Index)
+//
+// ParallelFor() task to load one layer file of a configuration
+// Context is the LAYERLOADJOB
+//
+//*******************************************************************************
+static void LoadLayerTask(void* Context, int Index) {
+	LAYERLOADJOB* Job = (LAYERLOADJOB*)Context;
+	LAYERLOAD* Load = Job->Loads + Index;
+	LARGE_INTEGER Start;
+
+	// a duplicate shares the image of the earlier entry
+	if (Load->Duplicate < 0 && !Job->Cancel) {
+		QueryPerformanceCounter(&Start);
+		Load->Result = AcquireImage(Load->Filename, &Load->Image);
+		Load->LoadTime = ElapsedTime(&Start);
+	}
+
+	if (Job->Progress != NULL) {
+		LONG Done = InterlockedIncrement(&Job->Done);
+		if (!Job->Progress(Job->ProgressContext, (int)Done, Job->Total)) {
+			InterlockedExchange(&Job->Cancel, TRUE);
+		}
+	}
+}
+
 //*******************************************************************************
 //
 //  Layers()
@@ -70,6 +164,18 @@ int Layers::ReleaseOverlay(void) {
 		delete[] OverlayImage;
 		OverlayImage = NULL;
 	}
+	if (CoverageMask != NULL) {
+		delete[] CoverageMask;
+		CoverageMask = NULL;
+	}
+	if (FootprintMask != NULL) {
+		delete[] FootprintMask;
+		FootprintMask = NULL;
+	}
+	CoverageValid = FALSE;
+	NumDirtyRects = 0;
+	ImageXextent = 0;
+	ImageYextent = 0;
 	OverlayValid = FALSE;
 	return APP_SUCCESS;
 };
@@ -86,44 +192,65 @@ int Layers::ReleaseOverlay(void) {
 // 
 // return
 // int					APP_SUCCESS, 1,	Success
-//						APPERR_PARAMETER, max layers already reached
+//						!=1	Standard application error number
 //
 //*******************************************************************************
 int Layers::AddLayer(WCHAR* Filename) {
 	int iRes;
-	int* Image;
-	IMAGINGHEADER ImageHeader;
+	ImageBuffer* Image;
+	LARGE_INTEGER Start;
 
-	if (NumLayers > MAX_LAYERS) {
-		return APPERR_PARAMETER;
-	}
-
-	// try loading as .img file
-	iRes = LoadImageFile(&Image, Filename, &ImageHeader);
+	// load as .img file, or as a BMP file
+	// layers using the same file share the image
+	QueryPerformanceCounter(&Start);
+	iRes = AcquireImage(Filename, &Image);
 	if (iRes != APP_SUCCESS) {
-		iRes = LoadBMPfile(&Image, Filename, &ImageHeader);
-		if (iRes != APP_SUCCESS) {
-			return iRes;
-		}
+		return iRes;
 	}
 
+	return AddLayerImage(Filename, Image, ElapsedTime(&Start));
+};
+
+//*******************************************************************************
+//
+//  int AddLayerImage(WCHAR* Filename, ImageBuffer* Image, double LoadTime)
+// 
+// This adds a layer using an image from AcquireImage()
+// The layer owns the reference to the image.
+// 
+// WCHAR* Filename		file of the image
+// ImageBuffer* Image	image of the layer
+// double LoadTime		time to load the file, milliseconds
+// 
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int Layers::AddLayerImage(WCHAR* Filename, ImageBuffer* Image, double LoadTime) {
 	// save results in Layers class variables
-	LayerImage[NumLayers] = Image;
-	LayerXsize[NumLayers] = ImageHeader.Xsize;
-	LayerYsize[NumLayers] = ImageHeader.Ysize;
+	LayerImage.push_back(Image);
+	LayerXsize.push_back(Image->GetXsize());
+	LayerYsize.push_back(Image->GetYsize());
 
 	WCHAR* FileAdded;
 	FileAdded = new WCHAR[MAX_PATH];
 	wcscpy_s(FileAdded, MAX_PATH,Filename);
-	LayerFilename[NumLayers] = FileAdded;
+	LayerFilename.push_back(FileAdded);
 
-	LayerColor[NumLayers] = rgbDefaultLayerColor;
-	LayerX[NumLayers] = 0;
-	LayerY[NumLayers] = 0;
-	Enabled[NumLayers] = TRUE;
+	LayerColor.push_back(rgbDefaultLayerColor);
+	LayerX.push_back(0);
+	LayerY.push_back(0);
+	Enabled.push_back(TRUE);
+	LayerLoadTime.push_back(LoadTime);
+
+	// new handle, handles are not reused
+	LayerHandle.push_back((int)HandleLayer.size());
+	HandleLayer.push_back(NumLayers);
 
 	NumLayers++;
 	OverlayValid = FALSE;
+	CoverageValid = FALSE;
 
 	return APP_SUCCESS;
 };
@@ -146,27 +273,28 @@ int Layers::ReleaseLayer(int LayerNum) {
 		return APPERR_PARAMETER;
 	}
 	// release allocated memory
-	delete[] LayerImage[LayerNum];
+	ReleaseImage(LayerImage[LayerNum]);
 	delete[] LayerFilename[LayerNum];
+	HandleLayer[LayerHandle[LayerNum]] = -1;
+
+	// the rest of the layers move down 1 slot
+	LayerImage.erase(LayerImage.begin() + LayerNum);
+	LayerXsize.erase(LayerXsize.begin() + LayerNum);
+	LayerYsize.erase(LayerYsize.begin() + LayerNum);
+	LayerColor.erase(LayerColor.begin() + LayerNum);
+	LayerX.erase(LayerX.begin() + LayerNum);
+	LayerY.erase(LayerY.begin() + LayerNum);
+	Enabled.erase(Enabled.begin() + LayerNum);
+	LayerLoadTime.erase(LayerLoadTime.begin() + LayerNum);
+	LayerFilename.erase(LayerFilename.begin() + LayerNum);
+	LayerHandle.erase(LayerHandle.begin() + LayerNum);
 
 	NumLayers--;
-
-	if (LayerNum == NumLayers) {
-		// last layer was the one deleted
-		OverlayValid = FALSE;
-		return APP_SUCCESS;
-	}
-	// move the rest of the layers down 1 slot
 	for (int i = LayerNum; i < NumLayers; i++) {
-		LayerImage[i] = LayerImage[i+1];
-		LayerXsize[i] = LayerXsize[i+1];
-		LayerYsize[i] = LayerYsize[i+1];
-		LayerColor[i] = LayerColor[i+1];
-		LayerX[i] = LayerX[i+1];
-		LayerY[i] = LayerY[i+1];
-		Enabled[i] = Enabled[i + 1];
-		LayerFilename[i] = LayerFilename[i+1];
+		HandleLayer[LayerHandle[i]] = i;
 	}
+
+	CoverageValid = FALSE;
 	OverlayValid = FALSE;
 	return APP_SUCCESS;
 };
@@ -184,7 +312,17 @@ int Layers::ReleaseLayer(int LayerNum) {
 //*******************************************************************************
 int Layers::CreateOverlay(int xsize, int ysize) {
 	OverlayImage = new COLORREF[xsize * ysize];
+	if (NumLayers <= COVERAGE_LAYERS) {
+		// more layers than this are composited without the masks
+		CoverageMask = new BYTE[xsize * ysize];
+		FootprintMask = new BYTE[xsize * ysize];
+		if (CoverageMask == NULL || FootprintMask == NULL) {
+			ReleaseOverlay();
+			return APPERR_MEMALLOC;
+		}
+	}
 	if (OverlayImage == NULL) {
+		ReleaseOverlay();
 		ImageXextent = 0;
 		ImageYextent = 0;
 		return APPERR_MEMALLOC;
@@ -193,6 +331,9 @@ int Layers::CreateOverlay(int xsize, int ysize) {
 	for (int i = 0; i < (xsize * ysize); i++) {
 		OverlayImage[i] = rgbOverlayColor;
 	}
+	// coverage isn't valid until it is updated using UpdateOverlay()
+	CoverageValid = FALSE;
+	NumDirtyRects = 0;
 
 	ImageXextent = xsize;
 	ImageYextent = ysize;
@@ -203,111 +344,650 @@ int Layers::CreateOverlay(int xsize, int ysize) {
 
 //*******************************************************************************
 //
-//  int UpdateOverlay(void)
+//  Overlay compositing
 // 
-// This generates the overlay image from the current Layer configuration
+// A layer pixel is set when it is not 0.
+// An overlay pixel is set when it is not the background or overlay color.
+// Layers are added to the overlay in order:
+//	layer pixel 0		overlay pixel becomes the background color, if not already set
+//	layer pixel set		overlay pixel becomes the layer color, if not already set
+//						otherwise the layer color is mixed into the overlay pixel
+// 
+// With COVERAGE_LAYERS (8) or less layers, the overlay is kept as two masks
+// with a bit for each layer:
+//	CoverageMask		layer pixel is set
+//	FootprintMask		pixel is inside of the layer
+// The masks only depend on the layer images and locations.  They are made
+// from the layer bitplanes 64 pixels at a time by BuildCoverage().
+// 
+// The overlay colors are then looked up from the masks using a table
+// of 512 colors made from the layer colors, enables, background and
+// overlay colors (BuildColorLUT).  Changing only colors or enables needs
+// just the lookup to be done again (RemapOverlay), not the layers.
+// 
+// With more layers than that, the layers are composited directly into the
+// overlay image in order (CompositeDirect).  Color and enable changes then
+// need the layers to be done again.
+// 
+// The overlay is done in tiles of rows (CompositeRegion).  Each tile has all
+// of its layers and colors done while it is in the cache, and the tiles are
+// done in parallel.  Tiles don't share pixels, so the result is the same as
+// doing one layer at a time.
+// 
+// Mixed layer colors can be exactly the overlay color.  That pixel stays the
+// overlay color, unless a later layer has a 0 pixel there and makes it the
+// background color.  The coverage mask alone can't tell, so with the masks
+// those pixels are also done from the footprint (RemapOverlayColorRow).
+// The colors and mixing are in OverlayRemap.cpp.
+//
+//*******************************************************************************
+static inline int LowestBit(UINT64 Bits) {
+	// Bits must not be 0
+	unsigned long Index;
+#ifdef _WIN64
+	_BitScanForward64(&Index, Bits);
+#else
+	if (!_BitScanForward(&Index, (unsigned long)Bits)) {
+		_BitScanForward(&Index, (unsigned long)(Bits >> 32));
+		Index += 32;
+	}
+#endif
+	return (int)Index;
+}
+
+static inline UINT64 RangeMask(int Lo, int Hi) {
+	// bits Lo to Hi-1, 0 <= Lo < Hi <= 64
+	UINT64 Mask = (Hi == 64) ? ~(UINT64)0 : (((UINT64)1 << Hi) - 1);
+	return Mask & ~(((UINT64)1 << Lo) - 1);
+}
+
+static inline UINT64 GetLayerBits(const UINT64* Row, size_t Pitch, LONGLONG Start) {
+	// 64 bits of a bitplane row starting at column Start
+	// columns outside of the row are 0
+	if (Start < 0) {
+		if (Start <= -64) {
+			return 0;
+		}
+		return Row[0] << (int)(-Start);
+	}
+	size_t Word = (size_t)(Start >> 6);
+	int Bit = (int)(Start & 63);
+	if (Word >= Pitch) {
+		return 0;
+	}
+	UINT64 Bits = Row[Word] >> Bit;
+	if (Bit != 0 && Word + 1 < Pitch) {
+		Bits |= Row[Word + 1] << (64 - Bit);
+	}
+	return Bits;
+}
+
+static inline void OrBytes(BYTE* Mask, int Count, BYTE LayerBit) {
+	// add LayerBit to Count pixels, 16 pixels at a time using SSE2
+	const __m128i Bit = _mm_set1_epi8((char)LayerBit);
+	int i = 0;
+
+	for (; i + 16 <= Count; i += 16) {
+		__m128i* Pixels = (__m128i*)(Mask + i);
+		_mm_storeu_si128(Pixels, _mm_or_si128(_mm_loadu_si128(Pixels), Bit));
+	}
+	for (; i < Count; i++) {
+		Mask[i] |= LayerBit;
+	}
+}
+
+template <typename RUNFUNC>
+static inline void ForEachRun(UINT64 Bits, RUNFUNC Run) {
+	// call Run(First, Count) for each run of set bits in Bits
+	while (Bits) {
+		int First = LowestBit(Bits);
+		UINT64 Rest = ~(Bits >> First);
+		int Count = Rest ? LowestBit(Rest) : 64 - First;
+		Run(First, Count);
+		if (First + Count >= 64) {
+			break;
+		}
+		Bits &= ~(((UINT64)1 << (First + Count)) - 1);
+	}
+}
+
+static inline void OrRuns(BYTE* Mask, UINT64 Bits, BYTE LayerBit) {
+	// add LayerBit to the pixels in Bits, a run of pixels at a time
+	ForEachRun(Bits, [=](int First, int Count) {
+		OrBytes(Mask + First, Count, LayerBit);
+	});
+}
+
+//*******************************************************************************
+//
+//  REMAPROW GetRemapRow(void)
+// 
+// The color lookup row kernel for this processor, see OverlayRemap.h
+// 
+//*******************************************************************************
+static REMAPROW GetRemapRow(void) {
+	static REMAPROW RemapRow = NULL;
+
+	if (RemapRow == NULL) {
+#ifdef PF_AVX2_INSTRUCTIONS_AVAILABLE
+		if (IsProcessorFeaturePresent(PF_AVX2_INSTRUCTIONS_AVAILABLE)) {
+			RemapRow = RemapRowAVX2;
+		}
+		else
+#endif
+		{
+			RemapRow = RemapRowSSE2;
+		}
+	}
+	return RemapRow;
+}
+
+//*******************************************************************************
+//
+//  void GetLayerOrigin(int Layer, int* x, int* y)
+// 
+// The overlay pixel of the layer's first row and column at its current location.
+// It can be outside of the overlay.
+// 
+//*******************************************************************************
+void Layers::GetLayerOrigin(int Layer, int* x, int* y) {
+	if (yposDir == 0) {
+		*y = (Yextent0 + LayerY[Layer]) - (LayerYsize[Layer] / 2);
+	}
+	else {
+		*y = (Yextent0 - LayerY[Layer]) - (LayerYsize[Layer] / 2);
+	}
+	*x = ((Xextent0 + LayerX[Layer]) - (LayerXsize[Layer] / 2));
+};
+
+//*******************************************************************************
+//
+//  void GetLayerBounds(int Layer, RECT* Bounds)
+// 
+// The overlay pixels inside of the layer at its current location.
+// Bounds is clipped to the overlay, it is empty if the layer is outside of the overlay.
+// 
+//*******************************************************************************
+void Layers::GetLayerBounds(int Layer, RECT* Bounds) {
+	int oRow;
+	int oOffset;
+
+	GetLayerOrigin(Layer, &oOffset, &oRow);
+
+	Bounds->left = max(oOffset, 0);
+	Bounds->right = min(oOffset + LayerXsize[Layer], ImageXextent);
+	Bounds->top = max(oRow, 0);
+	Bounds->bottom = min(oRow + LayerYsize[Layer], ImageYextent);
+	if (Bounds->left >= Bounds->right || Bounds->top >= Bounds->bottom) {
+		SetRectEmpty(Bounds);
+	}
+};
+
+//*******************************************************************************
+//
+//  void AddDirtyRect(const RECT* Rect)
+// 
+// Add a region of the overlay that has to be recomposited by UpdateOverlay()
+// When there are already MAX_DIRTY_RECTS regions, Rect is merged into the last one.
+// 
+//*******************************************************************************
+void Layers::AddDirtyRect(const RECT* Rect) {
+	if (IsRectEmpty(Rect)) {
+		return;
+	}
+	if (NumDirtyRects >= MAX_DIRTY_RECTS) {
+		UnionRect(&DirtyRects[MAX_DIRTY_RECTS - 1], &DirtyRects[MAX_DIRTY_RECTS - 1], Rect);
+		return;
+	}
+	DirtyRects[NumDirtyRects] = *Rect;
+	NumDirtyRects++;
+};
+
+//*******************************************************************************
+//
+//  int BuildCoverage(const RECT* Region)
+// 
+// Make the CoverageMask and FootprintMask of the overlay from the layer bitplanes
+// Only the pixels in Region are done.  All layers are included, enabled or not.
 // 
 // return
 // int					1	Success
 //						!=1	Standard application error number
 //
 //*******************************************************************************
-int Layers::UpdateOverlay(void) {
-	// process each layer
-	int oAddress;
+int Layers::BuildCoverage(const RECT* Region) {
+	RECT Bounds;
+	int oRow;
 	int oOffset;
-	int iAddress;
-	int ImageXsize;
-	int ImageYsize;
-	int Pixel;
-	int* Image;
+	const UINT64* Bits;
+	size_t BitPitch;
+	size_t Width = (size_t)(Region->right - Region->left);
+
+	for (int oy = Region->top; oy < Region->bottom; oy++) {
+		size_t Start = (size_t)oy * ImageXextent + Region->left;
+		memset(CoverageMask + Start, 0, Width);
+		memset(FootprintMask + Start, 0, Width);
+	}
+
+	for (int Layer = 0; Layer < NumLayers; Layer++) {
+		GetLayerBounds(Layer, &Bounds);
+		if (!IntersectRect(&Bounds, &Bounds, Region)) {
+			// layer is not in this region
+			continue;
+		}
+		Bits = LayerImage[Layer]->GetBitplane(0);
+		if (Bits == NULL) {
+			return APPERR_MEMALLOC;
+		}
+		BitPitch = LayerImage[Layer]->GetBitplanePitch();
+		BYTE LayerBit = (BYTE)(1 << Layer);
+
+		// overlay location of the layer's first row and column
+		if (yposDir == 0) {
+			oRow = (Yextent0 + LayerY[Layer]) - (LayerYsize[Layer] / 2);
+		}
+		else {
+			oRow = (Yextent0 - LayerY[Layer]) - (LayerYsize[Layer] / 2);
+		}
+		oOffset = ((Xextent0 + LayerX[Layer]) - (LayerXsize[Layer] / 2));
+
+		// columns of the overlay covered by the layer in this region
+		int xStart = Bounds.left;
+		int xEnd = Bounds.right;
 
-	union {
-		COLORREF Color;
-		RGBQUAD rgb;
-	} OverlayPixel;
+		for (int oy = Bounds.top; oy < Bounds.bottom; oy++) {
+			const UINT64* Row = Bits + (size_t)(oy - oRow) * BitPitch;
+			BYTE* Coverage = CoverageMask + (size_t)oy * ImageXextent;
+			BYTE* Footprint = FootprintMask + (size_t)oy * ImageXextent;
 
-	union {
-		COLORREF Color;
-		RGBQUAD rgb;
-	} NewColor;
+			OrBytes(Footprint + xStart, xEnd - xStart, LayerBit);
 
-	union {
-		COLORREF Color;
-		RGBQUAD rgb;
-	} iColor;
+			for (int w = xStart >> 6; w <= ((xEnd - 1) >> 6); w++) {
+				int x0 = w * 64;
+				UINT64 Mask = RangeMask(max(xStart - x0, 0), min(xEnd - x0, 64));
+				UINT64 L = GetLayerBits(Row, BitPitch, (LONGLONG)x0 - oOffset) & Mask;
+				if (L) {
+					OrRuns(Coverage + x0, L, LayerBit);
+				}
+			}
+		}
+	}
+
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  void BuildColorLUT(void)
+// 
+// Make the color lookup table from the layer colors and enables
+//	ColorLUT[CoverageMask]			color of a pixel with at least one set layer pixel
+//	ColorLUT[256 + FootprintMask]	color of a pixel with no set layer pixels
+// Layers that are not enabled, or are the overlay color, are not used.
+// Only used with COVERAGE_LAYERS or less layers, see BuildRemapLUT().
+// 
+//*******************************************************************************
+void Layers::BuildColorLUT(void) {
+	REMAPPIXEL Colors[REMAP_LAYERS] = { 0 };
+	BYTE Used = 0;
+
+	for (int Layer = 0; Layer < NumLayers && Layer < COVERAGE_LAYERS; Layer++) {
+		Colors[Layer] = LayerColor[Layer];
+		if (Enabled[Layer] && LayerColor[Layer] != rgbOverlayColor) {
+			Used |= (BYTE)(1 << Layer);
+		}
+	}
+
+	LUToverlayColor = BuildRemapLUT((REMAPPIXEL*)ColorLUT, Colors, Used,
+		rgbBackgroundColor, rgbOverlayColor) > 0;
+	LUTmask = Used;
+};
+
+//*******************************************************************************
+//
+//  void RemapRegion(const RECT* Region)
+// 
+// Recolor the pixels in Region of the overlay image from the coverage masks
+// using the current color lookup table
+// 
+//*******************************************************************************
+void Layers::RemapRegion(const RECT* Region) {
+	REMAPROW RemapRow = GetRemapRow();
+	int Count = Region->right - Region->left;
+
+	for (int oy = Region->top; oy < Region->bottom; oy++) {
+		size_t Start = (size_t)oy * ImageXextent + Region->left;
+		RemapRow((REMAPPIXEL*)(OverlayImage + Start), CoverageMask + Start, FootprintMask + Start,
+			Count, (const REMAPPIXEL*)ColorLUT, LUTmask);
+		if (LUToverlayColor) {
+			RemapOverlayColorRow((REMAPPIXEL*)(OverlayImage + Start), CoverageMask + Start,
+				FootprintMask + Start, Count, LUTmask, rgbBackgroundColor, rgbOverlayColor);
+		}
+	}
+};
 
-	int Colorsum;
+//*******************************************************************************
+//
+//  int CompositeDirect(const RECT* Region)
+// 
+// Composite the layers into Region of the overlay image one layer at a time,
+// without the coverage masks.  This is used when there are more than
+// COVERAGE_LAYERS layers.  The pixels are the same as from the masks.
+// 
+// return
+// int					1	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int Layers::CompositeDirect(const RECT* Region) {
+	RECT Bounds;
+	int oRow;
+	int oOffset;
+	const UINT64* Bits;
+	size_t BitPitch;
+	COLORREF Background = rgbBackgroundColor;
+	COLORREF OverlayColor = rgbOverlayColor;
+
+	for (int oy = Region->top; oy < Region->bottom; oy++) {
+		COLORREF* OverlayRow = OverlayImage + (size_t)oy * ImageXextent;
+		for (int x = Region->left; x < Region->right; x++) {
+			OverlayRow[x] = OverlayColor;
+		}
+	}
 
 	for (int Layer = 0; Layer < NumLayers; Layer++) {
-		ImageXsize = LayerXsize[Layer];
-		ImageYsize = LayerYsize[Layer];
-		Image = LayerImage[Layer];
-		if (!Enabled[Layer] || LayerColor[Layer] == rgbOverlayColor) {
+		if (!Enabled[Layer] || LayerColor[Layer] == OverlayColor) {
 			// if current layer is not enabled, do no add layer to overlay
 			// if current layer color is the overlay color, do not add layer to overlay
 			continue;
 		}
-		iColor.Color = LayerColor[Layer];
+		GetLayerBounds(Layer, &Bounds);
+		if (!IntersectRect(&Bounds, &Bounds, Region)) {
+			// layer is not in this region
+			continue;
+		}
+		Bits = LayerImage[Layer]->GetBitplane(0);
+		if (Bits == NULL) {
+			return APPERR_MEMALLOC;
+		}
+		BitPitch = LayerImage[Layer]->GetBitplanePitch();
+		COLORREF Color = LayerColor[Layer];
 
 		if (yposDir == 0) {
-			oAddress = ((Yextent0 + LayerY[Layer]) - (LayerYsize[Layer] / 2)) * ImageXextent;
+			oRow = (Yextent0 + LayerY[Layer]) - (LayerYsize[Layer] / 2);
 		}
 		else {
-			oAddress = ((Yextent0 - LayerY[Layer]) - (LayerYsize[Layer] / 2)) * ImageXextent;
+			oRow = (Yextent0 - LayerY[Layer]) - (LayerYsize[Layer] / 2);
 		}
+		oOffset = ((Xextent0 + LayerX[Layer]) - (LayerXsize[Layer] / 2));
+
+		int xStart = Bounds.left;
+		int xEnd = Bounds.right;
+
+		for (int oy = Bounds.top; oy < Bounds.bottom; oy++) {
+			const UINT64* Row = Bits + (size_t)(oy - oRow) * BitPitch;
+			COLORREF* OverlayRow = OverlayImage + (size_t)oy * ImageXextent;
+
+			for (int w = xStart >> 6; w <= ((xEnd - 1) >> 6); w++) {
+				int x0 = w * 64;
+				UINT64 Mask = RangeMask(max(xStart - x0, 0), min(xEnd - x0, 64));
+				UINT64 L = GetLayerBits(Row, BitPitch, (LONGLONG)x0 - oOffset) & Mask;
+				COLORREF* Overlay = OverlayRow + x0;
+
+				// layer pixel 0, overlay pixel becomes the background color if not already set
+				ForEachRun(Mask & ~L, [=](int First, int Count) {
+					for (int i = First; i < First + Count; i++) {
+						if (Overlay[i] == OverlayColor) {
+							Overlay[i] = Background;
+						}
+					}
+				});
+
+				// layer pixel set, set or mix the layer color
+				ForEachRun(L, [=](int First, int Count) {
+					for (int i = First; i < First + Count; i++) {
+						COLORREF Pixel = Overlay[i];
+						if (Pixel == Background || Pixel == OverlayColor) {
+							Overlay[i] = Color;
+						}
+						else {
+							Overlay[i] = MixColors(Pixel, Color);
+						}
+					}
+				});
+			}
+		}
+	}
 
-		iAddress = 0;
+	return APP_SUCCESS;
+};
 
-		for (int y = 0; y < ImageYsize;
-			 y++, iAddress += ImageXsize, oAddress += ImageXextent) {
+//*******************************************************************************
+//
+//  void CompositeTile(void* Context, int Tile)
+// 
+// ParallelFor() task, composite one tile of rows of a COMPOSITEJOB region
+// 
+//*******************************************************************************
+typedef struct {
+	Layers* Owner;
+	RECT Region;
+	int TileRows;			// rows per tile
+	BOOL Coverage;			// TRUE, overlay is kept as coverage masks
+	BOOL Build;				// TRUE, build the coverage masks before the colors
+	volatile LONG Result;	// first error from a tile
+} COMPOSITEJOB;
+
+void Layers::CompositeTile(void* Context, int Tile) {
+	COMPOSITEJOB* Job = (COMPOSITEJOB*)Context;
+	RECT Rows = Job->Region;
+	int iRes;
 
-			oOffset = ((Xextent0 + LayerX[Layer]) - (LayerXsize[Layer] / 2));
+	Rows.top = Job->Region.top + Tile * Job->TileRows;
+	Rows.bottom = min(Rows.top + Job->TileRows, (int)Job->Region.bottom);
 
-			for (int x = 0; x < ImageXsize; x++, oOffset++) {
-				Pixel = Image[iAddress + x];
-				OverlayPixel.Color = OverlayImage[oAddress+ oOffset];
-				if (Pixel == 0) {
-					// if pixel is already set ignore
-					if (OverlayPixel.Color != rgbBackgroundColor &&
-						OverlayPixel.Color != rgbOverlayColor) {
-						continue;
-					}
-					OverlayImage[oAddress + oOffset] = rgbBackgroundColor;
-				}
-				else {
-					// pixel is not zero
-					if (OverlayPixel.Color == rgbBackgroundColor ||
-						OverlayPixel.Color == rgbOverlayColor) {
-						// pixel was not previously set high
-						// set pixel to layer color
-						OverlayImage[oAddress + oOffset] = LayerColor[Layer];
-					}
-					else {
-						// pixel already set, add the 2 COLORREF values
-						Colorsum = (int)OverlayPixel.rgb.rgbRed*2/3 + (int)iColor.rgb.rgbRed*2/3;
-						if (Colorsum > 255) Colorsum = 255;
-						NewColor.rgb.rgbRed = Colorsum;
+	if (!Job->Coverage) {
+		iRes = Job->Owner->CompositeDirect(&Rows);
+		if (iRes != APP_SUCCESS) {
+			InterlockedCompareExchange(&Job->Result, iRes, APP_SUCCESS);
+		}
+		return;
+	}
 
-						Colorsum = (int)OverlayPixel.rgb.rgbGreen*2/3 + (int)iColor.rgb.rgbGreen*2/3;
-						if (Colorsum > 255) Colorsum = 255;
-						NewColor.rgb.rgbGreen = Colorsum;
+	if (Job->Build) {
+		iRes = Job->Owner->BuildCoverage(&Rows);
+		if (iRes != APP_SUCCESS) {
+			InterlockedCompareExchange(&Job->Result, iRes, APP_SUCCESS);
+			return;
+		}
+	}
+	Job->Owner->RemapRegion(&Rows);
+}
 
-						Colorsum = (int)OverlayPixel.rgb.rgbBlue*2/3 + (int)iColor.rgb.rgbBlue*2/3;
-						if (Colorsum > 255) Colorsum = 255;
-						NewColor.rgb.rgbBlue = Colorsum;
+//*******************************************************************************
+//
+//  int CompositeRegion(const RECT* Region, BOOL Build)
+// 
+// Composite Region of the overlay using the current color lookup table,
+// or directly from the layers when there are more than COVERAGE_LAYERS layers.
+// The region is split into tiles of rows that are done in parallel.
+// 
+// BOOL Build			TRUE, the coverage masks of the region are built first
+//						FALSE, only the colors are done (coverage masks only)
+// 
+// return
+// int					1	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int Layers::CompositeRegion(const RECT* Region, BOOL Build) {
+	int Width = Region->right - Region->left;
+	int Height = Region->bottom - Region->top;
+	BOOL Coverage = NumLayers <= COVERAGE_LAYERS;
 
-						OverlayImage[oAddress + oOffset] = NewColor.Color;
-					}
-				}
+	if (Width <= 0 || Height <= 0) {
+		return APP_SUCCESS;
+	}
+	if (Coverage && (CoverageMask == NULL || FootprintMask == NULL)) {
+		return APPERR_PARAMETER;
+	}
+
+	if (Build || !Coverage) {
+		// bitplanes are made the first time they are requested,
+		// make them before the tiles are started
+		for (int Layer = 0; Layer < NumLayers; Layer++) {
+			if (LayerImage[Layer]->GetBitplane(0) == NULL) {
+				return APPERR_MEMALLOC;
 			}
 		}
 	}
+
+	// tile size is OVERLAY_TILE_BYTES of overlay image and masks
+	int TileRows = OVERLAY_TILE_BYTES / (Width * (int)(sizeof(COLORREF) + 2));
+	if (TileRows < 1) {
+		TileRows = 1;
+	}
+	int NumTiles = (Height + TileRows - 1) / TileRows;
+
+	UnionRect(&ChangedRect, &ChangedRect, Region);
+
+	COMPOSITEJOB Job = { this, *Region, TileRows, Coverage, Build, APP_SUCCESS };
+	ParallelFor(NumTiles, CompositeTile, &Job);
+
+	return (int)Job.Result;
+};
+
+//*******************************************************************************
+//
+//  int RemapOverlay(void)
+// 
+// Recolor the overlay image from the coverage masks using the current
+// layer colors, enables, background and overlay colors.
+// This can be used instead of UpdateOverlay() when the layers, layer
+// locations and overlay size have not changed (IsCoverageValid()).
+// With more than COVERAGE_LAYERS layers the layers are composited again.
+// 
+// return
+// int					1	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int Layers::RemapOverlay(void) {
+	if (!IsCoverageValid()) {
+		return APPERR_PARAMETER;
+	}
+
+	if (OverlayValid && !ColorsChanged) {
+		// nothing to do
+		return APP_SUCCESS;
+	}
+
+	RECT Overlay = { 0, 0, ImageXextent, ImageYextent };
+	int iRes;
+
+	if (NumLayers <= COVERAGE_LAYERS) {
+		BuildColorLUT();
+	}
+	iRes = CompositeRegion(&Overlay, FALSE);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	ColorsChanged = FALSE;
 	OverlayValid = TRUE;
 
 	return APP_SUCCESS;
 };
 
+//*******************************************************************************
+//
+//  int UpdateOverlay(void)
+// 
+// This generates the overlay image from the current Layer configuration
+// 
+// If only layer locations have changed since the last update (SetLocation)
+// and the overlay size and origin are the same, only the regions of the
+// old and new layer locations are recomposited.
+// 
+// return
+// int					1	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int Layers::UpdateOverlay(void) {
+	int iRes;
+
+	if (OverlayImage == NULL) {
+		return APPERR_PARAMETER;
+	}
+
+	RECT Overlay = { 0, 0, ImageXextent, ImageYextent };
+
+	if (NumLayers <= COVERAGE_LAYERS) {
+		if (CoverageMask == NULL || FootprintMask == NULL) {
+			// overlay was created with more layers
+			size_t OverlaySize = (size_t)ImageXextent * (size_t)ImageYextent;
+			delete[] CoverageMask;
+			delete[] FootprintMask;
+			CoverageMask = new BYTE[OverlaySize];
+			FootprintMask = new BYTE[OverlaySize];
+			CoverageValid = FALSE;
+			if (CoverageMask == NULL || FootprintMask == NULL) {
+				return APPERR_MEMALLOC;
+			}
+		}
+		BuildColorLUT();
+	}
+
+	if (!CoverageValid) {
+		// whole overlay
+		NumDirtyRects = 0;
+		iRes = CompositeRegion(&Overlay, TRUE);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		CoverageValid = TRUE;
+		ColorsChanged = FALSE;
+		OverlayValid = TRUE;
+		return APP_SUCCESS;
+	}
+
+	// only the dirty regions
+	for (int i = 0; i < NumDirtyRects; i++) {
+		iRes = CompositeRegion(&DirtyRects[i], TRUE);
+		if (iRes != APP_SUCCESS) {
+			CoverageValid = FALSE;
+			return iRes;
+		}
+	}
+	NumDirtyRects = 0;
+
+	if (ColorsChanged) {
+		// colors or enables changed as well, recolor the whole overlay
+		iRes = CompositeRegion(&Overlay, FALSE);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		ColorsChanged = FALSE;
+	}
+	OverlayValid = TRUE;
+
+	return APP_SUCCESS;
+};
+
+//*******************************************************************************
+//
+//  BOOL IsCoverageValid(void)
+// 
+// return
+// BOOL					TRUE, the overlay matches the current layers, layer
+//						locations and overlay size.  RemapOverlay() can be
+//						used to apply color and enable changes.
+//
+//*******************************************************************************
+BOOL Layers::IsCoverageValid(void) {
+	return OverlayImage != NULL && CoverageValid && NumDirtyRects == 0;
+};
+
 //*******************************************************************************
 //
 //  int GetNewOverlaySize(int* x, int* y)
@@ -362,6 +1042,10 @@ int Layers::GetNewOverlaySize(int* x, int* y) {
 	// Index where 0,0 is in the ImageExtent
 	// This is needed to porperly insert and image
 	// relative to the othe images
+	if (Xextent0 != -xmin || Yextent0 != -ymin) {
+		// layers are at new locations in the overlay
+		CoverageValid = FALSE;
+	}
 	Xextent0 = (-xmin);
 	Yextent0 = (-ymin);
 
@@ -492,15 +1176,18 @@ int Layers::SaveConfiguration() {
 // int					APP_SUCESS,	Success
 //						APPERR_FILESIZE, not all layers successfully loaded
 //						APPERR_FILEOPEN, configuration file could not be read
+//						APPERR_CANCEL, cancelled by the load progress function
 //
 //*******************************************************************************
 int Layers::LoadConfiguration(WCHAR* Filename) {
-	// Save all this
-	WCHAR szString[MAX_PATH];
-	WCHAR AppName[MAX_PATH];
 	int  iRes;
-	int TotalLayers;
-	int LayerCount;
+
+	// keep the current layer images until the new layers are loaded
+	// unchanged files are then shared from the image cache, not loaded again
+	std::vector<ImageBuffer*> OldImages(LayerImage);
+	for (size_t i = 0; i < OldImages.size(); i++) {
+		AddImageRef(OldImages[i]);
+	}
 
 	ReleaseOverlay();
 	// release all current layers
@@ -508,6 +1195,39 @@ int Layers::LoadConfiguration(WCHAR* Filename) {
 		ReleaseLayer(i);
 	}
 
+	iRes = LoadLayers(Filename);
+
+	for (size_t i = 0; i < OldImages.size(); i++) {
+		ReleaseImage(OldImages[i]);
+	}
+	return iRes;
+};
+
+//*******************************************************************************
+//
+//  int LoadLayers(WCHAR* Filename)
+// 
+// This loads the Layer settings and layers from a cfg file
+//
+// WCHAR* Filename		Load conifiguration from this file
+// 
+// return
+// int					APP_SUCESS,	Success
+//						APPERR_FILESIZE, not all layers successfully loaded
+//						APPERR_FILEOPEN, configuration file could not be read
+//						APPERR_CANCEL, cancelled by the load progress function
+//
+//*******************************************************************************
+int Layers::LoadLayers(WCHAR* Filename) {
+	WCHAR szString[MAX_PATH];
+	WCHAR AppName[MAX_PATH];
+	int  iRes;
+	int TotalLayers;
+	int LayerCount;
+	LAYERLOAD* Loads;
+	LAYERLOADJOB Job;
+	LARGE_INTEGER Start;
+
 	TotalLayers = GetPrivateProfileInt(L"Layers", L"NumLayers", -1, Filename);
 	if (TotalLayers == -1) {
 		return APPERR_FILEOPEN;
@@ -523,18 +1243,85 @@ int Layers::LoadConfiguration(WCHAR* Filename) {
 	minOverlaySizeX = GetPrivateProfileInt(L"Layers", L"minOverlaySizeX", 512, Filename);
 	minOverlaySizeY = GetPrivateProfileInt(L"Layers", L"minOverlaySizeY", 512, Filename);
 
-	LayerCount = 0;
+	wcscpy_s(ConfigurationFile, MAX_PATH, Filename);
+
+	if (TotalLayers <= 0) {
+		return APP_SUCCESS;
+	}
+
+	Loads = new LAYERLOAD[TotalLayers];
+	if (Loads == NULL) {
+		return APPERR_MEMALLOC;
+	}
+
+	// get the layer files, a file used by more than one layer is only loaded once
 	for (int i = 0; i < TotalLayers; i++) {
 		swprintf_s(AppName, MAX_PATH, L"Layers-%d", i);
+		GetPrivateProfileString(AppName, L"LayerFilename", L"", Loads[i].Filename, MAX_PATH, Filename);
+		Loads[i].Duplicate = -1;
+		Loads[i].Image = NULL;
+		Loads[i].Result = APPERR_FILEOPEN;
+		Loads[i].LoadTime = 0.0;
+		for (int j = 0; j < i; j++) {
+			if (Loads[j].Duplicate < 0 && _wcsicmp(Loads[i].Filename, Loads[j].Filename) == 0) {
+				Loads[i].Duplicate = j;
+				break;
+			}
+		}
+	}
 
-		GetPrivateProfileString(AppName, L"LayerFilename",L"", szString, MAX_PATH, Filename);
+	// load the files in parallel
+	Job.Loads = Loads;
+	Job.Total = TotalLayers;
+	Job.Progress = LoadProgress;
+	Job.ProgressContext = LoadProgressContext;
+	Job.Done = 0;
+	Job.Cancel = FALSE;
+
+	QueryPerformanceCounter(&Start);
+	ParallelFor(TotalLayers, LoadLayerTask, &Job);
+
+	if (Job.Cancel) {
+		for (int i = 0; i < TotalLayers; i++) {
+			if (Loads[i].Result == APP_SUCCESS) {
+				ReleaseImage(Loads[i].Image);
+			}
+		}
+		delete[] Loads;
+		OutputDebugString(L"MySETIviewer: loading layer files cancelled\n");
+		return APPERR_CANCEL;
+	}
+
+	swprintf_s(szString, MAX_PATH, L"MySETIviewer: %d layer files loaded in %.1f ms\n",
+		TotalLayers, ElapsedTime(&Start));
+	OutputDebugString(szString);
+
+	// add the layers in configuration order
+	LayerCount = 0;
+	for (int i = 0; i < TotalLayers; i++) {
+		if (Loads[i].Duplicate >= 0) {
+			// already in the cache if the earlier entry loaded
+			QueryPerformanceCounter(&Start);
+			Loads[i].Result = AcquireImage(Loads[i].Filename, &Loads[i].Image);
+			Loads[i].LoadTime = ElapsedTime(&Start);
+		}
+
+		swprintf_s(szString, MAX_PATH, L"MySETIviewer: layer %d, %.1f ms, result %d\n",
+			i, Loads[i].LoadTime, Loads[i].Result);
+		OutputDebugString(szString);
+
+		if (Loads[i].Result != APP_SUCCESS) {
+			continue;
+		}
 		// initially added as a new layer
-		iRes = AddLayer(szString);
+		iRes = AddLayerImage(Loads[i].Filename, Loads[i].Image, Loads[i].LoadTime);
 		if (iRes != APP_SUCCESS) {
+			ReleaseImage(Loads[i].Image);
 			continue;
 		}
 
 		// then update the color, and x,y positions
+		swprintf_s(AppName, MAX_PATH, L"Layers-%d", i);
 		LayerColor[LayerCount] = GetPrivateProfileInt(AppName, L"LayerColor", 1, Filename);
 
 		LayerX[LayerCount] = GetPrivateProfileInt(AppName, L"LayerX", 0, Filename);
@@ -545,7 +1332,7 @@ int Layers::LoadConfiguration(WCHAR* Filename) {
 		LayerCount++;
 	}
 
-	wcscpy_s(ConfigurationFile, MAX_PATH, Filename);
+	delete[] Loads;
 
 	if (LayerCount != TotalLayers) {
 		// failed to load all layers
@@ -554,6 +1341,22 @@ int Layers::LoadConfiguration(WCHAR* Filename) {
 	return APP_SUCCESS;
 };
 
+//*******************************************************************************
+//
+//  void SetLoadProgress(LOADPROGRESS Progress, void* Context)
+// 
+// Set the function called as the layer files are loaded by LoadConfiguration()
+// The function can cancel the load, LoadConfiguration() then returns APPERR_CANCEL
+//
+// LOADPROGRESS Progress	progress function, NULL for none
+// void* Context			passed to the progress function
+//
+//*******************************************************************************
+void Layers::SetLoadProgress(LOADPROGRESS Progress, void* Context) {
+	LoadProgress = Progress;
+	LoadProgressContext = Context;
+};
+
 //*******************************************************************************
 //
 //  int Layers::GetSize(int Layer, int* x, int* y)
@@ -571,6 +1374,23 @@ int Layers::GetSize(int Layer, int* x, int* y) {
 	return APP_SUCCESS;
 };
 
+//*******************************************************************************
+//
+//  double Layers::GetLoadTime(int Layer)
+// 
+// This returns the time it took to load the image file of the layer
+//
+// return
+// double				milliseconds, 0 if the layer # is not valid
+//
+//*******************************************************************************
+double Layers::GetLoadTime(int Layer) {
+	if (Layer < 0 || Layer >= NumLayers) {
+		return 0.0;
+	}
+	return LayerLoadTime[Layer];
+};
+
 //*******************************************************************************
 //
 //  int Layers::GetLocation(int Layer, int* x, int* y)
@@ -601,6 +1421,16 @@ int Layers::SetLocation(int Layer, int x, int y) {
 		return APPERR_PARAMETER;
 	}
 	
+	if (CoverageValid && (LayerX[Layer] != x || LayerY[Layer] != y)) {
+		// the old and new layer locations have to be recomposited
+		RECT Bounds;
+		GetLayerBounds(Layer, &Bounds);
+		AddDirtyRect(&Bounds);
+		LayerX[Layer] = x;
+		LayerY[Layer] = y;
+		GetLayerBounds(Layer, &Bounds);
+		AddDirtyRect(&Bounds);
+	}
 	LayerX[Layer] = x;
 	LayerY[Layer] = y;
 
@@ -618,6 +1448,36 @@ int Layers::GetNumLayers(void) {
 	return NumLayers;
 };
 
+//*******************************************************************************
+//
+//  int Layers::GetLayerHandle(int Layer)
+// 
+// This returns the handle of a layer, -1 if the layer # is not valid
+// A layer keeps its handle when other layers are added or released.
+//
+//*******************************************************************************
+int Layers::GetLayerHandle(int Layer) {
+	if (Layer < 0 || Layer >= NumLayers) {
+		return -1;
+	}
+	return LayerHandle[Layer];
+};
+
+//*******************************************************************************
+//
+//  int Layers::GetLayerFromHandle(int Handle)
+// 
+// This returns the current layer # of a layer handle,
+// -1 if the handle is not valid or the layer was released
+//
+//*******************************************************************************
+int Layers::GetLayerFromHandle(int Handle) {
+	if (Handle < 0 || Handle >= (int)HandleLayer.size()) {
+		return -1;
+	}
+	return HandleLayer[Handle];
+};
+
 //*******************************************************************************
 //
 //  int Layers::SetCurrentLayer(int Layer)
@@ -668,6 +1528,9 @@ COLORREF Layers::GetBackgroundColor(void) {
 //
 //*******************************************************************************
 void Layers::SetBackgroundColor(COLORREF Color) {
+	if (rgbBackgroundColor != Color) {
+		ColorsChanged = TRUE;
+	}
 	rgbBackgroundColor = Color;
 };
 
@@ -712,6 +1575,9 @@ COLORREF Layers::GetOverlayColor(void) {
 //
 //*******************************************************************************
 void Layers::SetOverlayColor(COLORREF Color) {
+	if (rgbOverlayColor != Color) {
+		ColorsChanged = TRUE;
+	}
 	rgbOverlayColor = Color;
 };
 
@@ -738,6 +1604,9 @@ int Layers::SetLayerColor(int Layer, COLORREF Color) {
 		return APPERR_PARAMETER;
 	}
 
+	if (LayerColor[Layer] != Color) {
+		ColorsChanged = TRUE;
+	}
 	LayerColor[Layer] = Color;
 	return APP_SUCCESS;
 };
@@ -753,6 +1622,9 @@ int Layers::DisableLayer(int Layer) {
 	if (Layer < 0 || Layer >= NumLayers) {
 		return APPERR_PARAMETER;
 	}
+	if (Enabled[Layer]) {
+		ColorsChanged = TRUE;
+	}
 	Enabled[Layer] = FALSE;
 	return APP_SUCCESS;
 };
@@ -768,6 +1640,9 @@ int Layers::EnableLayer(int Layer) {
 	if (Layer < 0 || Layer >= NumLayers) {
 		return APPERR_PARAMETER;
 	}
+	if (!Enabled[Layer]) {
+		ColorsChanged = TRUE;
+	}
 	Enabled[Layer] = TRUE;
 	return APP_SUCCESS;
 };
@@ -826,6 +1701,10 @@ void Layers::GetMinOverlaySize(int*x, int* y) {
 // 
 //*******************************************************************************
 void Layers::SetMinOverlaySize(int x, int y) {
+	if (minOverlaySizeX != x || minOverlaySizeY != y) {
+		// overlay size may change
+		CoverageValid = FALSE;
+	}
 	minOverlaySizeX = x;
 	minOverlaySizeY = y;
 };
@@ -864,6 +1743,88 @@ int Layers::GetOverlayImage(COLORREF** Image, int* xsize, int* ysize)
 	return APP_SUCCESS;
 }
 
+//*******************************************************************************
+//
+//  void GetChangedRect(RECT* Changed)
+// 
+// Get the region of the overlay image that has been composited since the
+// last call, the region is then cleared.
+// 
+// RECT* Changed			returns the changed region, empty if nothing changed
+// 
+//*******************************************************************************
+void Layers::GetChangedRect(RECT* Changed)
+{
+	*Changed = ChangedRect;
+	SetRectEmpty(&ChangedRect);
+}
+
+//*******************************************************************************
+//
+//  int GetLayersAt(int x, int y, LAYERPIXEL* Pixels, int MaxPixels)
+// 
+// Get the enabled layers under an overlay pixel and their pixel values,
+// in overlay order.  This is quick enough to use on every mouse move:
+// with COVERAGE_LAYERS or less layers the footprint mask of the pixel gives
+// the layers, otherwise the layer bounds are checked.  The layer bounds are
+// also checked when the pixel is in a region that has not been recomposited
+// since a layer was moved.
+// 
+// int x, y					overlay pixel
+// LAYERPIXEL* Pixels		returns the layers
+// int MaxPixels			size of Pixels
+// 
+// return
+// int						# of layers returned in Pixels, 0 if none
+// 
+//*******************************************************************************
+int Layers::GetLayersAt(int x, int y, LAYERPIXEL* Pixels, int MaxPixels)
+{
+	int Count = 0;
+	BYTE Footprint = 0xff;
+
+	if (OverlayImage == NULL || x < 0 || x >= ImageXextent || y < 0 || y >= ImageYextent) {
+		return 0;
+	}
+	if (CoverageValid && FootprintMask != NULL && NumLayers <= COVERAGE_LAYERS) {
+		// the footprint mask is out of date inside of the regions waiting to be recomposited
+		POINT Point = { x, y };
+		BOOL Dirty = FALSE;
+		for (int i = 0; i < NumDirtyRects; i++) {
+			if (PtInRect(&DirtyRects[i], Point)) {
+				Dirty = TRUE;
+				break;
+			}
+		}
+		if (!Dirty) {
+			Footprint = FootprintMask[(size_t)y * ImageXextent + x];
+		}
+	}
+
+	for (int Layer = 0; Layer < NumLayers && Count < MaxPixels; Layer++) {
+		int oOffset, oRow;
+
+		if (Layer < COVERAGE_LAYERS && !(Footprint & (1 << Layer))) {
+			continue;
+		}
+		if (!Enabled[Layer]) {
+			continue;
+		}
+		GetLayerOrigin(Layer, &oOffset, &oRow);
+		int lx = x - oOffset;
+		int ly = y - oRow;
+		if (lx < 0 || lx >= LayerXsize[Layer] || ly < 0 || ly >= LayerYsize[Layer]) {
+			continue;
+		}
+		Pixels[Count].Layer = Layer;
+		Pixels[Count].x = lx;
+		Pixels[Count].y = ly;
+		LayerImage[Layer]->GetPixel(0, lx, ly, &Pixels[Count].Value);
+		Count++;
+	}
+	return Count;
+}
+
 //*******************************************************************************
 //
 //  int GetYdir()
@@ -23,26 +23,76 @@
 // 
 // V1.0.1.0	2023-12-20	Initial release
 // V1.0.2.0 2023-12-20  Added Y direction flag for which direction to move image
+// V1.2.0   2026-10-17  Layer images are held in ImageBuffer objects (memory mapped image files)
+// V1.2.2   2026-10-17  Added overlay bitplanes for word parallel compositing
+// V1.2.3   2026-10-17  Overlay bitplanes replaced by layer coverage masks and color lookup tables
+// V1.2.4   2026-10-17  Added dirty rectangles of the overlay for moved layers
+// V1.2.5   2026-10-17  Color lookup tables combined into one table for the row kernels
+// V1.2.6   2026-10-17  Overlay is composited in parallel tiles
+// V1.2.7   2026-10-17  No limit on the number of layers, layer arrays are vectors,
+//                      added layer handles
+// V1.2.8   2026-10-17  Layer images are shared through the image cache
+// V1.2.9   2026-10-17  Layer files of a configuration are loaded in parallel,
+//                      added layer load times
+// V1.2.10  2026-10-17  Added load progress callback, loading can be cancelled
+// V1.2.16  2026-10-17  Added the changed region of the overlay
+// V1.2.17  2026-10-17  Added the layer pixels under an overlay pixel
+// V1.2.24  2026-10-17  Added LUToverlayColor, set pixels mixed to the overlay color
 //
 #include "framework.h"
-
-#define MAX_LAYERS 8
+#include <vector>
+#include "ImageBuffer.h"
+
+// the overlay is kept as coverage masks when there are this many layers or less
+// one bit per layer in a BYTE
+#define COVERAGE_LAYERS 8
+#define MAX_DIRTY_RECTS 8
+// bytes of overlay image and masks in each tile when compositing
+#define OVERLAY_TILE_BYTES (256*1024)
+
+// Called by LoadConfiguration() as each layer file is loaded, it can be called
+// from more than one thread at the same time.
+// Done is the # of files loaded so far, Total is the # of layers in the configuration
+// return FALSE to cancel loading the rest of the files
+typedef BOOL (*LOADPROGRESS)(void* Context, int Done, int Total);
+
+// a layer under an overlay pixel, see GetLayersAt()
+typedef struct {
+	int Layer;		// layer #
+	int x;			// pixel in the layer image
+	int y;
+	int Value;		// layer pixel value
+} LAYERPIXEL;
 
 class Layers {
 private:
 	// variables
-	int* LayerImage[MAX_LAYERS] = { NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL };
-	int LayerXsize[MAX_LAYERS] = { 0,0,0,0,0,0,0,0 };
-	int LayerYsize[MAX_LAYERS] = { 0,0,0,0,0,0,0,0 };
-	COLORREF LayerColor[MAX_LAYERS] = { 0,0,0,0,0,0,0,0 }; // color to use for layer when pixel != 0
-	int LayerX[MAX_LAYERS] = { 0,0,0,0,0,0,0,0 };
-	int LayerY[MAX_LAYERS] = { 0,0,0,0,0,0,0,0 };
-	BOOL Enabled[MAX_LAYERS] = { FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE };
+	// layers, one entry in each vector per layer in overlay order
+	std::vector<ImageBuffer*> LayerImage;
+	std::vector<int> LayerXsize;
+	std::vector<int> LayerYsize;
+	std::vector<COLORREF> LayerColor; // color to use for layer when pixel != 0
+	std::vector<int> LayerX;
+	std::vector<int> LayerY;
+	std::vector<BOOL> Enabled;
+	std::vector<int> LayerHandle;	// handle of the layer, it doesn't change when layers are released
+	std::vector<int> HandleLayer;	// layer # of a handle, -1 if the layer was released
+	std::vector<double> LayerLoadTime;	// time to load the layer file, milliseconds
 
 	COLORREF rgbBackgroundColor = 0; // color used for Layer backgrounds when pixel is 0
 	COLORREF rgbOverlayColor = 0; // color used for overlay background
 	COLORREF rgbDefaultLayerColor = 0;
 	COLORREF* OverlayImage = NULL;
+	BYTE* CoverageMask = NULL;		// bit per layer, layer pixel is set
+	BYTE* FootprintMask = NULL;		// bit per layer, pixel is inside of the layer
+	BOOL CoverageValid = FALSE;		// overlay matches the layers, locations and overlay size
+	BOOL ColorsChanged = TRUE;		// colors or enables changed since the overlay was colored
+	COLORREF ColorLUT[512] = { 0 };		// overlay color from CoverageMask, or 256 + FootprintMask
+	BYTE LUTmask = 0;				// layers used in the lookup tables
+	BOOL LUToverlayColor = FALSE;	// a ColorLUT[CoverageMask] color is the overlay color
+	RECT DirtyRects[MAX_DIRTY_RECTS] = { 0 };	// overlay regions to recomposite
+	int NumDirtyRects = 0;
+	RECT ChangedRect = { 0 };		// overlay region composited since GetChangedRect()
 
 	int NumLayers = 0;
 	int CurrentLayer = 0;
@@ -54,9 +104,24 @@ private:
 	int minOverlaySizeY = 512;
 	int yposDir = 0;
 
+	LOADPROGRESS LoadProgress = NULL;
+	void* LoadProgressContext = NULL;
+
+	void GetLayerOrigin(int Layer, int* x, int* y);
+	void GetLayerBounds(int Layer, RECT* Bounds);
+	void AddDirtyRect(const RECT* Rect);
+	int BuildCoverage(const RECT* Region);
+	void BuildColorLUT(void);
+	void RemapRegion(const RECT* Region);
+	int CompositeDirect(const RECT* Region);
+	int AddLayerImage(WCHAR* Filename, ImageBuffer* Image, double LoadTime);
+	int LoadLayers(WCHAR* Filename);
+	int CompositeRegion(const RECT* Region, BOOL Build);
+	static void CompositeTile(void* Context, int Tile);
+
 public:
 	// variables
-	WCHAR* LayerFilename[MAX_LAYERS] = { NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL };
+	std::vector<WCHAR*> LayerFilename;
 	WCHAR ConfigurationFile[MAX_PATH] = L"";
 
 	BOOL OverlayValid = FALSE;
@@ -74,18 +139,24 @@ public:
 	int CreateOverlay(int xsize,int ysize);
 	int ReleaseOverlay(void);
 	int UpdateOverlay(void);
+	int RemapOverlay(void);
+	BOOL IsCoverageValid(void);
 	int GetNewOverlaySize(int* x, int* y);
 	int GetCurrentOverlaySize(int* x, int* y);
 
 	int SaveConfiguration(void);
 	int SaveConfiguration(WCHAR* Filename);
 	int LoadConfiguration(WCHAR* Filename);
+	void SetLoadProgress(LOADPROGRESS Progress, void* Context);
 
 	int GetNumLayers(void);
+	int GetLayerHandle(int Layer);
+	int GetLayerFromHandle(int Handle);
 	int SetCurrentLayer(int LayerNumber);
 	int GetCurrentLayer(void);
 
 	int GetSize(int Layer, int* x, int* y);
+	double GetLoadTime(int Layer);
 	int GetLocation(int Layer, int* x, int* y);
 	int SetLocation(int Layer, int x, int y);
 
@@ -113,6 +184,8 @@ public:
 
 
 	int GetOverlayImage(COLORREF** OverlayImage, int* xsize, int* ysize);
+	void GetChangedRect(RECT* Changed);
+	int GetLayersAt(int x, int y, LAYERPIXEL* Pixels, int MaxPixels);
 
 	int SaveBMP(WCHAR* Filename);
 
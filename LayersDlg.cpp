@@ -26,6 +26,13 @@
 //                      Added ID_UPDATE to allow menu command to casue the Layers dialog
 //                      update the entire dialog
 //                      Added window position update
+// V1.2.3   2026-10-17  ApplyLayers only remaps the overlay colors when the layer
+//                      locations and overlay size are unchanged
+// V1.2.4   2026-10-17  ApplyLayers reuses the overlay image when its size is unchanged
+// V1.2.5   2026-10-17  Removed the max layers check, there is no layer limit
+// V1.2.16  2026-10-17  Only the changed region of the overlay is updated in the display
+// V1.2.24  2026-10-17  ID_UPDATE reloads the minimum overlay size fields, ApplyLayers
+//                      used the values from WM_INITDIALOG after a background load
 //  
 // Global Settings dialog box handler
 // 
@@ -56,6 +63,7 @@ int ReplaceListBoxEntry(HWND hDlg, int Control, int Selection, WCHAR* szString);
 void SetCurrentLayerSettings(HWND hDlg, int Layer);
 void LoadLayerList(HWND hDlg, int CurrentLayer);
 void DeleteAllLayers(HWND hDlg);
+void LoadMinOverlaySize(HWND hDlg);
 
 void ApplyLayers(HWND hDlg);
 
@@ -82,20 +90,7 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
         CurrentLayer = ImageLayers->GetCurrentLayer();
         
         // set minimum size for overlay order image
-        {
-            int x, y;
-            ImageLayers->GetMinOverlaySize(&x, &y);
-            SetDlgItemInt(hDlg, IDC_LAYERS_MIN_X, x, TRUE);
-            SetDlgItemInt(hDlg, IDC_LAYERS_MIN_Y, y, TRUE);
-        }
-
-        // set minimum size for overlay order image
-        {
-            int x, y;
-            ImageLayers->GetMinOverlaySize(&x, &y);
-            SetDlgItemInt(hDlg, IDC_LAYERS_MIN_X, x, TRUE);
-            SetDlgItemInt(hDlg, IDC_LAYERS_MIN_Y, y, TRUE);
-        }
+        LoadMinOverlaySize(hDlg);
 
         LoadLayerList(hDlg, CurrentLayer);
         SetCurrentLayerSettings(hDlg, CurrentLayer);
@@ -247,11 +242,6 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
 
         case IDC_ADD_LAYER:
         {
-            if (ImageLayers->GetNumLayers() >= MAX_LAYERS) {
-                MessageBox(hDlg, L"Max layers reached", L"Layers", MB_OK);
-                break;
-            }
-
             PWSTR pszFilename;
             COMDLG_FILTERSPEC AllType[] =
             {
@@ -615,6 +605,8 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
 
         case ID_UPDATE:
         {
+            // the layers may have been replaced, ApplyLayers() uses these fields
+            LoadMinOverlaySize(hDlg);
             LoadLayerList(hDlg, ImageLayers->GetCurrentLayer());
             SetCurrentLayerSettings(hDlg, ImageLayers->GetCurrentLayer());
             if (LOWORD(lParam)) {
@@ -756,6 +748,22 @@ void DeleteAllLayers(HWND hDlg)
     return;
 }
 
+//*******************************************************************************
+//
+// Helper function for SettingsLayerDlg dialog box.
+// Set the minimum overlay size fields from the layers
+// 
+//*******************************************************************************
+void LoadMinOverlaySize(HWND hDlg)
+{
+    int x, y;
+
+    ImageLayers->GetMinOverlaySize(&x, &y);
+    SetDlgItemInt(hDlg, IDC_LAYERS_MIN_X, x, TRUE);
+    SetDlgItemInt(hDlg, IDC_LAYERS_MIN_Y, y, TRUE);
+    return;
+}
+
 //*******************************************************************************
 //
 // Helper function for SettingsLayerDlg dialog box.
@@ -856,6 +864,7 @@ void SetCurrentLayerSettings(HWND hDlg, int Layer)
 void ApplyLayers(HWND hDlg)
 {
     int xnewsize, ynewsize;
+    int xsize, ysize;
     int iRes;
     int x, y;
     int Xsize, Ysize;
@@ -890,21 +899,32 @@ void ApplyLayers(HWND hDlg)
     ImageLayers->SetLocation(ImageLayers->GetCurrentLayer(), x, y);
     ImageLayers->SetMinOverlaySize(Xsize, Ysize);
 
-    iRes = ImageLayers->GetNewOverlaySize(&xnewsize, &ynewsize);
-    if (iRes != APP_SUCCESS) {
-        MessageBox(hDlg, L"Creating Overlay image failed", L"Layers", MB_OK);
-        return;
-    }
-    iRes = ImageLayers->ReleaseOverlay();
-    iRes = ImageLayers->CreateOverlay(xnewsize, ynewsize);
-    if (iRes != APP_SUCCESS) {
-        return;
+    if (ImageLayers->IsCoverageValid()) {
+        // layers, locations and overlay size are unchanged
+        // only colors and enables need to be applied
+        iRes = ImageLayers->RemapOverlay();
     }
+    else {
+        iRes = ImageLayers->GetNewOverlaySize(&xnewsize, &ynewsize);
+        if (iRes != APP_SUCCESS) {
+            MessageBox(hDlg, L"Creating Overlay image failed", L"Layers", MB_OK);
+            return;
+        }
+        ImageLayers->GetCurrentOverlaySize(&xsize, &ysize);
+        if (xsize != xnewsize || ysize != ynewsize) {
+            // overlay size changed, a new overlay image is needed
+            iRes = ImageLayers->ReleaseOverlay();
+            iRes = ImageLayers->CreateOverlay(xnewsize, ynewsize);
+            if (iRes != APP_SUCCESS) {
+                return;
+            }
+        }
 
-    iRes = ImageLayers->UpdateOverlay();
+        // only the moved layers are recomposited if the overlay is reused
+        iRes = ImageLayers->UpdateOverlay();
+    }
 
     COLORREF* Overlay;
-    int xsize, ysize;
 
     iRes = ImageLayers->GetOverlayImage(&Overlay, &xsize, &ysize);
     if (iRes == APP_SUCCESS) {
@@ -915,7 +935,11 @@ void ApplyLayers(HWND hDlg)
             MessageMySETIviewerError(hDlg, iRes, L"Display 0 gap parameter");
             return;
         }
-        iRes = Displays->UpdateDisplay(Overlay, xsize, ysize);
+        // the display keeps what it has of the overlay outside of the changed region
+        RECT Changed;
+        ImageLayers->GetChangedRect(&Changed);
+        Displays->SetEmptyColors(ImageLayers->GetBackgroundColor(), ImageLayers->GetOverlayColor());
+        iRes = Displays->UpdateDisplay(Overlay, xsize, ysize, &Changed);
         if (hwndImage != NULL) {
             PostMessage(hwndImage, WM_COMMAND, IDC_GENERATE_BMP, 0l);
             ShowWindow(hwndImage, SW_SHOW);
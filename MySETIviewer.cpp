@@ -80,6 +80,12 @@
 //                          Reset Zoom
 //                          Close
 //                      Changed Image Window, does not close with ESC or Enter keys
+// V1.2.7   2026-10-17  Cached layer images are released on exit
+// V1.2.10  2026-10-17  The last configuration is loaded in the background at startup,
+//                      with progress in the title bar and File->Cancel loading
+//                      Startup time is logged in MySETIviewer.log
+// V1.2.15  2026-10-17  Display->Save BMP creates a virtual display for the save
+// V1.2.24  2026-10-17  Added /benchmark command line option when built with MYSETI_BENCHMARK
 // 
 //  This appliction stores user parameters in a Windows style .ini file
 //  The MySETIviewer.ini file must be in the same directory as the exectable
@@ -106,6 +112,9 @@
 #include "AppFunctions.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
+#include "ImageCache.h"
+#include "BackgroundLoad.h"
+#include "Benchmark.h"
 
 #define MAX_LOADSTRING 100
 
@@ -154,10 +163,16 @@ CString strAppNameINI;
 //  needed to do things like check or uncheck a menu item in the main app
 HWND hwndMain = NULL;
 
+// startup timing
+LARGE_INTEGER StartupCounter;   // when the application started
+double WindowReadyTime = 0.0;   // milliseconds until the windows were created
+
 // Forward declarations of functions included in this code module:
 ATOM                MyRegisterClass(HINSTANCE hInstance);
 BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
+double              StartupElapsedTime(void);
+void                LogStartupTime(double LoadTime, int NumLayers, int Result);
 
 // Declaration for callback dialog procedures in other modules
 INT_PTR CALLBACK    AboutDlg(HWND, UINT, WPARAM, LPARAM);
@@ -181,6 +196,20 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
 
+    QueryPerformanceCounter(&StartupCounter);
+
+#ifdef MYSETI_BENCHMARK
+    // MySETIviewer.exe /benchmark [report file]
+    // runs the benchmarks without starting the user interface
+    if (wcsncmp(lpCmdLine, L"/benchmark", 10) == 0) {
+        WCHAR* ReportFilename = lpCmdLine + 10;
+        while (*ReportFilename == L' ') {
+            ReportFilename++;
+        }
+        return RunBenchmarks(ReportFilename);
+    }
+#endif
+
     HeapSetInformation(NULL, HeapEnableTerminationOnCorruption, NULL, 0);
 
     // 
@@ -395,28 +424,87 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
 
    hwndDisplay = CreateDialog(hInst, MAKEINTRESOURCE(IDD_SETTINGS_DISPLAY), hWnd, SettingsDisplayDlg);
 
+   wcscpy_s(ImageLayers->ConfigurationFile, MAX_PATH, L"");
+
+   hwndLayers = CreateDialog(hInst, MAKEINTRESOURCE(IDD_SETTINGS_LAYERS), hWnd, SettingsLayersDlg);
+
+   // clear windows reset
+   WritePrivateProfileString(L"GlobalSettings", L"ResetWindows", L"0", (LPCTSTR)strAppNameINI);
+
+   WindowReadyTime = StartupElapsedTime();
+
+   BOOL Loading = FALSE;
    if (GetPrivateProfileInt(L"SettingsGlobalDlg", L"StartLast", 0, (LPCTSTR)strAppNameINI) != 0) {
-       // load the last layer cinfiguration
+       // load the last layer configuration in the background
+       // WM_BACKGROUND_DONE puts it into ImageLayers when it is done
        WCHAR szString[MAX_PATH];
 
        GetPrivateProfileString(L"GlobalSettings", L"LastConfigFile", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
-       //wcscpy_s(ImageLayers->ConfigurationFile, MAX_PATH, szString);
-       int iRes = ImageLayers->LoadConfiguration(szString);
-       if (iRes != APP_SUCCESS) {
-           wcscpy_s(ImageLayers->ConfigurationFile, MAX_PATH, L"");
+       if (wcslen(szString) != 0 && StartBackgroundLoad(hWnd, szString, ImageLayers) == APP_SUCCESS) {
+           EnableMenuItem(GetMenu(hWnd), IDM_CANCEL_LOAD, MF_BYCOMMAND | MF_ENABLED);
+           Loading = TRUE;
        }
    }
-   else {
-       wcscpy_s(ImageLayers->ConfigurationFile, MAX_PATH, L"");
+   if (!Loading) {
+       LogStartupTime(0.0, 0, APP_SUCCESS);
    }
 
-   hwndLayers = CreateDialog(hInst, MAKEINTRESOURCE(IDD_SETTINGS_LAYERS), hWnd, SettingsLayersDlg);
-
-   // clear windows reset
-   WritePrivateProfileString(L"GlobalSettings", L"ResetWindows", L"0", (LPCTSTR)strAppNameINI);
    return TRUE;
 }
 
+//*******************************************************************************
+//
+//  double StartupElapsedTime(void)
+//
+// return
+// double           milliseconds since the application started
+//
+//*******************************************************************************
+double StartupElapsedTime(void)
+{
+    LARGE_INTEGER Now;
+    LARGE_INTEGER Frequency;
+
+    QueryPerformanceCounter(&Now);
+    QueryPerformanceFrequency(&Frequency);
+    return (double)(Now.QuadPart - StartupCounter.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+}
+
+//*******************************************************************************
+//
+//  void LogStartupTime(double LoadTime, int NumLayers, int Result)
+//
+// Append the startup times to the log file.  The log file has the same name
+// as the executable with a .log extension and is in the same directory.
+//
+// double LoadTime      milliseconds to load and composite the last configuration,
+//                      0 if it was not loaded
+// int NumLayers        # of layers loaded
+// int Result           result of loading the last configuration
+//
+//*******************************************************************************
+void LogStartupTime(double LoadTime, int NumLayers, int Result)
+{
+    FILE* LogFile;
+    SYSTEMTIME Now;
+    WCHAR szString[256];
+
+    swprintf_s(szString, 256, L"MySETIviewer: startup, windows %.1f ms, last configuration %.1f ms, total %.1f ms\n",
+        WindowReadyTime, LoadTime, StartupElapsedTime());
+    OutputDebugString(szString);
+
+    CPath path(strAppNameEXE);
+    path.RenameExtension(_T(".log"));
+    if (_wfopen_s(&LogFile, (LPCTSTR)path, L"a") != 0 || LogFile == NULL) {
+        return;
+    }
+    GetLocalTime(&Now);
+    fwprintf(LogFile, L"%04d-%02d-%02d %02d:%02d:%02d, V%s, startup windows %.1f ms, last configuration %.1f ms (%d layers, result %d), total %.1f ms\n",
+        Now.wYear, Now.wMonth, Now.wDay, Now.wHour, Now.wMinute, Now.wSecond,
+        (LPCTSTR)strProductVersion, WindowReadyTime, LoadTime, NumLayers, Result, StartupElapsedTime());
+    fclose(LogFile);
+}
+
 //*******************************************************************************
 //
 //  FUNCTION: WndProc(HWND, UINT, WPARAM, LPARAM)
@@ -440,6 +528,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         switch (wmId)
         {
 
+        case IDM_CANCEL_LOAD:
+            // WM_BACKGROUND_DONE is still sent
+            CancelBackgroundLoad();
+            break;
+
         case IDM_LOAD_CONFIGURATION:
         {
             int iRes;
@@ -459,6 +552,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             wcscpy_s(szFilename, pszFilename);
             CoTaskMemFree(pszFilename);
 
+            // this replaces the last configuration if it is still loading
+            EndBackgroundLoad();
+
             iRes = ImageLayers->LoadConfiguration(szFilename);
             if (iRes != APP_SUCCESS) {
                 MessageBox(hWnd, L"Load configuration file failed\nCheck file for correct filenames in file", L"Layers", MB_OK);
@@ -578,7 +674,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             CoTaskMemFree(pszFilename);
 
             int iRes;
-            iRes = Displays->SaveBMP(szCurrentFilename, 0);
+            if (Displays->IsVirtual()) {
+                // the display image is created for the save
+                COLORREF* Overlay;
+                int xsize, ysize;
+                iRes = ImageLayers->GetOverlayImage(&Overlay, &xsize, &ysize);
+                if (iRes == APP_SUCCESS) {
+                    iRes = Displays->SaveBMP(szCurrentFilename, Overlay, xsize, ysize);
+                }
+            }
+            else {
+                iRes = Displays->SaveBMP(szCurrentFilename, 0);
+            }
             if (iRes != APP_SUCCESS) {
                 MessageBox(hWnd, L"Save Failed", L"Layers", MB_OK);
             }
@@ -676,6 +783,64 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
         break;
     } // This is the end of WM_COMMAND
+
+    case WM_BACKGROUND_PROGRESS:
+    {
+        // loading the last configuration
+        WCHAR szString[MAX_PATH];
+
+        if (wParam < (WPARAM)lParam) {
+            swprintf_s(szString, MAX_PATH, L"%s - loading last configuration, %d of %d layer files",
+                szTitle, (int)wParam, (int)lParam);
+        }
+        else {
+            swprintf_s(szString, MAX_PATH, L"%s - loading last configuration, compositing overlay", szTitle);
+        }
+        SetWindowText(hWnd, szString);
+        break;
+    }
+
+    case WM_BACKGROUND_DONE:
+    {
+        Layers* LoadedLayers;
+        int iRes;
+        double LoadTime;
+
+        SetWindowText(hWnd, szTitle);
+        EnableMenuItem(GetMenu(hWnd), IDM_CANCEL_LOAD, MF_BYCOMMAND | MF_GRAYED);
+
+        LoadedLayers = FinishBackgroundLoad(&iRes, &LoadTime);
+        if (LoadedLayers == NULL) {
+            // replaced by File->Load Layer configuration
+            break;
+        }
+
+        if (iRes == APPERR_CANCEL || ImageLayers->GetNumLayers() != 0) {
+            // cancelled, or layers were added while it was loading
+            LogStartupTime(LoadTime, 0, iRes);
+            delete LoadedLayers;
+            break;
+        }
+
+        delete ImageLayers;
+        ImageLayers = LoadedLayers;
+        if (iRes != APP_SUCCESS) {
+            wcscpy_s(ImageLayers->ConfigurationFile, MAX_PATH, L"");
+        }
+
+        if (hwndLayers) {
+            // backup configuration in case user cancels the Layers dialog
+            WCHAR TempConfig[MAX_PATH];
+            swprintf_s(TempConfig, MAX_PATH, L"%s\\MySETIviewerTmp.cfg", szTempDir);
+            ImageLayers->SaveConfiguration(TempConfig);
+
+            // the overlay is already composited, this creates the display
+            SendMessage(hwndLayers, WM_COMMAND, ID_UPDATE, 1); // apply
+        }
+
+        LogStartupTime(LoadTime, ImageLayers->GetNumLayers(), iRes);
+        break;
+    }
   
     case WM_CLOSE:
     {
@@ -705,8 +870,14 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
     case WM_DESTROY:
     {   
+        // if the last configuration is still loading it stays the last configuration
+        BOOL Loading = IsBackgroundLoadRunning();
+        EndBackgroundLoad();
+
         WritePrivateProfileString(L"GlobalSettings", L"CurrentFilename", szCurrentFilename, (LPCTSTR)strAppNameINI);
-        WritePrivateProfileString(L"GlobalSettings", L"LastConfigFile", ImageLayers->ConfigurationFile, (LPCTSTR)strAppNameINI);
+        if (!Loading || ImageLayers->GetNumLayers() != 0) {
+            WritePrivateProfileString(L"GlobalSettings", L"LastConfigFile", ImageLayers->ConfigurationFile, (LPCTSTR)strAppNameINI);
+        }
         // save window position/size data for the Main window
         CString csString = L"MainWindow";
         SaveWindowPlacement(hWnd, csString);
@@ -737,6 +908,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         if (ImageLayers != NULL) delete ImageLayers;
         if (Displays != NULL) delete Displays;
         if (ImgDlg != NULL) delete ImgDlg;
+        FlushImageCache();
 
         PostQuitMessage(0);
         break;
@@ -0,0 +1,196 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// OverlayRemap.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the color lookup table and the row kernels that color the
+// overlay from the layer coverage masks, see OverlayRemap.h
+//
+// V1.2.24	2026-10-17	Initial release, moved from Layers.cpp
+//						Mixed colors that are the overlay color are kept as in V1.0.2,
+//						see RemapOverlayColorRow()
+//
+#include <emmintrin.h>
+#include <immintrin.h>
+#include "OverlayRemap.h"
+
+// gcc and clang only allow AVX2 intrinsics in functions built for AVX2
+#if defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+//*******************************************************************************
+//
+//  int BuildRemapLUT(REMAPPIXEL* LUT, const REMAPPIXEL* LayerColors, uint8_t Used,
+//		REMAPPIXEL Background, REMAPPIXEL OverlayColor)
+// 
+// Layers are added in order, the same as compositing them one at a time
+// 
+//*******************************************************************************
+int BuildRemapLUT(REMAPPIXEL* LUT, const REMAPPIXEL* LayerColors, uint8_t Used,
+	REMAPPIXEL Background, REMAPPIXEL OverlayColor) {
+	int NumOverlayColor = 0;
+
+	for (int Mask = 0; Mask < 256; Mask++) {
+		REMAPPIXEL Color = OverlayColor;
+
+		LUT[256 + Mask] = (Mask & Used) ? Background : OverlayColor;
+
+		for (int Layer = 0; Layer < REMAP_LAYERS; Layer++) {
+			if (!(Mask & Used & (1 << Layer))) {
+				continue;
+			}
+			if (Color == Background || Color == OverlayColor) {
+				// pixel was not previously set high
+				Color = LayerColors[Layer];
+			}
+			else {
+				// pixel already set, mix the 2 colors
+				Color = MixColors(Color, LayerColors[Layer]);
+			}
+		}
+		if ((Mask & Used) && Color == OverlayColor) {
+			// depends on the later layers, see RemapOverlayColorRow()
+			NumOverlayColor++;
+		}
+		LUT[Mask] = Color;
+	}
+	return NumOverlayColor;
+}
+
+//*******************************************************************************
+//
+//  void RemapOverlayColorRow(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+//		int Count, uint8_t Used, REMAPPIXEL Background, REMAPPIXEL OverlayColor)
+// 
+// A set pixel can only be the overlay color when its last set layer mixed it
+// to that color.  A later layer with a 0 pixel there then makes it the
+// background color.  Later set layers can't, they would be in the coverage.
+// 
+//*******************************************************************************
+void RemapOverlayColorRow(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, uint8_t Used, REMAPPIXEL Background, REMAPPIXEL OverlayColor) {
+	for (int i = 0; i < Count; i++) {
+		unsigned int Set = Coverage[i] & Used;
+		if (Set == 0 || Overlay[i] != OverlayColor) {
+			continue;
+		}
+		// layers up to the last set layer
+		Set |= Set >> 1;
+		Set |= Set >> 2;
+		Set |= Set >> 4;
+		if (Footprint[i] & Used & ~Set) {
+			Overlay[i] = Background;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  void RemapRowScalar(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+//		int Count, const REMAPPIXEL* LUT, uint8_t Used)
+// 
+// Reference kernel, one pixel at a time
+// 
+//*******************************************************************************
+void RemapRowScalar(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used) {
+	for (int i = 0; i < Count; i++) {
+		uint8_t Cov = Coverage[i];
+		if (Cov & Used) {
+			Overlay[i] = LUT[Cov];
+		}
+		else {
+			Overlay[i] = LUT[256 + Footprint[i]];
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  void RemapRowSSE2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+//		int Count, const REMAPPIXEL* LUT, uint8_t Used)
+// 
+// Blocks of 16 pixels with the same lookup index are stored with one color,
+// other blocks and the end of the row are done by RemapRowScalar
+// 
+//*******************************************************************************
+void RemapRowSSE2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used) {
+	const __m128i UsedMask = _mm_set1_epi8((char)Used);
+	const __m128i Zero = _mm_setzero_si128();
+	int i = 0;
+
+	for (; i + 16 <= Count; i += 16) {
+		__m128i Cov = _mm_loadu_si128((const __m128i*)(Coverage + i));
+		int NotSet = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(Cov, UsedMask), Zero));
+		int Index = -1;
+
+		if (NotSet == 0xffff) {
+			// no layer pixels set, same footprint for all 16 pixels?
+			__m128i Fp = _mm_loadu_si128((const __m128i*)(Footprint + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(Fp, _mm_set1_epi8((char)Footprint[i]))) == 0xffff) {
+				Index = 256 + Footprint[i];
+			}
+		}
+		else if (NotSet == 0) {
+			// all layer pixels set, same coverage for all 16 pixels?
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(Cov, _mm_set1_epi8((char)Coverage[i]))) == 0xffff) {
+				Index = Coverage[i];
+			}
+		}
+
+		if (Index < 0) {
+			RemapRowScalar(Overlay + i, Coverage + i, Footprint + i, 16, LUT, Used);
+			continue;
+		}
+		__m128i Color = _mm_set1_epi32((int)LUT[Index]);
+		_mm_storeu_si128((__m128i*)(Overlay + i), Color);
+		_mm_storeu_si128((__m128i*)(Overlay + i + 4), Color);
+		_mm_storeu_si128((__m128i*)(Overlay + i + 8), Color);
+		_mm_storeu_si128((__m128i*)(Overlay + i + 12), Color);
+	}
+	RemapRowScalar(Overlay + i, Coverage + i, Footprint + i, Count - i, LUT, Used);
+}
+
+//*******************************************************************************
+//
+//  void RemapRowAVX2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+//		int Count, const REMAPPIXEL* LUT, uint8_t Used)
+// 
+// 8 pixels at a time, the lookup index of each pixel is made from its masks
+// and the colors are gathered from the LUT.  The end of the row is done by
+// RemapRowScalar.
+// 
+//*******************************************************************************
+AVX2_FUNCTION void RemapRowAVX2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used) {
+	const __m256i UsedMask = _mm256_set1_epi32(Used);
+	const __m256i FootprintBase = _mm256_set1_epi32(256);
+	const __m256i Zero = _mm256_setzero_si256();
+	int i = 0;
+
+	for (; i + 8 <= Count; i += 8) {
+		__m256i Cov = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(Coverage + i)));
+		__m256i Fp = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(Footprint + i)));
+		__m256i NotSet = _mm256_cmpeq_epi32(_mm256_and_si256(Cov, UsedMask), Zero);
+		__m256i Index = _mm256_blendv_epi8(Cov, _mm256_add_epi32(Fp, FootprintBase), NotSet);
+		_mm256_storeu_si256((__m256i*)(Overlay + i), _mm256_i32gather_epi32((const int*)LUT, Index, 4));
+	}
+	RemapRowScalar(Overlay + i, Coverage + i, Footprint + i, Count - i, LUT, Used);
+}
@@ -0,0 +1,119 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// OverlayRemap.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the color lookup table and the row kernels that color the
+// overlay from the layer coverage masks, used by the Layers class.
+// This does not use any Windows headers so it can be tested without a window,
+// see Tests/OverlayRemapTest.cpp.
+//
+// V1.2.24	2026-10-17	Initial release, moved from Layers.cpp
+//						Mixed colors that are the overlay color are kept as in V1.0.2,
+//						see RemapOverlayColorRow()
+//
+#include <stdint.h>
+
+// pixel of the overlay image, same layout as a COLORREF
+typedef uint32_t REMAPPIXEL;
+
+// layers in a coverage mask, one bit each
+#define REMAP_LAYERS 8
+
+//*******************************************************************************
+//
+//  REMAPPIXEL MixColors(REMAPPIXEL Color1, REMAPPIXEL Color2)
+// 
+// Color of an overlay pixel set by more than one layer
+// 
+//*******************************************************************************
+inline REMAPPIXEL MixColors(REMAPPIXEL Color1, REMAPPIXEL Color2) {
+	// each color channel is mixed using 2/3 of each color
+	// the unused 4th byte is always 0
+	REMAPPIXEL NewColor = 0;
+	int Colorsum;
+
+	for (int Shift = 0; Shift < 24; Shift += 8) {
+		Colorsum = (int)((Color1 >> Shift) & 0xff) * 2 / 3 + (int)((Color2 >> Shift) & 0xff) * 2 / 3;
+		if (Colorsum > 255) Colorsum = 255;
+		NewColor |= (REMAPPIXEL)Colorsum << Shift;
+	}
+	return NewColor;
+}
+
+//*******************************************************************************
+//
+//  int BuildRemapLUT(REMAPPIXEL* LUT, const REMAPPIXEL* LayerColors, uint8_t Used,
+//		REMAPPIXEL Background, REMAPPIXEL OverlayColor)
+// 
+// Make the 512 color lookup table of the row kernels
+//	LUT[Coverage]			color of a pixel with at least one set layer pixel
+//	LUT[256 + Footprint]	color of a pixel with no set layer pixels
+// LayerColors has a color for each of the REMAP_LAYERS layers, only the
+// layers in Used are added.
+// 
+// Mixed layer colors can be exactly the overlay color.  Such a pixel becomes
+// the background color when a later layer has a 0 pixel there, which the
+// coverage mask can't tell.  LUT has the overlay color for it, and the row
+// must also be done by RemapOverlayColorRow().
+// 
+// return
+// int					number of LUT[Coverage] colors that are the overlay color
+//
+//*******************************************************************************
+int BuildRemapLUT(REMAPPIXEL* LUT, const REMAPPIXEL* LayerColors, uint8_t Used,
+	REMAPPIXEL Background, REMAPPIXEL OverlayColor);
+
+//*******************************************************************************
+//
+//  void RemapOverlayColorRow(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+//		int Count, uint8_t Used, REMAPPIXEL Background, REMAPPIXEL OverlayColor)
+// 
+// After a row kernel, make the set pixels that are the overlay color the
+// background color when a layer after their last set layer has a 0 pixel there
+// Only needed when BuildRemapLUT() returned more than 0.
+// 
+//*******************************************************************************
+void RemapOverlayColorRow(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, uint8_t Used, REMAPPIXEL Background, REMAPPIXEL OverlayColor);
+
+//*******************************************************************************
+//
+//  Color lookup row kernels
+// 
+// Each kernel colors Count overlay pixels of a row from the coverage masks:
+//	Coverage & Used != 0	LUT[Coverage]			layer color or mixed layer colors
+//	otherwise				LUT[256 + Footprint]	background or overlay color
+// 
+// RemapRowScalar is the reference, the SSE2 and AVX2 kernels must give the
+// same pixels.  Layers selects the kernel at run time.
+//	SSE2	16 pixels that all have the same color are stored as a block
+//	AVX2	8 pixels are looked up at a time with a gather, the processor
+//			must support AVX2
+//
+//*******************************************************************************
+typedef void (*REMAPROW)(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used);
+
+void RemapRowScalar(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used);
+
+void RemapRowSSE2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used);
+
+void RemapRowAVX2(REMAPPIXEL* Overlay, const uint8_t* Coverage, const uint8_t* Footprint,
+	int Count, const REMAPPIXEL* LUT, uint8_t Used);
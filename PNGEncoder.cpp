@@ -0,0 +1,1307 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// PNGEncoder.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the functions of the PNG file encoder
+//
+// PNG files are written directly from COLORREF images, GDI+ is not used.
+// The encoder does not use any Windows headers, the file is written and the
+// tasks are run by the functions of a PNGOUTPUT, see SaveImagePNG() in
+// FileFunctions.cpp.
+//
+// The image is first scanned for its colors.  Images with 256 colors or less
+// are written as palette images, 1, 2, 4 or 8 bits per pixel, so binary
+// layers are 1 bit per pixel.  Other images are written as 24 bit RGB.
+//
+// The rows are then packed, filtered and compressed in bands of about
+// PNG_BAND_PIXELS pixels, one task per band.  Each band is
+// compressed on its own (deflate, LZ77 with hash chains and dynamic Huffman
+// codes) and ends on a byte boundary with an empty stored block, so the
+// compressed bands are simply written one after the other, each in its own
+// IDAT chunk.  The zlib Adler-32 of the bands is combined at the end.
+//
+// Only the image rows of one chunk of bands are held in memory at a time.
+//
+// V1.2.20	2026-10-17	Initial release
+// V1.2.24	2026-10-17	Windows headers, _wfopen_s, InterlockedExchange and ParallelFor
+//						replaced by PNGOUTPUT, SaveImagePNG() moved to FileFunctions.cpp
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include "AppErrors.h"
+#include "PNGEncoder.h"
+
+// deflate
+#define PNG_WINDOW 32768
+#define PNG_WINDOW_MASK (PNG_WINDOW - 1)
+#define PNG_HASH_BITS 15
+#define PNG_HASH_SIZE (1 << PNG_HASH_BITS)
+#define PNG_MIN_MATCH 3
+#define PNG_MAX_MATCH 258
+#define PNG_GOOD_MATCH 32
+#define PNG_NICE_MATCH 128
+#define PNG_LITLEN_CODES 286
+#define PNG_DIST_CODES 30
+#define PNG_CODELEN_CODES 19
+#define PNG_MAX_BITS 15
+#define PNG_MAX_CODELEN_BITS 7
+#define PNG_STORED_MAX 65535
+
+// color hash tables
+#define PNG_COLOR_HASH 512
+#define PNG_NO_COLOR 0xffffffff
+
+static const uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t CodeLengthOrder[PNG_CODELEN_CODES] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11,
+	4, 12, 3, 13, 2, 14, 1, 15 };
+static const uint8_t CodeLengthExtra[PNG_CODELEN_CODES] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 2, 3, 7 };
+
+static uint32_t CRCtable[256];
+static uint8_t LengthCode[256];		// match length - 3 to length code - 257
+static uint8_t DistCode[512];			// see GetDistCode()
+static bool TablesValid = false;
+
+typedef struct {
+	uint8_t* Out;
+	size_t Len;
+	uint64_t Bits;
+	int NumBits;
+} BITWRITER;
+
+typedef struct {
+	int Freq;
+	int Sym;
+} HUFFSYM;
+
+typedef struct {
+	size_t OutLen;		// compressed bytes
+	uint32_t CRC;			// CRC of the IDAT chunk
+	uint32_t Adler;		// Adler-32 of the filtered rows
+	size_t RawLen;		// filtered bytes
+} PNGBAND;
+
+typedef struct {
+	PNGOUTPUT* Output;
+	PNGGETROWS GetRows;
+	void* Context;
+	int xsize;
+	int ysize;
+	int BandRows;				// rows in each band
+	int ChunkRows;				// rows in each chunk of bands
+
+	// current chunk
+	const PNGPIXEL* Rows;
+	int NumRows;
+	int NumBands;
+
+	// colors, NumColors is 0 for RGB images
+	int NumColors;
+	PNGPIXEL Palette[256];
+	uint32_t ColorHash[PNG_COLOR_HASH];
+	uint8_t IndexHash[PNG_COLOR_HASH];
+	PNGPIXEL* BandColors;		// 256 per band
+	int* BandNumColors;			// -1 when a band has more than 256
+	std::atomic<int> TooManyColors;
+
+	// encoding
+	int BitDepth;
+	int PixelBytes;				// filter distance, 1 for palette images
+	int RawRowBytes;
+	uint8_t* Packed;				// previous row, then the rows of the chunk
+	uint8_t* Filtered;
+	uint8_t* Out;
+	size_t BandOutSize;
+	PNGBAND* Bands;
+	std::atomic<int> Failed;
+} PNGJOB;
+
+//*******************************************************************************
+//
+//  static void MakeTables(void)
+//
+// Fill in the CRC and length/distance code tables
+//
+//*******************************************************************************
+static void MakeTables(void) {
+	if (TablesValid) {
+		return;
+	}
+	for (int n = 0; n < 256; n++) {
+		uint32_t c = (uint32_t)n;
+		for (int k = 0; k < 8; k++) {
+			c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+		}
+		CRCtable[n] = c;
+	}
+	for (int Code = 0; Code < 29; Code++) {
+		for (int n = 0; n < (1 << LengthExtra[Code]); n++) {
+			int Length = LengthBase[Code] + n;
+			if (Length <= PNG_MAX_MATCH) {
+				LengthCode[Length - PNG_MIN_MATCH] = (uint8_t)Code;
+			}
+		}
+	}
+	for (int Code = 0; Code < 30; Code++) {
+		for (int n = 0; n < (1 << DistExtra[Code]); n++) {
+			int d = DistBase[Code] + n - 1;
+			if (d < 256) {
+				DistCode[d] = (uint8_t)Code;
+			}
+			else {
+				DistCode[256 + (d >> 7)] = (uint8_t)Code;
+			}
+		}
+	}
+	TablesValid = true;
+}
+
+static inline int GetDistCode(int Dist) {
+	int d = Dist - 1;
+	return d < 256 ? DistCode[d] : DistCode[256 + (d >> 7)];
+}
+
+static uint32_t UpdateCRC(uint32_t CRC, const uint8_t* Data, size_t Len) {
+	for (size_t i = 0; i < Len; i++) {
+		CRC = CRCtable[(CRC ^ Data[i]) & 0xff] ^ (CRC >> 8);
+	}
+	return CRC;
+}
+
+//*******************************************************************************
+//
+//  static uint32_t ChunkCRC(const char* Type, const uint8_t* Data, size_t Len)
+//
+// return
+// uint32_t				CRC of a PNG chunk, the chunk type and data
+//
+//*******************************************************************************
+static uint32_t ChunkCRC(const char* Type, const uint8_t* Data, size_t Len) {
+	uint32_t CRC = 0xffffffff;
+
+	CRC = UpdateCRC(CRC, (const uint8_t*)Type, 4);
+	CRC = UpdateCRC(CRC, Data, Len);
+	return CRC ^ 0xffffffff;
+}
+
+static uint32_t Adler32(uint32_t Adler, const uint8_t* Data, size_t Len) {
+	uint32_t s1 = Adler & 0xffff;
+	uint32_t s2 = Adler >> 16;
+
+	while (Len > 0) {
+		// largest n where s2 can't overflow
+		size_t n = Len < 5552 ? Len : 5552;
+		Len -= n;
+		while (n--) {
+			s1 += *Data++;
+			s2 += s1;
+		}
+		s1 %= 65521;
+		s2 %= 65521;
+	}
+	return s1 | (s2 << 16);
+}
+
+//*******************************************************************************
+//
+//  static uint32_t CombineAdler32(uint32_t Adler1, uint32_t Adler2, size_t Len2)
+//
+// return
+// uint32_t				Adler-32 of two blocks of data one after the other,
+//						Adler2 is of the second block, Len2 bytes
+//
+//*******************************************************************************
+static uint32_t CombineAdler32(uint32_t Adler1, uint32_t Adler2, size_t Len2) {
+	const uint64_t Base = 65521;
+	uint64_t Rem = Len2 % Base;
+	uint64_t Sum1 = Adler1 & 0xffff;
+	uint64_t Sum2 = (Rem * Sum1) % Base;
+
+	Sum1 += (Adler2 & 0xffff) + Base - 1;
+	Sum2 += (Adler1 >> 16) + (Adler2 >> 16) + Base - Rem;
+	if (Sum1 >= Base) Sum1 -= Base;
+	if (Sum1 >= Base) Sum1 -= Base;
+	if (Sum2 >= (Base << 1)) Sum2 -= (Base << 1);
+	if (Sum2 >= Base) Sum2 -= Base;
+	return (uint32_t)(Sum1 | (Sum2 << 16));
+}
+
+static void PutDWORD(uint8_t* Dest, uint32_t Value) {
+	// PNG values are big endian
+	Dest[0] = (uint8_t)(Value >> 24);
+	Dest[1] = (uint8_t)(Value >> 16);
+	Dest[2] = (uint8_t)(Value >> 8);
+	Dest[3] = (uint8_t)Value;
+}
+
+static inline void PutBits(BITWRITER* W, uint32_t Value, int NumBits) {
+	W->Bits |= (uint64_t)Value << W->NumBits;
+	W->NumBits += NumBits;
+	while (W->NumBits >= 8) {
+		W->Out[W->Len++] = (uint8_t)W->Bits;
+		W->Bits >>= 8;
+		W->NumBits -= 8;
+	}
+}
+
+static void AlignBits(BITWRITER* W) {
+	if (W->NumBits > 0) {
+		W->Out[W->Len++] = (uint8_t)W->Bits;
+		W->Bits = 0;
+		W->NumBits = 0;
+	}
+}
+
+static int CompareHuffSym(const void* a, const void* b) {
+	const HUFFSYM* A = (const HUFFSYM*)a;
+	const HUFFSYM* B = (const HUFFSYM*)b;
+
+	if (A->Freq != B->Freq) {
+		return A->Freq < B->Freq ? -1 : 1;
+	}
+	return A->Sym - B->Sym;
+}
+
+//*******************************************************************************
+//
+//  static void MinimumRedundancy(int* A, int n)
+//
+// In place Huffman code lengths (Moffat and Katajainen)
+//
+// int* A				frequencies, ascending, returns the code lengths
+// int n				# of frequencies, at least 2
+//
+//*******************************************************************************
+static void MinimumRedundancy(int* A, int n) {
+	int Root, Leaf, Next, Avbl, Used, Depth;
+
+	// pair up the lowest weights, parent pointers are kept in A
+	A[0] += A[1];
+	Root = 0;
+	Leaf = 2;
+	for (Next = 1; Next < n - 1; Next++) {
+		if (Leaf >= n || A[Root] < A[Leaf]) {
+			A[Next] = A[Root];
+			A[Root++] = Next;
+		}
+		else {
+			A[Next] = A[Leaf++];
+		}
+		if (Leaf >= n || (Root < Next && A[Root] < A[Leaf])) {
+			A[Next] += A[Root];
+			A[Root++] = Next;
+		}
+		else {
+			A[Next] += A[Leaf++];
+		}
+	}
+
+	// internal node depths
+	A[n - 2] = 0;
+	for (Next = n - 3; Next >= 0; Next--) {
+		A[Next] = A[A[Next]] + 1;
+	}
+
+	// leaf depths
+	Avbl = 1;
+	Used = Depth = 0;
+	Root = n - 2;
+	Next = n - 1;
+	while (Avbl > 0) {
+		while (Root >= 0 && A[Root] == Depth) {
+			Used++;
+			Root--;
+		}
+		while (Avbl > Used) {
+			A[Next--] = Depth;
+			Avbl--;
+		}
+		Avbl = 2 * Used;
+		Depth++;
+		Used = 0;
+	}
+}
+
+//*******************************************************************************
+//
+//  static void BuildCodeLengths(int* Freq, int NumSyms, int MaxBits, uint8_t* Lengths)
+//
+// Huffman code lengths limited to MaxBits.  At least two symbols get a code
+// so the code is always complete.
+//
+//*******************************************************************************
+static void BuildCodeLengths(int* Freq, int NumSyms, int MaxBits, uint8_t* Lengths) {
+	HUFFSYM Sorted[PNG_LITLEN_CODES];
+	int A[PNG_LITLEN_CODES];
+	int NumCodes[33] = { 0 };
+	int n = 0;
+
+	memset(Lengths, 0, NumSyms);
+	for (int s = 0; s < NumSyms; s++) {
+		if (Freq[s] > 0) {
+			Sorted[n].Freq = Freq[s];
+			Sorted[n++].Sym = s;
+		}
+	}
+	for (int s = 0; n < 2; s++) {
+		if (Freq[s] == 0) {
+			Sorted[n].Freq = 1;
+			Sorted[n++].Sym = s;
+		}
+	}
+	qsort(Sorted, n, sizeof(HUFFSYM), CompareHuffSym);
+
+	for (int i = 0; i < n; i++) {
+		A[i] = Sorted[i].Freq;
+	}
+	MinimumRedundancy(A, n);
+	for (int i = 0; i < n; i++) {
+		NumCodes[A[i] < 32 ? A[i] : 32]++;
+	}
+
+	// move codes longer than MaxBits up, then make the code complete again
+	for (int i = MaxBits + 1; i <= 32; i++) {
+		NumCodes[MaxBits] += NumCodes[i];
+		NumCodes[i] = 0;
+	}
+	uint32_t Total = 0;
+	for (int i = 1; i <= MaxBits; i++) {
+		Total += (uint32_t)NumCodes[i] << (MaxBits - i);
+	}
+	while (Total != (1u << MaxBits)) {
+		NumCodes[MaxBits]--;
+		for (int i = MaxBits - 1; i > 0; i--) {
+			if (NumCodes[i] != 0) {
+				NumCodes[i]--;
+				NumCodes[i + 1] += 2;
+				break;
+			}
+		}
+		Total--;
+	}
+
+	// least frequent symbols get the longest codes
+	int Index = 0;
+	for (int Bits = MaxBits; Bits > 0; Bits--) {
+		for (int i = 0; i < NumCodes[Bits]; i++) {
+			Lengths[Sorted[Index++].Sym] = (uint8_t)Bits;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  static void BuildCodes(const uint8_t* Lengths, int NumSyms, uint16_t* Codes)
+//
+// Canonical Huffman codes from the code lengths, bit reversed for writing
+// least significant bit first
+//
+//*******************************************************************************
+static void BuildCodes(const uint8_t* Lengths, int NumSyms, uint16_t* Codes) {
+	int Count[PNG_MAX_BITS + 1] = { 0 };
+	int NextCode[PNG_MAX_BITS + 1];
+	int Code = 0;
+
+	for (int s = 0; s < NumSyms; s++) {
+		Count[Lengths[s]]++;
+	}
+	Count[0] = 0;
+	for (int Bits = 1; Bits <= PNG_MAX_BITS; Bits++) {
+		Code = (Code + Count[Bits - 1]) << 1;
+		NextCode[Bits] = Code;
+	}
+	for (int s = 0; s < NumSyms; s++) {
+		int Len = Lengths[s];
+		Codes[s] = 0;
+		if (Len != 0) {
+			int c = NextCode[Len]++;
+			int r = 0;
+			for (int i = 0; i < Len; i++) {
+				r = (r << 1) | (c & 1);
+				c >>= 1;
+			}
+			Codes[s] = (uint16_t)r;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  static void WriteStored(BITWRITER* W, const uint8_t* Raw, size_t RawLen)
+//
+// Write data as non-final stored blocks
+//
+//*******************************************************************************
+static void WriteStored(BITWRITER* W, const uint8_t* Raw, size_t RawLen) {
+	do {
+		size_t n = RawLen < PNG_STORED_MAX ? RawLen : PNG_STORED_MAX;
+
+		PutBits(W, 0, 3);
+		AlignBits(W);
+		W->Out[W->Len++] = (uint8_t)n;
+		W->Out[W->Len++] = (uint8_t)(n >> 8);
+		W->Out[W->Len++] = (uint8_t)~n;
+		W->Out[W->Len++] = (uint8_t)(~n >> 8);
+		memcpy(W->Out + W->Len, Raw, n);
+		W->Len += n;
+		Raw += n;
+		RawLen -= n;
+	} while (RawLen > 0);
+}
+
+//*******************************************************************************
+//
+//  static void WriteBlock(BITWRITER* W, const uint16_t* Lit, const uint16_t* Dist,
+//							int NumSyms, const uint8_t* Raw, size_t RawLen)
+//
+// Write a non-final deflate block of LZ77 symbols using dynamic Huffman codes,
+// or as stored blocks if that is smaller.
+//
+// Lit					literal byte, or 256 + match length
+// Dist					0 for a literal, or the match distance
+// Raw					the data the symbols code, RawLen bytes
+//
+//*******************************************************************************
+static void WriteBlock(BITWRITER* W, const uint16_t* Lit, const uint16_t* Dist, int NumSyms,
+	const uint8_t* Raw, size_t RawLen) {
+	int LitFreq[PNG_LITLEN_CODES] = { 0 };
+	int DistFreq[PNG_DIST_CODES] = { 0 };
+	int CodeLenFreq[PNG_CODELEN_CODES] = { 0 };
+	uint8_t LitLen[PNG_LITLEN_CODES];
+	uint8_t DistLen[PNG_DIST_CODES];
+	uint8_t CodeLenLen[PNG_CODELEN_CODES];
+	uint16_t LitCode[PNG_LITLEN_CODES];
+	uint16_t DistCodes[PNG_DIST_CODES];
+	uint16_t CodeLenCode[PNG_CODELEN_CODES];
+	uint8_t AllLen[PNG_LITLEN_CODES + PNG_DIST_CODES];
+	uint8_t RunSym[PNG_LITLEN_CODES + PNG_DIST_CODES];
+	uint8_t RunExtra[PNG_LITLEN_CODES + PNG_DIST_CODES];
+	int NumRuns = 0;
+
+	for (int i = 0; i < NumSyms; i++) {
+		if (Dist[i] == 0) {
+			LitFreq[Lit[i]]++;
+		}
+		else {
+			LitFreq[257 + LengthCode[Lit[i] - 256 - PNG_MIN_MATCH]]++;
+			DistFreq[GetDistCode(Dist[i])]++;
+		}
+	}
+	LitFreq[256] = 1;
+	BuildCodeLengths(LitFreq, PNG_LITLEN_CODES, PNG_MAX_BITS, LitLen);
+	BuildCodeLengths(DistFreq, PNG_DIST_CODES, PNG_MAX_BITS, DistLen);
+
+	int NumLit = PNG_LITLEN_CODES;
+	while (NumLit > 257 && LitLen[NumLit - 1] == 0) {
+		NumLit--;
+	}
+	int NumDist = PNG_DIST_CODES;
+	while (NumDist > 1 && DistLen[NumDist - 1] == 0) {
+		NumDist--;
+	}
+
+	// run length code the code lengths, 16 repeats the last length,
+	// 17 and 18 are runs of 0
+	int Total = NumLit + NumDist;
+	memcpy(AllLen, LitLen, NumLit);
+	memcpy(AllLen + NumLit, DistLen, NumDist);
+	for (int i = 0; i < Total;) {
+		int Len = AllLen[i];
+		int Run = 1;
+		while (i + Run < Total && AllLen[i + Run] == Len) {
+			Run++;
+		}
+		i += Run;
+		if (Len == 0) {
+			while (Run >= 11) {
+				int n = Run < 138 ? Run : 138;
+				RunSym[NumRuns] = 18;
+				RunExtra[NumRuns++] = (uint8_t)(n - 11);
+				Run -= n;
+			}
+			if (Run >= 3) {
+				RunSym[NumRuns] = 17;
+				RunExtra[NumRuns++] = (uint8_t)(Run - 3);
+				Run = 0;
+			}
+		}
+		else {
+			RunSym[NumRuns] = (uint8_t)Len;
+			RunExtra[NumRuns++] = 0;
+			Run--;
+			while (Run >= 3) {
+				int n = Run < 6 ? Run : 6;
+				RunSym[NumRuns] = 16;
+				RunExtra[NumRuns++] = (uint8_t)(n - 3);
+				Run -= n;
+			}
+		}
+		while (Run > 0) {
+			RunSym[NumRuns] = (uint8_t)Len;
+			RunExtra[NumRuns++] = 0;
+			Run--;
+		}
+	}
+	for (int i = 0; i < NumRuns; i++) {
+		CodeLenFreq[RunSym[i]]++;
+	}
+	BuildCodeLengths(CodeLenFreq, PNG_CODELEN_CODES, PNG_MAX_CODELEN_BITS, CodeLenLen);
+	int NumCodeLen = PNG_CODELEN_CODES;
+	while (NumCodeLen > 4 && CodeLenLen[CodeLengthOrder[NumCodeLen - 1]] == 0) {
+		NumCodeLen--;
+	}
+
+	// compare the size with stored blocks
+	uint64_t DynamicBits = 3 + 5 + 5 + 4 + 3 * NumCodeLen;
+	for (int i = 0; i < NumRuns; i++) {
+		DynamicBits += CodeLenLen[RunSym[i]] + CodeLengthExtra[RunSym[i]];
+	}
+	for (int s = 0; s < 256; s++) {
+		DynamicBits += (uint64_t)LitFreq[s] * LitLen[s];
+	}
+	DynamicBits += LitLen[256];
+	for (int c = 0; c < 29; c++) {
+		DynamicBits += (uint64_t)LitFreq[257 + c] * (LitLen[257 + c] + LengthExtra[c]);
+	}
+	for (int c = 0; c < PNG_DIST_CODES; c++) {
+		DynamicBits += (uint64_t)DistFreq[c] * (DistLen[c] + DistExtra[c]);
+	}
+	uint64_t StoredBits = (uint64_t)(RawLen / PNG_STORED_MAX + 1) * (3 + 7 + 32) + 8 * (uint64_t)RawLen;
+	if (DynamicBits >= StoredBits) {
+		WriteStored(W, Raw, RawLen);
+		return;
+	}
+
+	BuildCodes(LitLen, PNG_LITLEN_CODES, LitCode);
+	BuildCodes(DistLen, PNG_DIST_CODES, DistCodes);
+	BuildCodes(CodeLenLen, PNG_CODELEN_CODES, CodeLenCode);
+
+	// block header, not final, dynamic Huffman codes
+	PutBits(W, 0, 1);
+	PutBits(W, 2, 2);
+	PutBits(W, NumLit - 257, 5);
+	PutBits(W, NumDist - 1, 5);
+	PutBits(W, NumCodeLen - 4, 4);
+	for (int i = 0; i < NumCodeLen; i++) {
+		PutBits(W, CodeLenLen[CodeLengthOrder[i]], 3);
+	}
+	for (int i = 0; i < NumRuns; i++) {
+		PutBits(W, CodeLenCode[RunSym[i]], CodeLenLen[RunSym[i]]);
+		if (CodeLengthExtra[RunSym[i]] != 0) {
+			PutBits(W, RunExtra[i], CodeLengthExtra[RunSym[i]]);
+		}
+	}
+
+	for (int i = 0; i < NumSyms; i++) {
+		if (Dist[i] == 0) {
+			PutBits(W, LitCode[Lit[i]], LitLen[Lit[i]]);
+		}
+		else {
+			int Length = Lit[i] - 256;
+			int c = LengthCode[Length - PNG_MIN_MATCH];
+			PutBits(W, LitCode[257 + c], LitLen[257 + c]);
+			if (LengthExtra[c] != 0) {
+				PutBits(W, Length - LengthBase[c], LengthExtra[c]);
+			}
+			c = GetDistCode(Dist[i]);
+			PutBits(W, DistCodes[c], DistLen[c]);
+			if (DistExtra[c] != 0) {
+				PutBits(W, Dist[i] - DistBase[c], DistExtra[c]);
+			}
+		}
+	}
+	PutBits(W, LitCode[256], LitLen[256]);
+}
+
+static inline uint32_t Hash3(const uint8_t* Data) {
+	uint32_t v = Data[0] | (Data[1] << 8) | (Data[2] << 16);
+	return (v * 2654435761u) >> (32 - PNG_HASH_BITS);
+}
+
+static inline int MatchLength(const uint8_t* a, const uint8_t* b, int MaxLen) {
+	int n = 0;
+
+	while (n + 8 <= MaxLen) {
+		uint64_t x, y;
+		memcpy(&x, a + n, 8);
+		memcpy(&y, b + n, 8);
+		if (x != y) {
+			break;
+		}
+		n += 8;
+	}
+	while (n < MaxLen && a[n] == b[n]) {
+		n++;
+	}
+	return n;
+}
+
+//*******************************************************************************
+//
+//  static size_t DeflateBand(const uint8_t* Data, size_t Len, uint8_t* Out, uint8_t* Scratch)
+//
+// Compress one band as deflate blocks that are not final.  The band ends on a
+// byte boundary with an empty stored block so bands can be joined.
+//
+// Out					at least Len + Len / 1024 + 64 bytes
+// Scratch				work memory, see DeflateScratchSize()
+//
+// return
+// size_t				compressed bytes
+//
+//*******************************************************************************
+static size_t DeflateScratchSize(void) {
+	return (PNG_HASH_SIZE + PNG_WINDOW) * sizeof(int) + 2 * PNG_BLOCK_SYMBOLS * sizeof(uint16_t);
+}
+
+static size_t DeflateBand(const uint8_t* Data, size_t Len, uint8_t* Out, uint8_t* Scratch) {
+	int* Head = (int*)Scratch;
+	int* Prev = Head + PNG_HASH_SIZE;
+	uint16_t* Lit = (uint16_t*)(Prev + PNG_WINDOW);
+	uint16_t* Dist = Lit + PNG_BLOCK_SYMBOLS;
+	BITWRITER W = { Out, 0, 0, 0 };
+	int Pos = 0;
+	int BlockStart = 0;
+	int NumSyms = 0;
+	int DataLen = (int)Len;
+
+	for (int h = 0; h < PNG_HASH_SIZE; h++) {
+		Head[h] = -1;
+	}
+
+	while (Pos < DataLen) {
+		int BestLen = 0;
+		int BestDist = 0;
+
+		if (Pos + PNG_MIN_MATCH <= DataLen) {
+			int MaxLen = std::min(PNG_MAX_MATCH, DataLen - Pos);
+			int Limit = Pos - PNG_WINDOW;
+			int Chain = PNG_MAX_CHAIN;
+			uint32_t h = Hash3(Data + Pos);
+			int Cand = Head[h];
+
+			while (Cand >= 0 && Cand >= Limit && Chain-- > 0) {
+				// a longer match has to match at the end of the best one so far
+				if (Data[Cand + BestLen] == Data[Pos + BestLen] && Data[Cand] == Data[Pos]) {
+					int n = MatchLength(Data + Cand, Data + Pos, MaxLen);
+					if (n > BestLen) {
+						if (BestLen < PNG_GOOD_MATCH && n >= PNG_GOOD_MATCH) {
+							// search less once there is a good match
+							Chain >>= 2;
+						}
+						BestLen = n;
+						BestDist = Pos - Cand;
+						if (n >= PNG_NICE_MATCH || n == MaxLen) {
+							break;
+						}
+					}
+				}
+				Cand = Prev[Cand & PNG_WINDOW_MASK];
+			}
+			Prev[Pos & PNG_WINDOW_MASK] = Head[h];
+			Head[h] = Pos;
+		}
+
+		if (BestLen >= PNG_MIN_MATCH) {
+			int End = Pos + BestLen;
+
+			Lit[NumSyms] = (uint16_t)(256 + BestLen);
+			Dist[NumSyms++] = (uint16_t)BestDist;
+			// the rest of the match goes into the hash chains
+			for (int p = Pos + 1; p < End && p + PNG_MIN_MATCH <= DataLen; p++) {
+				uint32_t h = Hash3(Data + p);
+				Prev[p & PNG_WINDOW_MASK] = Head[h];
+				Head[h] = p;
+			}
+			Pos = End;
+		}
+		else {
+			Lit[NumSyms] = Data[Pos];
+			Dist[NumSyms++] = 0;
+			Pos++;
+		}
+
+		if (NumSyms == PNG_BLOCK_SYMBOLS) {
+			WriteBlock(&W, Lit, Dist, NumSyms, Data + BlockStart, Pos - BlockStart);
+			BlockStart = Pos;
+			NumSyms = 0;
+		}
+	}
+	if (NumSyms > 0) {
+		WriteBlock(&W, Lit, Dist, NumSyms, Data + BlockStart, Pos - BlockStart);
+	}
+
+	// empty stored block to end on a byte boundary
+	PutBits(&W, 0, 3);
+	AlignBits(&W);
+	Out[W.Len++] = 0x00;
+	Out[W.Len++] = 0x00;
+	Out[W.Len++] = 0xff;
+	Out[W.Len++] = 0xff;
+	return W.Len;
+}
+
+static inline uint32_t ColorHash(PNGPIXEL Color) {
+	return (Color * 2654435761u) >> 23;
+}
+
+//*******************************************************************************
+//
+//  static void PaletteTask(void* Context, int Band)
+//
+// ParallelFor task, find the colors of one band of the chunk
+//
+//*******************************************************************************
+static void PaletteTask(void* Context, int Band) {
+	PNGJOB* Job = (PNGJOB*)Context;
+	uint32_t Hash[PNG_COLOR_HASH];
+	PNGPIXEL* Colors = Job->BandColors + (size_t)Band * 256;
+	int NumColors = 0;
+	int First = Band * Job->BandRows;
+	int End = std::min(First + Job->BandRows, Job->NumRows);
+	PNGPIXEL Last = PNG_NO_COLOR;
+
+	memset(Hash, 0xff, sizeof(Hash));
+	for (int y = First; y < End; y++) {
+		const PNGPIXEL* Row = Job->Rows + (size_t)y * Job->xsize;
+
+		if (Job->TooManyColors) {
+			break;
+		}
+		for (int x = 0; x < Job->xsize; x++) {
+			PNGPIXEL Color = Row[x] & 0xffffff;
+			if (Color == Last) {
+				continue;
+			}
+			Last = Color;
+			uint32_t h = ColorHash(Color);
+			while (Hash[h] != PNG_NO_COLOR && Hash[h] != Color) {
+				h = (h + 1) & (PNG_COLOR_HASH - 1);
+			}
+			if (Hash[h] == Color) {
+				continue;
+			}
+			if (NumColors == 256) {
+				Job->TooManyColors = 1;
+				Job->BandNumColors[Band] = -1;
+				return;
+			}
+			Hash[h] = Color;
+			Colors[NumColors++] = Color;
+		}
+	}
+	Job->BandNumColors[Band] = NumColors;
+}
+
+//*******************************************************************************
+//
+//  static void PackTask(void* Context, int Band)
+//
+// ParallelFor task, pack the rows of one band of the chunk into PNG pixels,
+// palette indexes or R G B bytes
+//
+//*******************************************************************************
+static void PackTask(void* Context, int Band) {
+	PNGJOB* Job = (PNGJOB*)Context;
+	int First = Band * Job->BandRows;
+	int End = std::min(First + Job->BandRows, Job->NumRows);
+
+	for (int y = First; y < End; y++) {
+		const PNGPIXEL* Row = Job->Rows + (size_t)y * Job->xsize;
+		uint8_t* Dest = Job->Packed + (size_t)(y + 1) * Job->RawRowBytes;
+
+		if (Job->NumColors == 0) {
+			for (int x = 0; x < Job->xsize; x++) {
+				Dest[0] = (uint8_t)Row[x];
+				Dest[1] = (uint8_t)(Row[x] >> 8);
+				Dest[2] = (uint8_t)(Row[x] >> 16);
+				Dest += 3;
+			}
+			continue;
+		}
+
+		PNGPIXEL Last = PNG_NO_COLOR;
+		int Index = 0;
+		int Acc = 0;
+		int AccBits = 0;
+		for (int x = 0; x < Job->xsize; x++) {
+			PNGPIXEL Color = Row[x] & 0xffffff;
+			if (Color != Last) {
+				uint32_t h = ColorHash(Color);
+				while (Job->ColorHash[h] != Color) {
+					h = (h + 1) & (PNG_COLOR_HASH - 1);
+				}
+				Index = Job->IndexHash[h];
+				Last = Color;
+			}
+			// pixels are packed from the most significant bit
+			Acc = (Acc << Job->BitDepth) | Index;
+			AccBits += Job->BitDepth;
+			if (AccBits == 8) {
+				*Dest++ = (uint8_t)Acc;
+				Acc = 0;
+				AccBits = 0;
+			}
+		}
+		if (AccBits != 0) {
+			*Dest = (uint8_t)(Acc << (8 - AccBits));
+		}
+	}
+}
+
+static inline uint8_t Paeth(int a, int b, int c) {
+	int p = a + b - c;
+	int pa = abs(p - a);
+	int pb = abs(p - b);
+	int pc = abs(p - c);
+
+	if (pa <= pb && pa <= pc) {
+		return (uint8_t)a;
+	}
+	return (uint8_t)(pb <= pc ? b : c);
+}
+
+//*******************************************************************************
+//
+//  static void FilterRow(uint8_t* Dest, const uint8_t* Row, const uint8_t* Prev,
+//							int RowBytes, int PixelBytes, uint8_t* Work)
+//
+// Write the filter type and filtered row.  Palette images are not filtered,
+// for RGB images the filter with the smallest sum of absolute differences
+// is used, none, sub, up or Paeth.
+//
+// Work					3 x RowBytes
+//
+//*******************************************************************************
+static void FilterRow(uint8_t* Dest, const uint8_t* Row, const uint8_t* Prev, int RowBytes, int PixelBytes,
+	uint8_t* Work) {
+	if (PixelBytes == 1) {
+		Dest[0] = 0;
+		memcpy(Dest + 1, Row, RowBytes);
+		return;
+	}
+
+	uint8_t* Sub = Work;
+	uint8_t* Up = Work + RowBytes;
+	uint8_t* Pth = Work + 2 * RowBytes;
+	unsigned SumNone = 0, SumSub = 0, SumUp = 0, SumPaeth = 0;
+
+	for (int i = 0; i < RowBytes; i++) {
+		int a = i >= PixelBytes ? Row[i - PixelBytes] : 0;
+		int b = Prev[i];
+		int c = i >= PixelBytes ? Prev[i - PixelBytes] : 0;
+
+		Sub[i] = (uint8_t)(Row[i] - a);
+		Up[i] = (uint8_t)(Row[i] - b);
+		Pth[i] = (uint8_t)(Row[i] - Paeth(a, b, c));
+		SumNone += abs((signed char)Row[i]);
+		SumSub += abs((signed char)Sub[i]);
+		SumUp += abs((signed char)Up[i]);
+		SumPaeth += abs((signed char)Pth[i]);
+	}
+
+	const uint8_t* Best = Row;
+	uint8_t Type = 0;
+	unsigned BestSum = SumNone;
+	if (SumSub < BestSum) {
+		Best = Sub;
+		Type = 1;
+		BestSum = SumSub;
+	}
+	if (SumUp < BestSum) {
+		Best = Up;
+		Type = 2;
+		BestSum = SumUp;
+	}
+	if (SumPaeth < BestSum) {
+		Best = Pth;
+		Type = 4;
+	}
+	Dest[0] = Type;
+	memcpy(Dest + 1, Best, RowBytes);
+}
+
+//*******************************************************************************
+//
+//  static void CompressTask(void* Context, int Band)
+//
+// ParallelFor task, filter and compress one band of the chunk
+//
+//*******************************************************************************
+static void CompressTask(void* Context, int Band) {
+	PNGJOB* Job = (PNGJOB*)Context;
+	PNGBAND* Result = Job->Bands + Band;
+	int First = Band * Job->BandRows;
+	int End = std::min(First + Job->BandRows, Job->NumRows);
+	size_t FilteredRow = (size_t)Job->RawRowBytes + 1;
+	uint8_t* Filtered = Job->Filtered + (size_t)First * FilteredRow;
+	uint8_t* Out = Job->Out + (size_t)Band * Job->BandOutSize;
+	uint8_t* Scratch;
+
+	Scratch = (uint8_t*)malloc(DeflateScratchSize() + 3 * (size_t)Job->RawRowBytes);
+	if (Scratch == NULL) {
+		Job->Failed = 1;
+		return;
+	}
+
+	for (int y = First; y < End; y++) {
+		FilterRow(Filtered + (size_t)(y - First) * FilteredRow,
+			Job->Packed + (size_t)(y + 1) * Job->RawRowBytes,
+			Job->Packed + (size_t)y * Job->RawRowBytes,
+			Job->RawRowBytes, Job->PixelBytes, Scratch + DeflateScratchSize());
+	}
+
+	Result->RawLen = (size_t)(End - First) * FilteredRow;
+	Result->Adler = Adler32(1, Filtered, Result->RawLen);
+	Result->OutLen = DeflateBand(Filtered, Result->RawLen, Out, Scratch);
+	Result->CRC = ChunkCRC("IDAT", Out, Result->OutLen);
+	free(Scratch);
+}
+
+//*******************************************************************************
+//
+//  static void RunTasks(PNGJOB* Job, PNGTASK Task)
+//
+// Run Task for each band of the chunk
+//
+//*******************************************************************************
+static void RunTasks(PNGJOB* Job, PNGTASK Task) {
+	if (Job->Output->ParallelFor != NULL) {
+		Job->Output->ParallelFor(Job->NumBands, Task, Job);
+		return;
+	}
+	for (int Band = 0; Band < Job->NumBands; Band++) {
+		Task(Job, Band);
+	}
+}
+
+//*******************************************************************************
+//
+//  static int GetChunk(PNGJOB* Job, int y, PNGPIXEL* RowBuffer)
+//
+// Get the rows of the chunk starting at row y
+//
+//*******************************************************************************
+static int GetChunk(PNGJOB* Job, int y, PNGPIXEL* RowBuffer) {
+	Job->NumRows = std::min(Job->ChunkRows, Job->ysize - y);
+	Job->NumBands = (Job->NumRows + Job->BandRows - 1) / Job->BandRows;
+	if (Job->GetRows != NULL) {
+		Job->Rows = RowBuffer;
+		return Job->GetRows(Job->Context, y, Job->NumRows, RowBuffer);
+	}
+	// without GetRows the context is the image
+	Job->Rows = (const PNGPIXEL*)Job->Context + (size_t)y * Job->xsize;
+	return APP_SUCCESS;
+}
+
+static int CompareColor(const void* a, const void* b) {
+	PNGPIXEL A = *(const PNGPIXEL*)a;
+	PNGPIXEL B = *(const PNGPIXEL*)b;
+	return A < B ? -1 : (A > B ? 1 : 0);
+}
+
+//*******************************************************************************
+//
+//  static int FindPalette(PNGJOB* Job, PNGPIXEL* RowBuffer)
+//
+// Find the colors of the image, stops when there are more than 256.
+// Job->NumColors returns the # of colors, 0 if more than 256.
+//
+//*******************************************************************************
+static int FindPalette(PNGJOB* Job, PNGPIXEL* RowBuffer) {
+	int NumColors = 0;
+	int MaxBands = (Job->ChunkRows + Job->BandRows - 1) / Job->BandRows;
+
+	Job->NumColors = 0;
+	Job->TooManyColors = 0;
+	memset(Job->ColorHash, 0xff, sizeof(Job->ColorHash));
+	Job->BandColors = (PNGPIXEL*)malloc((size_t)MaxBands * 256 * sizeof(PNGPIXEL));
+	Job->BandNumColors = (int*)malloc(MaxBands * sizeof(int));
+	if (Job->BandColors == NULL || Job->BandNumColors == NULL) {
+		free(Job->BandColors);
+		free(Job->BandNumColors);
+		return APPERR_MEMALLOC;
+	}
+
+	int iRes = APP_SUCCESS;
+	for (int y = 0; y < Job->ysize && !Job->TooManyColors; y += Job->ChunkRows) {
+		iRes = GetChunk(Job, y, RowBuffer);
+		if (iRes != APP_SUCCESS) {
+			break;
+		}
+		RunTasks(Job, PaletteTask);
+		if (Job->TooManyColors) {
+			break;
+		}
+
+		// merge the colors of the bands
+		for (int Band = 0; Band < Job->NumBands && !Job->TooManyColors; Band++) {
+			PNGPIXEL* Colors = Job->BandColors + (size_t)Band * 256;
+			for (int i = 0; i < Job->BandNumColors[Band]; i++) {
+				uint32_t h = ColorHash(Colors[i]);
+				while (Job->ColorHash[h] != PNG_NO_COLOR && Job->ColorHash[h] != Colors[i]) {
+					h = (h + 1) & (PNG_COLOR_HASH - 1);
+				}
+				if (Job->ColorHash[h] == Colors[i]) {
+					continue;
+				}
+				if (NumColors == 256) {
+					Job->TooManyColors = 1;
+					break;
+				}
+				Job->ColorHash[h] = Colors[i];
+				Job->Palette[NumColors++] = Colors[i];
+			}
+		}
+	}
+	free(Job->BandColors);
+	free(Job->BandNumColors);
+	Job->BandColors = NULL;
+	Job->BandNumColors = NULL;
+	if (iRes != APP_SUCCESS || Job->TooManyColors) {
+		return iRes;
+	}
+
+	// sorted so the same image always gives the same file
+	qsort(Job->Palette, NumColors, sizeof(PNGPIXEL), CompareColor);
+	memset(Job->ColorHash, 0xff, sizeof(Job->ColorHash));
+	for (int i = 0; i < NumColors; i++) {
+		uint32_t h = ColorHash(Job->Palette[i]);
+		while (Job->ColorHash[h] != PNG_NO_COLOR) {
+			h = (h + 1) & (PNG_COLOR_HASH - 1);
+		}
+		Job->ColorHash[h] = Job->Palette[i];
+		Job->IndexHash[h] = (uint8_t)i;
+	}
+	Job->NumColors = NumColors;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  static int WritePNGchunk(PNGOUTPUT* Output, const char* Type, const uint8_t* Data, size_t Len,
+//							uint32_t CRC)
+//
+// return
+// int					APP_SUCCESS, chunk written
+//						APPERR_FILEWRITE
+//
+//*******************************************************************************
+static int WritePNGchunk(PNGOUTPUT* Output, const char* Type, const uint8_t* Data, size_t Len, uint32_t CRC) {
+	uint8_t Header[8];
+	uint8_t Trailer[4];
+
+	PutDWORD(Header, (uint32_t)Len);
+	memcpy(Header + 4, Type, 4);
+	PutDWORD(Trailer, CRC);
+	if (Output->Write(Output->File, Header, 8) != APP_SUCCESS) {
+		return APPERR_FILEWRITE;
+	}
+	if (Len > 0 && Output->Write(Output->File, Data, Len) != APP_SUCCESS) {
+		return APPERR_FILEWRITE;
+	}
+	return Output->Write(Output->File, Trailer, 4) == APP_SUCCESS ? APP_SUCCESS : APPERR_FILEWRITE;
+}
+
+
+//*******************************************************************************
+//
+//  int EncodePNG(PNGOUTPUT* Output, PNGGETROWS GetRows, void* Context,
+//						int ImageXextent, int ImageYextent)
+//
+// Write a COLORREF image as a PNG file.  Images with 256 colors or less are
+// written as palette images, others as 24 bit RGB.  Bands of rows are
+// compressed in parallel.
+//
+// PNGOUTPUT* Output	writes the file and runs the tasks
+// PNGGETROWS GetRows	creates rows of the image, it is called twice for
+//						each row, once to find the colors and once to
+//						write them
+//						NULL, Context is the image, ImageXextent x ImageYextent
+// void* Context		passed to GetRows()
+//
+// int ImageXextent, ImageYextent	size of the image
+//
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1	Standard application error number
+//
+//*******************************************************************************
+int EncodePNG(PNGOUTPUT* Output, PNGGETROWS GetRows, void* Context, int ImageXextent, int ImageYextent) {
+	PNGJOB* Job;
+	PNGPIXEL* RowBuffer = NULL;
+	int iRes;
+
+	if (Output == NULL || Output->Write == NULL || (GetRows == NULL && Context == NULL) ||
+		ImageXextent <= 0 || ImageYextent <= 0) {
+		return APPERR_PARAMETER;
+	}
+	MakeTables();
+
+	// the job is too large for the stack
+	Job = new (std::nothrow) PNGJOB();
+	if (Job == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	Job->Output = Output;
+	Job->GetRows = GetRows;
+	Job->Context = Context;
+	Job->xsize = ImageXextent;
+	Job->ysize = ImageYextent;
+	Job->BandRows = std::max(1, PNG_BAND_PIXELS / ImageXextent);
+	Job->ChunkRows = std::min(Job->BandRows * std::max(1, Output->NumWorkers) * 2, ImageYextent);
+	if (GetRows != NULL) {
+		RowBuffer = new (std::nothrow) PNGPIXEL[(size_t)Job->ChunkRows * ImageXextent];
+		if (RowBuffer == NULL) {
+			delete Job;
+			return APPERR_MEMALLOC;
+		}
+	}
+
+	iRes = FindPalette(Job, RowBuffer);
+	if (iRes != APP_SUCCESS) {
+		if (RowBuffer) {
+			delete[] RowBuffer;
+		}
+		delete Job;
+		return iRes;
+	}
+
+	if (Job->NumColors == 0) {
+		Job->BitDepth = 8;
+		Job->PixelBytes = 3;
+		Job->RawRowBytes = ImageXextent * 3;
+	}
+	else {
+		if (Job->NumColors <= 2) {
+			Job->BitDepth = 1;
+		}
+		else if (Job->NumColors <= 4) {
+			Job->BitDepth = 2;
+		}
+		else if (Job->NumColors <= 16) {
+			Job->BitDepth = 4;
+		}
+		else {
+			Job->BitDepth = 8;
+		}
+		Job->PixelBytes = 1;
+		Job->RawRowBytes = (int)(((size_t)ImageXextent * Job->BitDepth + 7) / 8);
+	}
+
+	int MaxBands = (Job->ChunkRows + Job->BandRows - 1) / Job->BandRows;
+	size_t BandRawSize = (size_t)Job->BandRows * (Job->RawRowBytes + 1);
+	Job->BandOutSize = BandRawSize + BandRawSize / 1024 + 64;
+	// the previous row is zero for the first row
+	Job->Packed = (uint8_t*)calloc((size_t)(Job->ChunkRows + 1) * Job->RawRowBytes, 1);
+	Job->Filtered = (uint8_t*)malloc((size_t)Job->ChunkRows * (Job->RawRowBytes + 1));
+	Job->Out = (uint8_t*)malloc((size_t)MaxBands * Job->BandOutSize);
+	Job->Bands = (PNGBAND*)malloc(MaxBands * sizeof(PNGBAND));
+	if (Job->Packed == NULL || Job->Filtered == NULL || Job->Out == NULL || Job->Bands == NULL) {
+		iRes = APPERR_MEMALLOC;
+		goto Done;
+	}
+
+	{
+		static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+		uint8_t Header[13];
+		uint8_t Palette[3 * 256];
+		// zlib stream header, deflate with a 32K window
+		uint8_t ZlibHeader[2] = { 0x78, 0x01 };
+		uint32_t Adler = 1;
+
+		PutDWORD(Header, ImageXextent);
+		PutDWORD(Header + 4, ImageYextent);
+		Header[8] = (uint8_t)Job->BitDepth;
+		Header[9] = Job->NumColors == 0 ? 2 : 3;	// RGB or palette
+		Header[10] = 0;		// deflate
+		Header[11] = 0;		// adaptive filtering
+		Header[12] = 0;		// not interlaced
+		for (int i = 0; i < Job->NumColors; i++) {
+			Palette[3 * i] = (uint8_t)Job->Palette[i];
+			Palette[3 * i + 1] = (uint8_t)(Job->Palette[i] >> 8);
+			Palette[3 * i + 2] = (uint8_t)(Job->Palette[i] >> 16);
+		}
+
+		if (Output->Write(Output->File, Signature, 8) != APP_SUCCESS ||
+			WritePNGchunk(Output, "IHDR", Header, 13, ChunkCRC("IHDR", Header, 13)) != APP_SUCCESS ||
+			(Job->NumColors != 0 && WritePNGchunk(Output, "PLTE", Palette, 3 * (size_t)Job->NumColors,
+				ChunkCRC("PLTE", Palette, 3 * (size_t)Job->NumColors)) != APP_SUCCESS) ||
+			WritePNGchunk(Output, "IDAT", ZlibHeader, 2, ChunkCRC("IDAT", ZlibHeader, 2)) != APP_SUCCESS) {
+			iRes = APPERR_FILEWRITE;
+		}
+
+		// each band is written as an IDAT chunk
+		for (int y = 0; y < ImageYextent && iRes == APP_SUCCESS; y += Job->ChunkRows) {
+			iRes = GetChunk(Job, y, RowBuffer);
+			if (iRes != APP_SUCCESS) {
+				break;
+			}
+			RunTasks(Job, PackTask);
+			RunTasks(Job, CompressTask);
+			if (Job->Failed) {
+				iRes = APPERR_MEMALLOC;
+				break;
+			}
+			for (int Band = 0; Band < Job->NumBands; Band++) {
+				PNGBAND* Result = Job->Bands + Band;
+				iRes = WritePNGchunk(Output, "IDAT", Job->Out + (size_t)Band * Job->BandOutSize,
+					Result->OutLen, Result->CRC);
+				if (iRes != APP_SUCCESS) {
+					break;
+				}
+				Adler = CombineAdler32(Adler, Result->Adler, Result->RawLen);
+			}
+			// last row is the previous row of the next chunk
+			memcpy(Job->Packed, Job->Packed + (size_t)Job->NumRows * Job->RawRowBytes, Job->RawRowBytes);
+		}
+
+		if (iRes == APP_SUCCESS) {
+			// final empty fixed Huffman block, then the Adler-32
+			uint8_t Trailer[6] = { 0x03, 0x00 };
+			PutDWORD(Trailer + 2, Adler);
+			iRes = WritePNGchunk(Output, "IDAT", Trailer, 6, ChunkCRC("IDAT", Trailer, 6));
+			if (iRes == APP_SUCCESS) {
+				iRes = WritePNGchunk(Output, "IEND", NULL, 0, ChunkCRC("IEND", NULL, 0));
+			}
+		}
+	}
+
+Done:
+	free(Job->Packed);
+	free(Job->Filtered);
+	free(Job->Out);
+	free(Job->Bands);
+	delete Job;
+	if (RowBuffer) {
+		delete[] RowBuffer;
+	}
+	return iRes;
+}
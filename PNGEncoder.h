@@ -0,0 +1,63 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// PNGEncoder.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations of the PNG file encoder.
+// This does not use any Windows headers so it can be tested without Windows,
+// see Tests/PNGEncoderTest.cpp.  SaveImagePNG() in FileFunctions.cpp writes
+// PNG files with it.
+//
+// V1.2.20	2026-10-17	Initial release
+// V1.2.24	2026-10-17	Windows file and thread pool functions replaced by PNGOUTPUT,
+//						SaveImagePNG() and GetPNGfilename() moved to FileFunctions.cpp
+//
+#include <stddef.h>
+#include <stdint.h>
+
+// pixels in each band of rows compressed by a task
+#define PNG_BAND_PIXELS (256*1024)
+// deflate symbols in each compressed block
+#define PNG_BLOCK_SYMBOLS (32*1024)
+// hash chain entries searched for each match
+#define PNG_MAX_CHAIN 32
+
+// pixel of an image, same layout as a COLORREF
+typedef uint32_t PNGPIXEL;
+
+// Called to create rows of the image, y is the first row, Rows is
+// NumRows x the image width
+// return APP_SUCCESS or a standard application error number
+typedef int (*PNGGETROWS)(void* Context, int y, int NumRows, PNGPIXEL* Rows);
+
+// task run for each Index from 0 to Count - 1
+typedef void (*PNGTASK)(void* Context, int Index);
+
+// where the PNG file goes and how its tasks are run
+typedef struct {
+	// write Len bytes to File
+	// return APP_SUCCESS or APPERR_FILEWRITE
+	int (*Write)(void* File, const uint8_t* Data, size_t Len);
+	void* File;
+	// run Task for Index 0 to Count - 1 and return when all are done,
+	// NULL runs the tasks one after the other
+	void (*ParallelFor)(int Count, PNGTASK Task, void* Context);
+	int NumWorkers;					// tasks run at the same time
+} PNGOUTPUT;
+
+// function prototypes
+int EncodePNG(PNGOUTPUT* Output, PNGGETROWS GetRows, void* Context, int ImageXextent, int ImageYextent);
@@ -0,0 +1,107 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ParallelTasks.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the functions for running tasks in parallel
+//
+// ParallelFor() runs a task for each index using the calling thread plus
+// up to one Windows thread pool callback per processor.  Each thread takes
+// the next index until all are done, so tasks that take different amounts
+// of time are still spread over the threads.  If the thread pool can't be
+// used the tasks are all run on the calling thread.
+//
+// V1.2.6	2026-10-17	Initial release
+//
+#include "framework.h"
+#include "ParallelTasks.h"
+
+typedef struct {
+	PARALLELTASK Task;
+	void* Context;
+	LONG Count;
+	volatile LONG Next;		// next index to run
+} PARALLELJOB;
+
+static void RunTasks(PARALLELJOB* Job) {
+	LONG Index;
+
+	while ((Index = InterlockedIncrement(&Job->Next) - 1) < Job->Count) {
+		Job->Task(Job->Context, (int)Index);
+	}
+}
+
+static VOID CALLBACK TaskCallback(PTP_CALLBACK_INSTANCE Instance, PVOID Context, PTP_WORK Work) {
+	RunTasks((PARALLELJOB*)Context);
+}
+
+//*******************************************************************************
+//
+//  int GetNumWorkers(void)
+//
+// return
+// int					# of threads that ParallelFor() can use, this is the
+//						# of processors
+//
+//*******************************************************************************
+int GetNumWorkers(void) {
+	static int NumWorkers = 0;
+
+	if (NumWorkers == 0) {
+		DWORD NumProcessors = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+		NumWorkers = (NumProcessors > 0) ? (int)NumProcessors : 1;
+	}
+	return NumWorkers;
+}
+
+//*******************************************************************************
+//
+//  void ParallelFor(int Count, PARALLELTASK Task, void* Context)
+//
+// Run Task(Context, Index) for Index 0 to Count-1.
+// This returns when all of the tasks are done.
+//
+// int Count			# of tasks
+// PARALLELTASK Task	task function
+// void* Context		passed to each task
+//
+//*******************************************************************************
+void ParallelFor(int Count, PARALLELTASK Task, void* Context) {
+	PARALLELJOB Job = { Task, Context, Count, 0 };
+	PTP_WORK Work = NULL;
+	// the calling thread is also used
+	int Callbacks = min(GetNumWorkers(), Count) - 1;
+
+	if (Count <= 0) {
+		return;
+	}
+
+	if (Callbacks > 0) {
+		Work = CreateThreadpoolWork(TaskCallback, &Job, NULL);
+	}
+	if (Work != NULL) {
+		for (int i = 0; i < Callbacks; i++) {
+			SubmitThreadpoolWork(Work);
+		}
+	}
+
+	RunTasks(&Job);
+
+	if (Work != NULL) {
+		WaitForThreadpoolWorkCallbacks(Work, FALSE);
+		CloseThreadpoolWork(Work);
+	}
+}
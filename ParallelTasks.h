@@ -0,0 +1,33 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// ParallelTasks.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the forward declarations for running tasks in parallel
+// using the Windows thread pool
+//
+// V1.2.6	2026-10-17	Initial release
+//
+#include "framework.h"
+
+// A task is called once for each Index, 0 to Count-1, from ParallelFor()
+// Tasks can run at the same time on different threads, in any order.
+typedef void (*PARALLELTASK)(void* Context, int Index);
+
+// function prototypes
+int GetNumWorkers(void);
+void ParallelFor(int Count, PARALLELTASK Task, void* Context);
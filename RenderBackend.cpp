@@ -0,0 +1,316 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// RenderBackend.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the image surface, the bitmap of the displayed image, and
+// the software framebuffer backend.  The Direct2D backend is in D2DBackend.cpp.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include <string.h>
+#include <new>
+#include "AppErrors.h"
+#include "RenderBackend.h"
+
+//*******************************************************************************
+//
+//  void ImageSurface::SetBackend(RenderBackend* NewBackend)
+//
+//  Set the backend the bitmap is created with, the bitmap of the old
+//  backend is released.
+//
+//*******************************************************************************
+void ImageSurface::SetBackend(RenderBackend* NewBackend)
+{
+	if (NewBackend != Backend) {
+		Release();
+		Backend = NewBackend;
+	}
+	return;
+}
+
+//*******************************************************************************
+//
+//  int ImageSurface::Load(int xsize, int ysize, const RENDERPIXEL* Image, const RENDERRECT* Changed)
+//
+//  Copy an image to the bitmap.  When the bitmap is the same size only the
+//  changed region of the image is copied, otherwise the bitmap is created
+//  again from the whole image.
+//
+//  int xsize, ysize		size of the image
+//  RENDERPIXEL* Image		image
+//  RENDERRECT* Changed		region of the image changed since the last load,
+//							NULL, the whole image
+//
+// return
+// int              APP_SUCCESS
+//                  APPERR_DEVICELOST, the bitmap was released, create the
+//                  render target again then load the whole image
+//                  or a standard application error number
+//
+//*******************************************************************************
+int ImageSurface::Load(int xsize, int ysize, const RENDERPIXEL* Image, const RENDERRECT* Changed)
+{
+	int iRes;
+
+	if (Backend == NULL || Image == NULL || xsize <= 0 || ysize <= 0) {
+		return APPERR_PARAMETER;
+	}
+
+	if (Bitmap != NULL && xsize == Xsize && ysize == Ysize) {
+		// same size, copy the changed region
+		RENDERRECT Rect = { 0, 0, xsize, ysize };
+		if (Changed != NULL) {
+			Rect.left = Changed->left > 0 ? Changed->left : 0;
+			Rect.top = Changed->top > 0 ? Changed->top : 0;
+			Rect.right = Changed->right < xsize ? Changed->right : xsize;
+			Rect.bottom = Changed->bottom < ysize ? Changed->bottom : ysize;
+			if (Rect.left >= Rect.right || Rect.top >= Rect.bottom) {
+				return APP_SUCCESS;
+			}
+		}
+		iRes = Backend->CopyFromMemory(Bitmap, &Rect, Image + (size_t)Rect.top * xsize + Rect.left, xsize);
+		if (iRes == APP_SUCCESS || iRes == APPERR_DEVICELOST) {
+			if (iRes == APPERR_DEVICELOST) {
+				Release();
+			}
+			return iRes;
+		}
+	}
+
+	// new size, or the bitmap could not be copied to
+	Release();
+	iRes = Backend->CreateBitmap(xsize, ysize, Image, xsize, &Bitmap);
+	if (iRes != APP_SUCCESS) {
+		Bitmap = NULL;
+		return iRes;
+	}
+	Xsize = xsize;
+	Ysize = ysize;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  void ImageSurface::Release(void)
+//
+//*******************************************************************************
+void ImageSurface::Release(void)
+{
+	if (Bitmap != NULL) {
+		Backend->ReleaseBitmap(Bitmap);
+		Bitmap = NULL;
+	}
+	Xsize = 0;
+	Ysize = 0;
+	return;
+}
+
+//*******************************************************************************
+//
+//  RENDERBITMAP ImageSurface::GetBitmap(void)
+//
+// return
+// RENDERBITMAP		bitmap of the image, NULL if there is none
+//
+//*******************************************************************************
+RENDERBITMAP ImageSurface::GetBitmap(void)
+{
+	return Bitmap;
+}
+
+//*******************************************************************************
+//
+//  SoftwareBackend
+//
+//*******************************************************************************
+SoftwareBackend::~SoftwareBackend()
+{
+	if (Framebuffer) {
+		delete[] Framebuffer;
+		Framebuffer = NULL;
+	}
+}
+
+//*******************************************************************************
+//
+//  int SoftwareBackend::Resize(int xsize, int ysize)
+//
+//  The framebuffer is only created again when the size changes
+//
+//*******************************************************************************
+int SoftwareBackend::Resize(int xsize, int ysize)
+{
+	if (xsize <= 0 || ysize <= 0) {
+		return APPERR_PARAMETER;
+	}
+	if (Framebuffer != NULL && xsize == FramebufferXsize && ysize == FramebufferYsize) {
+		return APP_SUCCESS;
+	}
+	if (Framebuffer) {
+		delete[] Framebuffer;
+	}
+	Framebuffer = new (std::nothrow) RENDERPIXEL[(size_t)xsize * ysize];
+	if (Framebuffer == NULL) {
+		FramebufferXsize = 0;
+		FramebufferYsize = 0;
+		return APPERR_MEMALLOC;
+	}
+	memset(Framebuffer, 0, (size_t)xsize * ysize * sizeof(RENDERPIXEL));
+	FramebufferXsize = xsize;
+	FramebufferYsize = ysize;
+	NumResizes++;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int SoftwareBackend::CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch,
+//								RENDERBITMAP* Bitmap)
+//
+//*******************************************************************************
+int SoftwareBackend::CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch,
+	RENDERBITMAP* Bitmap)
+{
+	SOFTWAREBITMAP* New;
+
+	*Bitmap = NULL;
+	if (xsize <= 0 || ysize <= 0) {
+		return APPERR_PARAMETER;
+	}
+	New = new (std::nothrow) SOFTWAREBITMAP;
+	if (New == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	New->Pixels = new (std::nothrow) RENDERPIXEL[(size_t)xsize * ysize];
+	if (New->Pixels == NULL) {
+		delete New;
+		return APPERR_MEMALLOC;
+	}
+	New->Xsize = xsize;
+	New->Ysize = ysize;
+	New->Generation = Generation;
+	for (int y = 0; y < ysize; y++) {
+		memcpy(New->Pixels + (size_t)y * xsize, Pixels + (size_t)y * Pitch, (size_t)xsize * sizeof(RENDERPIXEL));
+	}
+	NumBitmaps++;
+	*Bitmap = New;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  int SoftwareBackend::CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest,
+//								const RENDERPIXEL* Pixels, size_t Pitch)
+//
+//*******************************************************************************
+int SoftwareBackend::CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels,
+	size_t Pitch)
+{
+	SOFTWAREBITMAP* Target = (SOFTWAREBITMAP*)Bitmap;
+
+	if (Target == NULL || Dest->left < 0 || Dest->top < 0 ||
+		Dest->right > Target->Xsize || Dest->bottom > Target->Ysize ||
+		Dest->left >= Dest->right || Dest->top >= Dest->bottom) {
+		return APPERR_PARAMETER;
+	}
+	if (Target->Generation != Generation) {
+		return APPERR_DEVICELOST;
+	}
+	int Width = Dest->right - Dest->left;
+	for (int y = Dest->top; y < Dest->bottom; y++) {
+		memcpy(Target->Pixels + (size_t)y * Target->Xsize + Dest->left, Pixels + (size_t)(y - Dest->top) * Pitch,
+			(size_t)Width * sizeof(RENDERPIXEL));
+	}
+	NumCopies++;
+	PixelsCopied += (size_t)Width * (Dest->bottom - Dest->top);
+	LastCopy = *Dest;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  void SoftwareBackend::ReleaseBitmap(RENDERBITMAP Bitmap)
+//
+//*******************************************************************************
+void SoftwareBackend::ReleaseBitmap(RENDERBITMAP Bitmap)
+{
+	SOFTWAREBITMAP* Target = (SOFTWAREBITMAP*)Bitmap;
+
+	if (Target) {
+		delete[] Target->Pixels;
+		delete Target;
+	}
+	return;
+}
+
+//*******************************************************************************
+//
+//  void SoftwareBackend::Draw(RENDERBITMAP Bitmap, int x, int y)
+//
+//  Draw a bitmap full size with its upper left corner at framebuffer pixel x, y
+//
+//*******************************************************************************
+void SoftwareBackend::Draw(RENDERBITMAP Bitmap, int x, int y)
+{
+	SOFTWAREBITMAP* Source = (SOFTWAREBITMAP*)Bitmap;
+
+	if (Source == NULL || Framebuffer == NULL) {
+		return;
+	}
+	int Left = x > 0 ? x : 0;
+	int Top = y > 0 ? y : 0;
+	int Right = x + Source->Xsize < FramebufferXsize ? x + Source->Xsize : FramebufferXsize;
+	int Bottom = y + Source->Ysize < FramebufferYsize ? y + Source->Ysize : FramebufferYsize;
+	if (Left >= Right || Top >= Bottom) {
+		return;
+	}
+	for (int fy = Top; fy < Bottom; fy++) {
+		memcpy(Framebuffer + (size_t)fy * FramebufferXsize + Left,
+			Source->Pixels + (size_t)(fy - y) * Source->Xsize + (Left - x),
+			(size_t)(Right - Left) * sizeof(RENDERPIXEL));
+	}
+	return;
+}
+
+//*******************************************************************************
+//
+//  void SoftwareBackend::LoseDevice(void)
+//
+//  Act as if the device was lost, the existing bitmaps can't be copied to
+//
+//*******************************************************************************
+void SoftwareBackend::LoseDevice(void)
+{
+	Generation++;
+	return;
+}
+
+//*******************************************************************************
+//
+//  const RENDERPIXEL* SoftwareBackend::GetFramebuffer(int* xsize, int* ysize)
+//
+//*******************************************************************************
+const RENDERPIXEL* SoftwareBackend::GetFramebuffer(int* xsize, int* ysize)
+{
+	*xsize = FramebufferXsize;
+	*ysize = FramebufferYsize;
+	return Framebuffer;
+}
@@ -0,0 +1,151 @@
+#pragma once
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// RenderBackend.h
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the bitmap interface used by the image window and the
+// image surface that keeps the bitmap of the displayed image.
+// This does not use any Windows headers so it can be tested without a window,
+// see Tests/RenderBackendTest.cpp.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include <stddef.h>
+#include <stdint.h>
+
+// pixel of a render bitmap, same layout as a COLORREF
+typedef uint32_t RENDERPIXEL;
+
+// bitmap of a backend, NULL is no bitmap
+typedef void* RENDERBITMAP;
+
+// region of a bitmap, right and bottom are excluded, same layout as a RECT
+typedef struct {
+	int32_t left;
+	int32_t top;
+	int32_t right;
+	int32_t bottom;
+} RENDERRECT;
+
+//*******************************************************************************
+//
+// RenderBackend
+//
+// The bitmap operations of a render target.  The functions return APP_SUCCESS,
+// APPERR_DEVICELOST when the target and all of its bitmaps have to be created
+// again, or another standard application error number.
+//
+//*******************************************************************************
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {
+	};
+
+	// size the render target, bitmaps are kept
+	virtual int Resize(int xsize, int ysize) = 0;
+
+	// create a bitmap from Pixels, Pitch is pixels from one row of Pixels to the next
+	virtual int CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch,
+		RENDERBITMAP* Bitmap) = 0;
+
+	// copy region Dest of the bitmap from Pixels, which is the upper left pixel of Dest
+	virtual int CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels,
+		size_t Pitch) = 0;
+
+	virtual void ReleaseBitmap(RENDERBITMAP Bitmap) = 0;
+};
+
+//*******************************************************************************
+//
+// ImageSurface
+//
+// The bitmap of the displayed image.  The bitmap is kept while the image size
+// is the same and only the changed region is copied to it.  It is created
+// again when the size changes or the backend reports the device was lost.
+//
+//*******************************************************************************
+class ImageSurface
+{
+private:
+	RenderBackend* Backend = NULL;
+	RENDERBITMAP Bitmap = NULL;
+	int Xsize = 0;
+	int Ysize = 0;
+
+public:
+	ImageSurface() {
+	};
+
+	~ImageSurface() {
+		Release();
+	};
+
+	void SetBackend(RenderBackend* NewBackend);
+	int Load(int xsize, int ysize, const RENDERPIXEL* Image, const RENDERRECT* Changed);
+	void Release(void);
+	RENDERBITMAP GetBitmap(void);
+};
+
+//*******************************************************************************
+//
+// SoftwareBackend
+//
+// Render target that is a framebuffer in memory, bitmaps are pixel arrays.
+// The backend calls are counted so the copies to the bitmaps can be checked.
+//
+//*******************************************************************************
+typedef struct {
+	int Xsize;
+	int Ysize;
+	int Generation;					// device generation the bitmap was created in
+	RENDERPIXEL* Pixels;
+} SOFTWAREBITMAP;
+
+class SoftwareBackend : public RenderBackend
+{
+private:
+	RENDERPIXEL* Framebuffer = NULL;
+	int FramebufferXsize = 0;
+	int FramebufferYsize = 0;
+	int Generation = 0;				// incremented when the device is lost
+
+public:
+	// counts of backend calls
+	int NumResizes = 0;				// framebuffer created again
+	int NumBitmaps = 0;				// bitmaps created
+	int NumCopies = 0;				// CopyFromMemory calls
+	size_t PixelsCopied = 0;		// pixels copied by CopyFromMemory
+	RENDERRECT LastCopy = { 0, 0, 0, 0 };	// Dest of the last CopyFromMemory
+
+	SoftwareBackend() {
+	};
+
+	~SoftwareBackend();
+
+	int Resize(int xsize, int ysize);
+	int CreateBitmap(int xsize, int ysize, const RENDERPIXEL* Pixels, size_t Pitch, RENDERBITMAP* Bitmap);
+	int CopyFromMemory(RENDERBITMAP Bitmap, const RENDERRECT* Dest, const RENDERPIXEL* Pixels, size_t Pitch);
+	void ReleaseBitmap(RENDERBITMAP Bitmap);
+
+	void Draw(RENDERBITMAP Bitmap, int x, int y);
+	void LoseDevice(void);
+	const RENDERPIXEL* GetFramebuffer(int* xsize, int* ysize);
+};
@@ -0,0 +1,252 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// OverlayRemapTest.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Test of the color lookup row kernels, no window is needed.  The SSE2 and
+// AVX2 kernels are run on random coverage and footprint masks and lookup
+// tables and must give the same pixels as RemapRowScalar, including rows
+// that are shorter than a vector or not a multiple of one.  The AVX2 kernel
+// is only run when the processor supports it.
+// The colors from BuildRemapLUT() and RemapOverlayColorRow() must be the
+// same as adding the layers to the overlay one at a time, including mixed
+// colors that are exactly the overlay color.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "OverlayRemap.h"
+
+static int NumFailed = 0;
+
+#define CHECK(Condition) \
+	if (!(Condition)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #Condition); \
+		NumFailed++; \
+	}
+
+// pixels before and after the row, a kernel must not change them
+#define GUARD_PIXELS 16
+#define GUARD_COLOR 0xdeadbeefu
+
+static uint32_t RandomState = 12345;
+
+static uint32_t Random(void)
+{
+	// xorshift, the same numbers on every run
+	RandomState ^= RandomState << 13;
+	RandomState ^= RandomState >> 17;
+	RandomState ^= RandomState << 5;
+	return RandomState;
+}
+
+// random masks, made of runs so that the kernels see blocks of equal pixels
+// as well as blocks with different pixels
+static void FillMasks(uint8_t* Coverage, uint8_t* Footprint, int Count)
+{
+	int i = 0;
+
+	while (i < Count) {
+		int Run = (int)(Random() % 40) + 1;
+		uint8_t Cov = (uint8_t)Random();
+		uint8_t Fp = (uint8_t)(Random() | Cov);
+		bool Noisy = (Random() % 4) == 0;
+
+		for (int j = 0; j < Run && i < Count; j++, i++) {
+			if (Noisy) {
+				Cov = (uint8_t)Random();
+				Fp = (uint8_t)(Random() | Cov);
+			}
+			Coverage[i] = Cov;
+			Footprint[i] = Fp;
+		}
+	}
+}
+
+// run Kernel on a row of Count pixels starting at Offset and compare it to RemapRowScalar
+static bool SameAsScalar(REMAPROW Kernel, int Count, int Offset, const REMAPPIXEL* LUT, uint8_t Used)
+{
+	std::vector<uint8_t> Coverage(Count + Offset + 1);
+	std::vector<uint8_t> Footprint(Count + Offset + 1);
+	std::vector<REMAPPIXEL> Expected(Count + 2 * GUARD_PIXELS, GUARD_COLOR);
+	std::vector<REMAPPIXEL> Actual(Count + 2 * GUARD_PIXELS + Offset, GUARD_COLOR);
+
+	FillMasks(Coverage.data() + Offset, Footprint.data() + Offset, Count);
+	RemapRowScalar(Expected.data() + GUARD_PIXELS, Coverage.data() + Offset, Footprint.data() + Offset,
+		Count, LUT, Used);
+	Kernel(Actual.data() + GUARD_PIXELS + Offset, Coverage.data() + Offset, Footprint.data() + Offset,
+		Count, LUT, Used);
+
+	for (int i = 0; i < Count + 2 * GUARD_PIXELS; i++) {
+		if (Actual[i + Offset] != Expected[i]) {
+			printf("Count %d offset %d used %02x: pixel %d is %08x, expected %08x\n",
+				Count, Offset, Used, i - GUARD_PIXELS, Actual[i + Offset], Expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void TestKernel(REMAPROW Kernel)
+{
+	static const int Counts[] = { 1001, 1024, 255, 127, 100, 65, 64, 63, 48, 33, 32, 31 };
+	static const uint8_t UsedMasks[] = { 0x00, 0xff, 0x01, 0x80, 0x55 };
+	REMAPPIXEL LUT[512];
+
+	for (int Pass = 0; Pass < 20; Pass++) {
+		for (int i = 0; i < 512; i++) {
+			// few colors, so that neighboring pixels often have the same color
+			LUT[i] = (Pass & 1) ? (Random() & 0xffffff) : (Random() % 3) * 0x404040;
+		}
+		uint8_t Used = (Pass < 5) ? UsedMasks[Pass] : (uint8_t)Random();
+
+		// every row width under two vectors, then some longer rows
+		for (int Count = 0; Count <= 40; Count++) {
+			CHECK(SameAsScalar(Kernel, Count, Pass % 4, LUT, Used));
+		}
+		for (int Count : Counts) {
+			CHECK(SameAsScalar(Kernel, Count, Pass % 4, LUT, Used));
+		}
+	}
+}
+
+// overlay pixel from adding the layers one at a time, as Layers did before the masks
+static REMAPPIXEL CompositePixel(uint8_t Coverage, uint8_t Footprint, const REMAPPIXEL* LayerColors,
+	const bool* Enabled, REMAPPIXEL Background, REMAPPIXEL OverlayColor)
+{
+	REMAPPIXEL Pixel = OverlayColor;
+
+	for (int Layer = 0; Layer < REMAP_LAYERS; Layer++) {
+		if (!Enabled[Layer] || LayerColors[Layer] == OverlayColor || !(Footprint & (1 << Layer))) {
+			continue;
+		}
+		if (!(Coverage & (1 << Layer))) {
+			if (Pixel != Background && Pixel != OverlayColor) {
+				continue;
+			}
+			Pixel = Background;
+		}
+		else if (Pixel == Background || Pixel == OverlayColor) {
+			Pixel = LayerColors[Layer];
+		}
+		else {
+			Pixel = MixColors(Pixel, LayerColors[Layer]);
+		}
+	}
+	return Pixel;
+}
+
+static void TestColors(void)
+{
+	static const int Count = 4096;
+	std::vector<uint8_t> Coverage(Count);
+	std::vector<uint8_t> Footprint(Count);
+	std::vector<REMAPPIXEL> Overlay(Count);
+	REMAPPIXEL LUT[512];
+	REMAPPIXEL LayerColors[REMAP_LAYERS];
+	bool Enabled[REMAP_LAYERS];
+	int NumMixedOverlay = 0;		// pixels mixed to the overlay color, kept
+	int NumMixedBackground = 0;		// pixels mixed to the overlay color, then a later 0 pixel
+
+	for (int Pass = 0; Pass < 200; Pass++) {
+		REMAPPIXEL Background = (Pass & 1) ? 0x000000 : 0x101010;
+		REMAPPIXEL OverlayColor = 0x808080;
+		uint8_t Used = 0;
+
+		for (int Layer = 0; Layer < REMAP_LAYERS; Layer++) {
+			LayerColors[Layer] = Random() & 0xffffff;
+			if (Random() % 8 == 0) {
+				LayerColors[Layer] = Background;
+			}
+			Enabled[Layer] = (Random() % 5) != 0;
+		}
+		if (Pass % 4 != 3) {
+			// the overlay color is a mix of two or three layer colors
+			int First = (int)(Random() % REMAP_LAYERS);
+			int Second = (int)(Random() % REMAP_LAYERS);
+			OverlayColor = MixColors(LayerColors[First], LayerColors[Second]);
+			if (Pass & 2) {
+				OverlayColor = MixColors(OverlayColor, LayerColors[Random() % REMAP_LAYERS]);
+			}
+		}
+		for (int Layer = 0; Layer < REMAP_LAYERS; Layer++) {
+			if (Enabled[Layer] && LayerColors[Layer] != OverlayColor) {
+				Used |= (uint8_t)(1 << Layer);
+			}
+		}
+
+		int NumOverlayColor = BuildRemapLUT(LUT, LayerColors, Used, Background, OverlayColor);
+		FillMasks(Coverage.data(), Footprint.data(), Count);
+		RemapRowScalar(Overlay.data(), Coverage.data(), Footprint.data(), Count, LUT, Used);
+		if (NumOverlayColor > 0) {
+			RemapOverlayColorRow(Overlay.data(), Coverage.data(), Footprint.data(), Count, Used,
+				Background, OverlayColor);
+		}
+
+		int NumWrong = 0;
+		for (int i = 0; i < Count; i++) {
+			REMAPPIXEL Expected = CompositePixel(Coverage[i], Footprint[i], LayerColors, Enabled,
+				Background, OverlayColor);
+			if (Overlay[i] != Expected) {
+				NumWrong++;
+			}
+			if (Coverage[i] & Used) {
+				if (LUT[Coverage[i]] == OverlayColor) {
+					if (Expected == OverlayColor) {
+						NumMixedOverlay++;
+					}
+					else {
+						NumMixedBackground++;
+					}
+				}
+			}
+		}
+		CHECK(NumWrong == 0);
+	}
+	// both cases of mixed colors that are the overlay color were tested
+	CHECK(NumMixedOverlay > 0);
+	CHECK(NumMixedBackground > 0);
+}
+
+static bool HasAVX2(void)
+{
+#if defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+int main(void)
+{
+	TestColors();
+	TestKernel(RemapRowSSE2);
+	if (HasAVX2()) {
+		TestKernel(RemapRowAVX2);
+	}
+	else {
+		printf("OverlayRemapTest: no AVX2, RemapRowAVX2 not tested\n");
+	}
+
+	if (NumFailed) {
+		printf("OverlayRemapTest: %d checks failed\n", NumFailed);
+		return 1;
+	}
+	printf("OverlayRemapTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,623 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// PNGEncoderTest.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Round trip test of the PNG encoder, no Windows is needed.  Images are
+// encoded to memory by EncodePNG(), then decoded by the small PNG decoder
+// below (chunk CRCs, inflate, Adler-32, unfiltering and unpacking) and
+// compared to the original pixels.  Images with 2, 4, 16 and 256 colors
+// must be written as 1, 2, 4 and 8 bit palette images, others as RGB.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+#include <thread>
+#include <vector>
+#include "AppErrors.h"
+#include "PNGEncoder.h"
+
+static int NumFailed = 0;
+
+#define CHECK(Condition) \
+	if (!(Condition)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #Condition); \
+		NumFailed++; \
+	}
+
+//*******************************************************************************
+//
+// PNGOUTPUT functions, the file is written to a vector
+//
+//*******************************************************************************
+static int WriteMemory(void* File, const uint8_t* Data, size_t Len)
+{
+	std::vector<uint8_t>* Out = (std::vector<uint8_t>*)File;
+
+	Out->insert(Out->end(), Data, Data + Len);
+	return APP_SUCCESS;
+}
+
+// fails once Limit bytes have been written
+static size_t WriteLimit;
+static int WriteLimited(void* File, const uint8_t* Data, size_t Len)
+{
+	std::vector<uint8_t>* Out = (std::vector<uint8_t>*)File;
+
+	if (Out->size() + Len > WriteLimit) {
+		return APPERR_FILEWRITE;
+	}
+	return WriteMemory(File, Data, Len);
+}
+
+// one thread per task
+static void ThreadParallelFor(int Count, PNGTASK Task, void* Context)
+{
+	std::vector<std::thread> Threads;
+
+	for (int i = 0; i < Count; i++) {
+		Threads.emplace_back(Task, Context, i);
+	}
+	for (size_t i = 0; i < Threads.size(); i++) {
+		Threads[i].join();
+	}
+}
+
+//*******************************************************************************
+//
+// Inflate, RFC 1951
+//
+//*******************************************************************************
+typedef struct {
+	const uint8_t* In;
+	size_t InLen;
+	size_t Pos;
+	uint32_t Bits;
+	int NumBits;
+	bool Error;
+	std::vector<uint8_t>* Out;
+} INFLATE;
+
+typedef struct {
+	short Count[16];		// codes of each length
+	short Symbol[320];		// symbols in code order
+} HUFFMAN;
+
+static int GetBits(INFLATE* S, int Need)
+{
+	uint32_t Value = S->Bits;
+
+	while (S->NumBits < Need) {
+		if (S->Pos >= S->InLen) {
+			S->Error = true;
+			return 0;
+		}
+		Value |= (uint32_t)S->In[S->Pos++] << S->NumBits;
+		S->NumBits += 8;
+	}
+	S->Bits = Value >> Need;
+	S->NumBits -= Need;
+	return (int)(Value & ((1u << Need) - 1));
+}
+
+static bool MakeHuffman(HUFFMAN* H, const short* Lengths, int NumSyms)
+{
+	short Offs[16];
+	int Left = 1;
+
+	memset(H->Count, 0, sizeof(H->Count));
+	for (int s = 0; s < NumSyms; s++) {
+		H->Count[Lengths[s]]++;
+	}
+	for (int Len = 1; Len < 16; Len++) {
+		Left = (Left << 1) - H->Count[Len];
+		if (Left < 0) {
+			return false;			// over subscribed
+		}
+	}
+	Offs[1] = 0;
+	for (int Len = 1; Len < 15; Len++) {
+		Offs[Len + 1] = Offs[Len] + H->Count[Len];
+	}
+	for (int s = 0; s < NumSyms; s++) {
+		if (Lengths[s] != 0) {
+			H->Symbol[Offs[Lengths[s]]++] = (short)s;
+		}
+	}
+	return true;
+}
+
+static int Decode(INFLATE* S, const HUFFMAN* H)
+{
+	int Code = 0;
+	int First = 0;
+	int Index = 0;
+
+	for (int Len = 1; Len < 16; Len++) {
+		Code |= GetBits(S, 1);
+		int Count = H->Count[Len];
+		if (Code - Count < First) {
+			return H->Symbol[Index + (Code - First)];
+		}
+		Index += Count;
+		First += Count;
+		First <<= 1;
+		Code <<= 1;
+	}
+	S->Error = true;
+	return 0;
+}
+
+static bool InflateCodes(INFLATE* S, const HUFFMAN* Lit, const HUFFMAN* Dist)
+{
+	static const short LBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const short LExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const short DBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static const short DExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	for (;;) {
+		int Sym = Decode(S, Lit);
+		if (S->Error) {
+			return false;
+		}
+		if (Sym < 256) {
+			S->Out->push_back((uint8_t)Sym);
+			continue;
+		}
+		if (Sym == 256) {
+			return true;
+		}
+		Sym -= 257;
+		if (Sym >= 29) {
+			return false;
+		}
+		int Len = LBase[Sym] + GetBits(S, LExtra[Sym]);
+		int DSym = Decode(S, Dist);
+		if (S->Error || DSym >= 30) {
+			return false;
+		}
+		size_t Back = (size_t)DBase[DSym] + GetBits(S, DExtra[DSym]);
+		if (S->Error || Back > S->Out->size()) {
+			return false;
+		}
+		for (int i = 0; i < Len; i++) {
+			S->Out->push_back((*S->Out)[S->Out->size() - Back]);
+		}
+	}
+}
+
+static bool Inflate(const uint8_t* In, size_t InLen, std::vector<uint8_t>* Out, size_t* Used)
+{
+	static const uint8_t Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+	INFLATE S = { In, InLen, 0, 0, 0, false, Out };
+	HUFFMAN Lit, Dist;
+	short Lengths[320];
+	int Last;
+
+	do {
+		Last = GetBits(&S, 1);
+		int Type = GetBits(&S, 2);
+		if (S.Error) {
+			return false;
+		}
+		if (Type == 0) {
+			// stored
+			S.Bits = 0;
+			S.NumBits = 0;
+			if (S.Pos + 4 > InLen) {
+				return false;
+			}
+			unsigned Len = In[S.Pos] | (In[S.Pos + 1] << 8);
+			unsigned NLen = In[S.Pos + 2] | (In[S.Pos + 3] << 8);
+			S.Pos += 4;
+			if (Len != (~NLen & 0xffff) || S.Pos + Len > InLen) {
+				return false;
+			}
+			Out->insert(Out->end(), In + S.Pos, In + S.Pos + Len);
+			S.Pos += Len;
+		}
+		else if (Type == 1) {
+			// fixed codes
+			for (int s = 0; s < 288; s++) {
+				Lengths[s] = s < 144 ? 8 : (s < 256 ? 9 : (s < 280 ? 7 : 8));
+			}
+			MakeHuffman(&Lit, Lengths, 288);
+			for (int s = 0; s < 30; s++) {
+				Lengths[s] = 5;
+			}
+			MakeHuffman(&Dist, Lengths, 30);
+			if (!InflateCodes(&S, &Lit, &Dist)) {
+				return false;
+			}
+		}
+		else if (Type == 2) {
+			// dynamic codes
+			int NumLit = GetBits(&S, 5) + 257;
+			int NumDist = GetBits(&S, 5) + 1;
+			int NumCode = GetBits(&S, 4) + 4;
+			HUFFMAN CodeLen;
+			memset(Lengths, 0, sizeof(Lengths));
+			for (int i = 0; i < NumCode; i++) {
+				Lengths[Order[i]] = (short)GetBits(&S, 3);
+			}
+			if (S.Error || !MakeHuffman(&CodeLen, Lengths, 19)) {
+				return false;
+			}
+			int n = 0;
+			while (n < NumLit + NumDist) {
+				int Sym = Decode(&S, &CodeLen);
+				int Repeat;
+				short Len = 0;
+				if (S.Error) {
+					return false;
+				}
+				if (Sym < 16) {
+					Lengths[n++] = (short)Sym;
+					continue;
+				}
+				if (Sym == 16) {
+					if (n == 0) {
+						return false;
+					}
+					Len = Lengths[n - 1];
+					Repeat = 3 + GetBits(&S, 2);
+				}
+				else if (Sym == 17) {
+					Repeat = 3 + GetBits(&S, 3);
+				}
+				else {
+					Repeat = 11 + GetBits(&S, 7);
+				}
+				if (n + Repeat > NumLit + NumDist) {
+					return false;
+				}
+				while (Repeat--) {
+					Lengths[n++] = Len;
+				}
+			}
+			if (!MakeHuffman(&Lit, Lengths, NumLit) || !MakeHuffman(&Dist, Lengths + NumLit, NumDist) ||
+				!InflateCodes(&S, &Lit, &Dist)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	} while (!Last);
+	*Used = S.Pos;
+	return true;
+}
+
+//*******************************************************************************
+//
+// PNG decoder, only what EncodePNG() writes
+//
+//*******************************************************************************
+static uint32_t GetDWORD(const uint8_t* Data)
+{
+	return ((uint32_t)Data[0] << 24) | ((uint32_t)Data[1] << 16) | ((uint32_t)Data[2] << 8) | Data[3];
+}
+
+static uint32_t CRC32(const uint8_t* Data, size_t Len)
+{
+	uint32_t CRC = 0xffffffff;
+
+	for (size_t i = 0; i < Len; i++) {
+		CRC ^= Data[i];
+		for (int k = 0; k < 8; k++) {
+			CRC = (CRC & 1) ? 0xedb88320 ^ (CRC >> 1) : CRC >> 1;
+		}
+	}
+	return CRC ^ 0xffffffff;
+}
+
+static uint32_t Adler32(const uint8_t* Data, size_t Len)
+{
+	uint32_t s1 = 1, s2 = 0;
+
+	for (size_t i = 0; i < Len; i++) {
+		s1 = (s1 + Data[i]) % 65521;
+		s2 = (s2 + s1) % 65521;
+	}
+	return s1 | (s2 << 16);
+}
+
+static int PaethPredictor(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+	if (pa <= pb && pa <= pc) {
+		return a;
+	}
+	return pb <= pc ? b : c;
+}
+
+// decode a PNG file to COLORREF pixels, BitDepth and ColorType from IHDR
+static bool DecodePNG(const std::vector<uint8_t>& File, std::vector<PNGPIXEL>& Image, int* xsize, int* ysize,
+	int* BitDepth, int* ColorType)
+{
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+	std::vector<uint8_t> Zlib;
+	std::vector<PNGPIXEL> Palette;
+	bool End = false;
+	size_t Pos = 8;
+
+	if (File.size() < 8 || memcmp(File.data(), Signature, 8) != 0) {
+		return false;
+	}
+	*xsize = 0;
+	while (!End) {
+		if (Pos + 12 > File.size()) {
+			return false;
+		}
+		uint32_t Len = GetDWORD(&File[Pos]);
+		if (Pos + 12 + Len > File.size() || CRC32(&File[Pos + 4], Len + 4) != GetDWORD(&File[Pos + 8 + Len])) {
+			return false;
+		}
+		const uint8_t* Type = &File[Pos + 4];
+		const uint8_t* Data = &File[Pos + 8];
+		if (memcmp(Type, "IHDR", 4) == 0 && Len == 13) {
+			*xsize = (int)GetDWORD(Data);
+			*ysize = (int)GetDWORD(Data + 4);
+			*BitDepth = Data[8];
+			*ColorType = Data[9];
+			if (Data[10] != 0 || Data[11] != 0 || Data[12] != 0) {
+				return false;
+			}
+		}
+		else if (memcmp(Type, "PLTE", 4) == 0) {
+			for (uint32_t i = 0; i + 2 < Len; i += 3) {
+				Palette.push_back(Data[i] | (Data[i + 1] << 8) | (Data[i + 2] << 16));
+			}
+		}
+		else if (memcmp(Type, "IDAT", 4) == 0) {
+			Zlib.insert(Zlib.end(), Data, Data + Len);
+		}
+		else if (memcmp(Type, "IEND", 4) == 0) {
+			End = true;
+		}
+		else {
+			return false;
+		}
+		Pos += 12 + Len;
+	}
+	if (*xsize <= 0 || Pos != File.size() || Zlib.size() < 6) {
+		return false;
+	}
+
+	// zlib stream
+	std::vector<uint8_t> Raw;
+	size_t Used;
+	if ((Zlib[0] & 0x0f) != 8 || ((Zlib[0] << 8) | Zlib[1]) % 31 != 0 ||
+		!Inflate(&Zlib[2], Zlib.size() - 2, &Raw, &Used) || 2 + Used + 4 != Zlib.size() ||
+		GetDWORD(&Zlib[2 + Used]) != Adler32(Raw.data(), Raw.size())) {
+		return false;
+	}
+
+	int PixelBits = *ColorType == 2 ? 3 * *BitDepth : *BitDepth;
+	int PixelBytes = (PixelBits + 7) / 8;
+	size_t RowBytes = ((size_t)*xsize * PixelBits + 7) / 8;
+	if ((*ColorType != 2 && *ColorType != 3) || Raw.size() != (RowBytes + 1) * *ysize) {
+		return false;
+	}
+
+	// unfilter
+	std::vector<uint8_t> Prev(RowBytes, 0);
+	std::vector<uint8_t> Row(RowBytes);
+	Image.resize((size_t)*xsize * *ysize);
+	for (int y = 0; y < *ysize; y++) {
+		const uint8_t* Filtered = &Raw[y * (RowBytes + 1)];
+		for (size_t i = 0; i < RowBytes; i++) {
+			int a = i >= (size_t)PixelBytes ? Row[i - PixelBytes] : 0;
+			int b = Prev[i];
+			int c = i >= (size_t)PixelBytes ? Prev[i - PixelBytes] : 0;
+			int Predict;
+			switch (Filtered[0]) {
+			case 0: Predict = 0; break;
+			case 1: Predict = a; break;
+			case 2: Predict = b; break;
+			case 3: Predict = (a + b) / 2; break;
+			case 4: Predict = PaethPredictor(a, b, c); break;
+			default: return false;
+			}
+			Row[i] = (uint8_t)(Filtered[1 + i] + Predict);
+		}
+		PNGPIXEL* Dest = &Image[(size_t)y * *xsize];
+		for (int x = 0; x < *xsize; x++) {
+			if (*ColorType == 2) {
+				Dest[x] = Row[3 * x] | (Row[3 * x + 1] << 8) | (Row[3 * x + 2] << 16);
+				continue;
+			}
+			int Bit = x * *BitDepth;
+			int Index = (Row[Bit / 8] >> (8 - *BitDepth - Bit % 8)) & ((1 << *BitDepth) - 1);
+			if ((size_t)Index >= Palette.size()) {
+				return false;
+			}
+			Dest[x] = Palette[Index];
+		}
+		Prev = Row;
+	}
+	return true;
+}
+
+//*******************************************************************************
+//
+// Test images
+//
+//*******************************************************************************
+static uint32_t RandomState = 12345;
+static uint32_t Random(void)
+{
+	RandomState = RandomState * 1664525 + 1013904223;
+	return RandomState >> 8;
+}
+
+// NumColors 0 is a smooth RGB gradient with noise, otherwise random runs of
+// NumColors colors, the high byte of each pixel is not part of the color
+static void MakeImage(std::vector<PNGPIXEL>& Image, int xsize, int ysize, int NumColors)
+{
+	std::vector<PNGPIXEL> Colors;
+
+	for (int i = 0; i < NumColors; i++) {
+		Colors.push_back((i * 0x3b1d7u + 0x102030u) & 0xffffff);
+	}
+	Image.resize((size_t)xsize * ysize);
+	PNGPIXEL Color = 0;
+	for (size_t i = 0; i < Image.size(); i++) {
+		int x = (int)(i % xsize);
+		int y = (int)(i / xsize);
+		if (NumColors == 0) {
+			Color = ((x + (Random() & 3)) & 0xff) | (((y * 3) & 0xff) << 8) | (((x + y) & 0xff) << 16);
+		}
+		else if (i < (size_t)NumColors) {
+			Color = Colors[i];			// every color is used
+		}
+		else if ((Random() & 7) == 0) {
+			Color = Colors[Random() % NumColors];
+		}
+		Image[i] = Color | (Random() << 24);
+	}
+}
+
+typedef struct {
+	const PNGPIXEL* Image;
+	int xsize;
+	int Calls;
+	int FailAt;				// row to fail at, -1 none
+} ROWSJOB;
+
+static int GetRows(void* Context, int y, int NumRows, PNGPIXEL* Rows)
+{
+	ROWSJOB* Job = (ROWSJOB*)Context;
+
+	Job->Calls++;
+	if (Job->FailAt >= y && Job->FailAt < y + NumRows) {
+		return APPERR_FILEREAD;
+	}
+	memcpy(Rows, Job->Image + (size_t)y * Job->xsize, (size_t)NumRows * Job->xsize * sizeof(PNGPIXEL));
+	return APP_SUCCESS;
+}
+
+// encode and decode an image, check the pixels and the PNG format
+static void RoundTrip(int xsize, int ysize, int NumColors, bool UseGetRows, bool Threads)
+{
+	std::vector<PNGPIXEL> Image;
+	std::vector<PNGPIXEL> Decoded;
+	std::vector<uint8_t> File;
+	ROWSJOB Job;
+	PNGOUTPUT Output = { WriteMemory, &File, Threads ? ThreadParallelFor : NULL, Threads ? 4 : 1 };
+	int dx = 0, dy = 0, BitDepth = 0, ColorType = 0;
+	int iRes;
+
+	MakeImage(Image, xsize, ysize, NumColors);
+	std::set<PNGPIXEL> Colors;
+	for (size_t i = 0; i < Image.size(); i++) {
+		Colors.insert(Image[i] & 0xffffff);
+	}
+	int ExpectType = Colors.size() <= 256 ? 3 : 2;
+	int ExpectDepth = Colors.size() <= 2 ? 1 : (Colors.size() <= 4 ? 2 : (Colors.size() <= 16 ? 4 : 8));
+	Job.Image = Image.data();
+	Job.xsize = xsize;
+	Job.Calls = 0;
+	Job.FailAt = -1;
+	if (UseGetRows) {
+		iRes = EncodePNG(&Output, GetRows, &Job, xsize, ysize);
+	}
+	else {
+		iRes = EncodePNG(&Output, NULL, Image.data(), xsize, ysize);
+	}
+	bool Decodes = iRes == APP_SUCCESS && DecodePNG(File, Decoded, &dx, &dy, &BitDepth, &ColorType);
+	bool Same = Decodes && dx == xsize && dy == ysize;
+	for (size_t i = 0; Same && i < Image.size(); i++) {
+		Same = Decoded[i] == (Image[i] & 0xffffff);
+	}
+	if (iRes != APP_SUCCESS || !Decodes || !Same || BitDepth != ExpectDepth ||
+		ColorType != ExpectType) {
+		printf("FAILED %dx%d %d colors%s%s: result %d, decoded %d, same %d, bit depth %d, color type %d\n",
+			xsize, ysize, NumColors, UseGetRows ? " GetRows" : "", Threads ? " threads" : "",
+			iRes, Decodes, Same, BitDepth, ColorType);
+		NumFailed++;
+	}
+}
+
+int main(void)
+{
+	static const int Sizes[][2] = { { 1, 1 }, { 7, 5 }, { 13, 17 }, { 1001, 77 }, { 3001, 400 } };
+	// 1, 2, 4 and 8 bit palette images, RGB when there are more than 256 colors
+	static const int Kinds[] = { 1, 2, 3, 4, 5, 16, 17, 256, 257, 0 };
+
+	for (size_t s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++) {
+		for (size_t k = 0; k < sizeof(Kinds) / sizeof(Kinds[0]); k++) {
+			int xsize = Sizes[s][0];
+			int ysize = Sizes[s][1];
+			if (Kinds[k] > xsize * ysize) {
+				continue;
+			}
+			RoundTrip(xsize, ysize, Kinds[k], false, false);
+			RoundTrip(xsize, ysize, Kinds[k], true, true);
+		}
+	}
+
+	// the same image gives the same file, one task at a time or not
+	{
+		std::vector<PNGPIXEL> Image;
+		std::vector<uint8_t> File1, File2;
+		PNGOUTPUT Output1 = { WriteMemory, &File1, NULL, 1 };
+		PNGOUTPUT Output2 = { WriteMemory, &File2, ThreadParallelFor, 8 };
+		MakeImage(Image, 3001, 400, 0);
+		CHECK(EncodePNG(&Output1, NULL, Image.data(), 3001, 400) == APP_SUCCESS);
+		CHECK(EncodePNG(&Output2, NULL, Image.data(), 3001, 400) == APP_SUCCESS);
+		CHECK(File1 == File2);
+	}
+
+	// write and GetRows errors are returned
+	{
+		std::vector<PNGPIXEL> Image;
+		std::vector<uint8_t> File;
+		PNGOUTPUT Output = { WriteLimited, &File, ThreadParallelFor, 4 };
+		ROWSJOB Job = { NULL, 1001, 0, -1 };
+		MakeImage(Image, 1001, 300, 0);
+		Job.Image = Image.data();
+		WriteLimit = (size_t)-1;
+		CHECK(EncodePNG(&Output, NULL, Image.data(), 1001, 300) == APP_SUCCESS);
+		size_t FileSize = File.size();
+		for (WriteLimit = 0; WriteLimit < FileSize; WriteLimit = WriteLimit * 3 + 5) {
+			File.clear();
+			CHECK(EncodePNG(&Output, NULL, Image.data(), 1001, 300) == APPERR_FILEWRITE);
+		}
+		Output.Write = WriteMemory;
+		Job.FailAt = 299;
+		File.clear();
+		CHECK(EncodePNG(&Output, GetRows, &Job, 1001, 300) == APPERR_FILEREAD);
+		CHECK(EncodePNG(&Output, NULL, NULL, 1001, 300) == APPERR_PARAMETER);
+		CHECK(EncodePNG(&Output, NULL, Image.data(), 0, 300) == APPERR_PARAMETER);
+	}
+
+	if (NumFailed) {
+		printf("PNGEncoderTest: %d checks failed\n", NumFailed);
+		return 1;
+	}
+	printf("PNGEncoderTest: passed\n");
+	return 0;
+}
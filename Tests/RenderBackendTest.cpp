@@ -0,0 +1,165 @@
+//
+// MySETIviewer, a set tools for decoding bitstreams into various formats and manipulating those files
+// RenderBackendTest.cpp
+// (C) 2023, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIviewer.
+//
+// MySETIviewer is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIviewer is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIapp.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Test of ImageSurface with the software framebuffer backend, no window is
+// needed.  Only the changed region reported to ImageSurface::Load() may be
+// copied to the bitmap, and the bitmap is only created again when the image
+// size changes or the device is lost.
+//
+// V1.2.24	2026-10-17	Initial release
+//
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "AppErrors.h"
+#include "RenderBackend.h"
+
+static int NumFailed = 0;
+
+#define CHECK(Condition) \
+	if (!(Condition)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #Condition); \
+		NumFailed++; \
+	}
+
+// image of xsize x ysize pixels, pixel value from its position and Seed
+static void FillImage(std::vector<RENDERPIXEL>& Image, int xsize, int ysize, unsigned int Seed)
+{
+	Image.resize((size_t)xsize * ysize);
+	for (int y = 0; y < ysize; y++) {
+		for (int x = 0; x < xsize; x++) {
+			Image[(size_t)y * xsize + x] = (RENDERPIXEL)((x * 7919u + y * 104729u + Seed * 15485863u) & 0xffffff);
+		}
+	}
+}
+
+// draw the bitmap of the surface to the framebuffer and compare it to Expected
+static bool SurfaceIs(SoftwareBackend* Backend, ImageSurface* Surface, const std::vector<RENDERPIXEL>& Expected,
+	int xsize, int ysize)
+{
+	const RENDERPIXEL* Framebuffer;
+	int fx, fy;
+
+	if (Surface->GetBitmap() == NULL || Backend->Resize(xsize, ysize) != APP_SUCCESS) {
+		return false;
+	}
+	Backend->Draw(Surface->GetBitmap(), 0, 0);
+	Framebuffer = Backend->GetFramebuffer(&fx, &fy);
+	return fx == xsize && fy == ysize &&
+		memcmp(Framebuffer, Expected.data(), (size_t)xsize * ysize * sizeof(RENDERPIXEL)) == 0;
+}
+
+int main(void)
+{
+	const int xsize = 300;
+	const int ysize = 200;
+	SoftwareBackend Backend;
+	ImageSurface Surface;
+	std::vector<RENDERPIXEL> Image;
+	std::vector<RENDERPIXEL> Shown;
+
+	Surface.SetBackend(&Backend);
+
+	// first load creates the bitmap from the whole image
+	FillImage(Image, xsize, ysize, 1);
+	CHECK(Surface.Load(xsize, ysize, Image.data(), NULL) == APP_SUCCESS);
+	CHECK(Backend.NumBitmaps == 1);
+	CHECK(Backend.NumCopies == 0);
+	CHECK(SurfaceIs(&Backend, &Surface, Image, xsize, ysize));
+	Shown = Image;
+
+	// the whole image changes, only the reported region is copied
+	RENDERRECT Changed = { 37, 20, 101, 45 };
+	FillImage(Image, xsize, ysize, 2);
+	CHECK(Surface.Load(xsize, ysize, Image.data(), &Changed) == APP_SUCCESS);
+	CHECK(Backend.NumBitmaps == 1);
+	CHECK(Backend.NumCopies == 1);
+	CHECK(Backend.PixelsCopied == (size_t)(101 - 37) * (45 - 20));
+	CHECK(memcmp(&Backend.LastCopy, &Changed, sizeof(RENDERRECT)) == 0);
+	for (int y = Changed.top; y < Changed.bottom; y++) {
+		for (int x = Changed.left; x < Changed.right; x++) {
+			Shown[(size_t)y * xsize + x] = Image[(size_t)y * xsize + x];
+		}
+	}
+	CHECK(SurfaceIs(&Backend, &Surface, Shown, xsize, ysize));
+
+	// region partly outside of the image is clipped
+	RENDERRECT Outside = { 250, 180, 400, 260 };
+	RENDERRECT Clipped = { 250, 180, xsize, ysize };
+	Backend.PixelsCopied = 0;
+	CHECK(Surface.Load(xsize, ysize, Image.data(), &Outside) == APP_SUCCESS);
+	CHECK(Backend.NumCopies == 2);
+	CHECK(Backend.PixelsCopied == (size_t)(xsize - 250) * (ysize - 180));
+	CHECK(memcmp(&Backend.LastCopy, &Clipped, sizeof(RENDERRECT)) == 0);
+	for (int y = Clipped.top; y < Clipped.bottom; y++) {
+		for (int x = Clipped.left; x < Clipped.right; x++) {
+			Shown[(size_t)y * xsize + x] = Image[(size_t)y * xsize + x];
+		}
+	}
+	CHECK(SurfaceIs(&Backend, &Surface, Shown, xsize, ysize));
+
+	// empty region and region outside of the image copy nothing
+	RENDERRECT Empty = { 10, 10, 10, 50 };
+	RENDERRECT Beyond = { xsize, 0, xsize + 10, 10 };
+	CHECK(Surface.Load(xsize, ysize, Image.data(), &Empty) == APP_SUCCESS);
+	CHECK(Surface.Load(xsize, ysize, Image.data(), &Beyond) == APP_SUCCESS);
+	CHECK(Backend.NumCopies == 2);
+	CHECK(Backend.NumBitmaps == 1);
+	CHECK(SurfaceIs(&Backend, &Surface, Shown, xsize, ysize));
+
+	// no region, the whole image is copied to the same bitmap
+	Backend.PixelsCopied = 0;
+	CHECK(Surface.Load(xsize, ysize, Image.data(), NULL) == APP_SUCCESS);
+	CHECK(Backend.NumBitmaps == 1);
+	CHECK(Backend.NumCopies == 3);
+	CHECK(Backend.PixelsCopied == (size_t)xsize * ysize);
+	CHECK(SurfaceIs(&Backend, &Surface, Image, xsize, ysize));
+
+	// resizing the framebuffer to the same size keeps it, the bitmap is kept
+	int NumResizes = Backend.NumResizes;
+	CHECK(Backend.Resize(xsize, ysize) == APP_SUCCESS);
+	CHECK(Backend.NumResizes == NumResizes);
+	CHECK(Backend.Resize(xsize + 20, ysize) == APP_SUCCESS);
+	CHECK(Backend.NumResizes == NumResizes + 1);
+	CHECK(Surface.GetBitmap() != NULL);
+
+	// new size creates the bitmap again from the whole image
+	std::vector<RENDERPIXEL> Larger;
+	FillImage(Larger, xsize + 1, ysize, 3);
+	CHECK(Surface.Load(xsize + 1, ysize, Larger.data(), &Changed) == APP_SUCCESS);
+	CHECK(Backend.NumBitmaps == 2);
+	CHECK(Backend.NumCopies == 3);
+	CHECK(SurfaceIs(&Backend, &Surface, Larger, xsize + 1, ysize));
+
+	// device lost, the bitmap is released and is created again by the next load
+	Backend.LoseDevice();
+	FillImage(Larger, xsize + 1, ysize, 4);
+	CHECK(Surface.Load(xsize + 1, ysize, Larger.data(), &Changed) == APPERR_DEVICELOST);
+	CHECK(Surface.GetBitmap() == NULL);
+	CHECK(Surface.Load(xsize + 1, ysize, Larger.data(), NULL) == APP_SUCCESS);
+	CHECK(Backend.NumBitmaps == 3);
+	CHECK(SurfaceIs(&Backend, &Surface, Larger, xsize + 1, ysize));
+
+	Surface.Release();
+	if (NumFailed) {
+		printf("RenderBackendTest: %d checks failed\n", NumFailed);
+		return 1;
+	}
+	printf("RenderBackendTest: passed\n");
+	return 0;
+}
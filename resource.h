@@ -120,6 +120,7 @@
 #define IDM_BITTOOLS_TEXT2BITSTREAM     32636
 #define IDM_BITTOOLS_BINARYIMAGE        32637
 #define IDM_SETTINGS_RESET_WINDOWS      32640
+#define IDM_CANCEL_LOAD                 32641
 #define IDM_RESET_ZOOM                  32783
 #define IDM_RESET_PAN                   32784
 #define ID_ACTIONS_CROSSHAIRS           32788
@@ -133,7 +134,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        202
-#define _APS_NEXT_COMMAND_VALUE         32641
+#define _APS_NEXT_COMMAND_VALUE         32642
 #define _APS_NEXT_CONTROL_VALUE         1232
 #define _APS_NEXT_SYMED_VALUE           300
 #endif